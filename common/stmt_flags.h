@@ -0,0 +1,18 @@
+#pragma once
+
+// Statement classification, determined by the preprocessor and passed to the runtime 
+// with GIXSQLSetStatementFlags: STMT_FLAG_NONE means that the statement text must be inspected
+
+#define STMT_FLAG_NONE				(uint32_t)0x0
+#define STMT_FLAG_CLASSIFIED		(uint32_t)0x1
+#define STMT_FLAG_SELECT			(uint32_t)0x2
+#define STMT_FLAG_INSERT			(uint32_t)0x4
+#define STMT_FLAG_UPDATE			(uint32_t)0x8
+#define STMT_FLAG_DELETE			(uint32_t)0x10
+#define STMT_FLAG_TX_TERMINATION	(uint32_t)0x20
+#define STMT_FLAG_CURRENT_OF		(uint32_t)0x40
+
+#define STMT_IS_CLASSIFIED(_F)			(_F & STMT_FLAG_CLASSIFIED)
+#define STMT_IS_UPDATE_OR_DELETE(_F)	(_F & (STMT_FLAG_UPDATE | STMT_FLAG_DELETE))
+#define STMT_IS_TX_TERMINATION(_F)		(_F & STMT_FLAG_TX_TERMINATION)
+#define STMT_IS_CURRENT_OF(_F)			(_F & STMT_FLAG_CURRENT_OF)
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <stdint.h>
+
+// Binary trace events, recorded by the runtime in per-thread ring buffers (see TraceRing.h)
+// and decoded offline by gixsql-trace
+
+#define TRACE_FILE_MAGIC		"GIXTRACE"
+#define TRACE_FILE_VERSION		1
+#define TRACE_BYTE_ORDER_MARK	0x01020304
+#define TRACE_PAYLOAD_SIZE		32
+
+#define TRACE_FLAG_NONE			(uint16_t)0x0
+#define TRACE_FLAG_BEGIN		(uint16_t)0x1
+#define TRACE_FLAG_END			(uint16_t)0x2
+#define TRACE_FLAG_TRUNCATED	(uint16_t)0x4
+
+#define TRACE_EV_CONNECT			1
+#define TRACE_EV_DISCONNECT			2
+#define TRACE_EV_EXEC				3
+#define TRACE_EV_EXEC_PARAMS		4
+#define TRACE_EV_EXEC_PREPARED		5
+#define TRACE_EV_PREPARE			6
+#define TRACE_EV_CURSOR_DECLARE		7
+#define TRACE_EV_CURSOR_OPEN		8
+#define TRACE_EV_CURSOR_FETCH		9
+#define TRACE_EV_CURSOR_CLOSE		10
+#define TRACE_EV_SELECT_INTO		11
+#define TRACE_EV_STATUS				12
+#define TRACE_EV_VAR_TO_DB			13
+#define TRACE_EV_VAR_TO_COBOL		14
+#define TRACE_EV_DUMP				15
+#define TRACE_EV_DEALLOCATE			16
+
+#define TRACE_EV_MAX				16
+
+// handle is the connection id (0 if not known), ref the address of the object the event refers to
+// (host variable, sqlca, ...), value a result code, a length or, for TRACE_FLAG_END events, the
+// elapsed time in nanoseconds
+struct TraceEvent {
+	uint64_t timestamp;		// nanoseconds, steady clock
+	uint16_t event_id;
+	uint16_t flags;
+	uint32_t handle;
+	uint64_t ref;
+	int64_t value;
+	char payload[TRACE_PAYLOAD_SIZE];	// not null-terminated when full
+};
+
+static_assert(sizeof(TraceEvent) == 64, "TraceEvent must be 64 bytes");
+
+// A dump file contains a TraceFileHeader, then for each thread a TraceThreadHeader
+// followed by event_count events, the oldest first
+struct TraceFileHeader {
+	char magic[8];
+	uint32_t version;
+	uint32_t event_size;
+	uint32_t byte_order;
+	uint32_t thread_count;
+	uint64_t pid;
+	uint64_t wall_clock_ns;		// system clock when the dump was written (ns since the epoch)
+	uint64_t steady_clock_ns;	// steady clock when the dump was written, used to convert the timestamps
+};
+
+struct TraceThreadHeader {
+	uint64_t thread_id;
+	uint64_t event_count;
+	uint64_t dropped;			// older events overwritten in the ring
+};
+
+static inline const char* trace_event_name(uint16_t id)
+{
+	switch (id) {
+		case TRACE_EV_CONNECT:			return "CONNECT";
+		case TRACE_EV_DISCONNECT:		return "DISCONNECT";
+		case TRACE_EV_EXEC:				return "EXEC";
+		case TRACE_EV_EXEC_PARAMS:		return "EXEC_PARAMS";
+		case TRACE_EV_EXEC_PREPARED:	return "EXEC_PREPARED";
+		case TRACE_EV_PREPARE:			return "PREPARE";
+		case TRACE_EV_CURSOR_DECLARE:	return "CURSOR_DECLARE";
+		case TRACE_EV_CURSOR_OPEN:		return "CURSOR_OPEN";
+		case TRACE_EV_CURSOR_FETCH:		return "CURSOR_FETCH";
+		case TRACE_EV_CURSOR_CLOSE:		return "CURSOR_CLOSE";
+		case TRACE_EV_SELECT_INTO:		return "SELECT_INTO";
+		case TRACE_EV_STATUS:			return "STATUS";
+		case TRACE_EV_VAR_TO_DB:		return "VAR_TO_DB";
+		case TRACE_EV_VAR_TO_COBOL:		return "VAR_TO_COBOL";
+		case TRACE_EV_DUMP:				return "DUMP";
+		case TRACE_EV_DEALLOCATE:		return "DEALLOCATE";
+		default:						return "UNKNOWN";
+	}
+}
@@ -0,0 +1,247 @@
+/*
+This file is part of Gix-IDE, an IDE and platform for GnuCOBOL
+Copyright (C) 2021 Marco Ridoni
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+USA.
+*/
+
+#include "CorpusGenerator.h"
+
+#include <filesystem>
+
+#include "libcpputils.h"
+
+#define AREA_A	"       "
+#define AREA_B	"           "
+
+#define COPY_FIELDS		40
+#define N_TABLES		20
+
+static const char* field_pics[] = {
+	"PIC X(20)",
+	"PIC S9(9) COMP-3",
+	"PIC S9(7)V99 COMP-3",
+	"PIC 9(8)",
+	"PIC X(50)"
+};
+
+CorpusGenerator::CorpusGenerator(const CorpusOptions& _opts) : opts(_opts), rng(_opts.seed)
+{
+}
+
+bool CorpusGenerator::generate(const std::string& dir)
+{
+	std::string copy_dir = path_combine({ dir, "copy" });
+
+	std::error_code ec;
+	std::filesystem::create_directories(copy_dir, ec);
+	if (ec) {
+		fprintf(stderr, "ERROR: cannot create directory %s\n", copy_dir.c_str());
+		return false;
+	}
+
+	generate_copybooks(copy_dir);
+	std::vector<std::string> copy_host_vars = host_vars;
+
+	for (int n = 1; n <= opts.programs; n++) {
+		host_vars = copy_host_vars;
+		generate_program(n);
+
+		std::string f = path_combine({ dir, string_format("PRG%03d.cbl", n) });
+		if (!file_write_all_lines(f, lines)) {
+			fprintf(stderr, "ERROR: cannot write %s\n", f.c_str());
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void CorpusGenerator::generate_copybooks(const std::string& copy_dir)
+{
+	host_vars.clear();
+
+	for (int d = 0; d < opts.copy_depth; d++) {
+		lines.clear();
+		lines.push_back(string_format("      * Record layout, level %d", d));
+		for (int i = 1; i <= COPY_FIELDS; i++) {
+			std::string name = string_format("R%02d-F%04d", d, i);
+			put_field(name, i + d);
+		}
+
+		if (d < opts.copy_depth - 1)
+			lines.push_back(string_format(AREA_B "COPY REC%02d.", d + 1));
+
+		file_write_all_lines(path_combine({ copy_dir, string_format("REC%02d.cpy", d) }), lines);
+	}
+}
+
+void CorpusGenerator::generate_program(int n)
+{
+	lines.clear();
+
+	lines.push_back(AREA_A "IDENTIFICATION DIVISION.");
+	lines.push_back(string_format(AREA_A "PROGRAM-ID. PRG%03d.", n));
+	lines.push_back(AREA_A "ENVIRONMENT DIVISION.");
+	lines.push_back(AREA_A "CONFIGURATION SECTION.");
+	lines.push_back(AREA_A "SOURCE-COMPUTER. IBM-PC.");
+	lines.push_back(AREA_A "OBJECT-COMPUTER. IBM-PC.");
+	lines.push_back(AREA_A "DATA DIVISION.");
+	lines.push_back(AREA_A "WORKING-STORAGE SECTION.");
+	lines.push_back(AREA_A "01  WS-COUNT PIC 9(9) VALUE 0.");
+	lines.push_back(AREA_A "01  WS-TEXT  PIC X(80).");
+	lines.push_back(AREA_B "EXEC SQL INCLUDE SQLCA END-EXEC.");
+	lines.push_back(AREA_B "EXEC SQL BEGIN DECLARE SECTION END-EXEC.");
+	lines.push_back(AREA_A "01  HV-KEY PIC S9(9) COMP-3.");
+	lines.push_back(AREA_A "01  HV-CNT PIC S9(9) COMP-3.");
+	if (opts.copy_depth > 0) {
+		lines.push_back(AREA_A "01  HV-REC.");
+		lines.push_back(AREA_B "COPY REC00.");
+	}
+	lines.push_back(AREA_A "01  HV-GRP.");
+	for (int i = 1; i <= opts.group_fields; i++) {
+		std::string name = string_format("HV-G%04d", i);
+		put_field(name, i);
+	}
+	lines.push_back(AREA_B "EXEC SQL END DECLARE SECTION END-EXEC.");
+
+	// paragraphs are generated first, so that the filler lines can be distributed evenly
+	std::vector<std::vector<std::string>> paragraphs;
+	std::vector<std::string> prg_lines = lines;
+	int nblocks = 0;
+	while (nblocks < opts.esql_blocks) {
+		lines.clear();
+		int p = paragraphs.size() + 1;
+		lines.push_back(string_format(AREA_A "P-%05d.", p));
+		put_sql_block(p);
+		nblocks += (p % 6 == 4) ? 4 : 1;
+		paragraphs.push_back(lines);
+	}
+
+	size_t ncur = prg_lines.size() + 6;
+	for (const auto& p : paragraphs)
+		ncur += p.size();
+
+	int filler_per_para = ((size_t)opts.lines > ncur && paragraphs.size()) ? (opts.lines - ncur) / paragraphs.size() : 0;
+
+	lines = prg_lines;
+	lines.push_back(AREA_A "PROCEDURE DIVISION.");
+	lines.push_back(AREA_A "MAIN-PARA.");
+	lines.push_back(string_format(AREA_B "PERFORM P-00001 THRU P-%05d.", (int)paragraphs.size()));
+	lines.push_back(AREA_B "GOBACK.");
+
+	for (const auto& p : paragraphs) {
+		lines.insert(lines.end(), p.begin(), p.end());
+		put_filler(filler_per_para);
+	}
+}
+
+void CorpusGenerator::put_field(const std::string& name, int idx)
+{
+	lines.push_back(string_format(AREA_B "05 %-12s %s.", name, field_pics[idx % 5]));
+	host_vars.push_back(name);
+}
+
+void CorpusGenerator::put_sql_block(int n)
+{
+	std::string tbl = string_format("TAB%02d", (n % N_TABLES) + 1);
+
+	switch (n % 6) {
+		case 0:
+			lines.push_back(AREA_B "EXEC SQL");
+			lines.push_back(AREA_B "   SELECT COL02, COL03");
+			lines.push_back(AREA_B "     INTO :" + random_host_var() + ", :" + random_host_var());
+			lines.push_back(AREA_B "     FROM " + tbl + " WHERE COL01 = :HV-KEY");
+			lines.push_back(AREA_B "END-EXEC.");
+			break;
+
+		case 1:
+			lines.push_back(AREA_B "EXEC SQL");
+			lines.push_back(AREA_B "   INSERT INTO " + tbl + " (COL01, COL02, COL03)");
+			lines.push_back(AREA_B "     VALUES (:HV-KEY, :" + random_host_var() + ",");
+			lines.push_back(AREA_B "             :" + random_host_var() + ")");
+			lines.push_back(AREA_B "END-EXEC.");
+			break;
+
+		case 2:
+			lines.push_back(AREA_B "EXEC SQL");
+			lines.push_back(AREA_B "   UPDATE " + tbl + " SET COL02 = :" + random_host_var());
+			lines.push_back(AREA_B "     WHERE COL01 = :HV-KEY");
+			lines.push_back(AREA_B "END-EXEC.");
+			break;
+
+		case 3:
+			lines.push_back(AREA_B "EXEC SQL");
+			lines.push_back(AREA_B "   DELETE FROM " + tbl + " WHERE COL01 = :HV-KEY");
+			lines.push_back(AREA_B "END-EXEC.");
+			break;
+
+		case 4:
+		{
+			std::string crsr = string_format("CRSR%05d", n);
+			lines.push_back(AREA_B "EXEC SQL");
+			lines.push_back(AREA_B "   DECLARE " + crsr + " CURSOR FOR");
+			lines.push_back(AREA_B "   SELECT COL02, COL03 FROM " + tbl);
+			lines.push_back(AREA_B "     WHERE COL01 > :HV-KEY ORDER BY COL01");
+			lines.push_back(AREA_B "END-EXEC.");
+			lines.push_back(AREA_B "EXEC SQL OPEN " + crsr + " END-EXEC.");
+			lines.push_back(AREA_B "EXEC SQL");
+			lines.push_back(AREA_B "   FETCH " + crsr + " INTO :" + random_host_var() + ",");
+			lines.push_back(AREA_B "     :" + random_host_var());
+			lines.push_back(AREA_B "END-EXEC.");
+			lines.push_back(AREA_B "EXEC SQL CLOSE " + crsr + " END-EXEC.");
+		}
+		break;
+
+		default:
+			lines.push_back(AREA_B "EXEC SQL");
+			lines.push_back(AREA_B "   SELECT COUNT(*) INTO :HV-CNT FROM " + tbl);
+			lines.push_back(AREA_B "END-EXEC.");
+			break;
+	}
+
+	lines.push_back(AREA_B "IF SQLCODE NOT = 0");
+	lines.push_back(AREA_B "   DISPLAY 'SQLCODE: ' SQLCODE");
+	lines.push_back(AREA_B "END-IF.");
+}
+
+void CorpusGenerator::put_filler(int n)
+{
+	for (int i = 0; i < n; i++) {
+		switch (rng() % 4) {
+			case 0:
+				lines.push_back(AREA_B "ADD 1 TO WS-COUNT.");
+				break;
+
+			case 1:
+				lines.push_back(AREA_B "MOVE SPACES TO WS-TEXT.");
+				break;
+
+			case 2:
+				lines.push_back(AREA_B "DISPLAY 'COUNT: ' WS-COUNT.");
+				break;
+
+			default:
+				lines.push_back("      * comment line");
+				break;
+		}
+	}
+}
+
+const std::string& CorpusGenerator::random_host_var()
+{
+	return host_vars.at(rng() % host_vars.size());
+}
@@ -0,0 +1,63 @@
+/*
+This file is part of Gix-IDE, an IDE and platform for GnuCOBOL
+Copyright (C) 2021 Marco Ridoni
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+USA.
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <random>
+
+struct CorpusOptions
+{
+	int programs = 5;
+	int lines = 30000;			// approximate size of each program
+	int esql_blocks = 2000;		// EXEC SQL blocks in the PROCEDURE DIVISION of each program
+	int copy_depth = 8;			// nesting level of the shared copybooks
+	int group_fields = 500;		// fields in the host variable group of each program
+	unsigned int seed = 1;
+};
+
+// Generates a corpus of large, fixed-format COBOL programs with embedded SQL and
+// a chain of nested copybooks (shared by all the programs) in <dir>/copy
+class CorpusGenerator
+{
+public:
+	CorpusGenerator(const CorpusOptions& opts);
+
+	bool generate(const std::string& dir);
+
+private:
+	CorpusOptions opts;
+	std::mt19937 rng;
+
+	std::vector<std::string> lines;
+
+	// host variables usable in SQL statements: name, column
+	std::vector<std::string> host_vars;
+
+	void generate_copybooks(const std::string& copy_dir);
+	void generate_program(int n);
+
+	void put_field(const std::string& name, int idx);
+	void put_sql_block(int n);
+	void put_filler(int n);
+
+	const std::string& random_host_var();
+};
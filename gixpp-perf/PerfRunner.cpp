@@ -0,0 +1,210 @@
+/*
+This file is part of Gix-IDE, an IDE and platform for GnuCOBOL
+Copyright (C) 2021 Marco Ridoni
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+USA.
+*/
+
+#include "PerfRunner.h"
+
+#include <cstdio>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <regex>
+#include <filesystem>
+#include <algorithm>
+
+#include "libcpputils.h"
+
+#if defined(_WIN32)
+#define popen _popen
+#define pclose _pclose
+#define PATH_LIST_SEP ";"
+#else
+#define PATH_LIST_SEP ":"
+#endif
+
+#define TOTAL_PHASE	"(process)"
+
+static std::regex rx_phase(R"re(\{"name":"([^"]*)","wall_ms":([0-9.]+),"cpu_ms":([0-9.]+),"peak_rss_kb":([0-9]+)\})re");
+
+PerfRunner::PerfRunner(const PerfRunnerOptions& _opts) : opts(_opts)
+{
+	if (opts.repeat < 1)
+		opts.repeat = 1;
+}
+
+bool PerfRunner::run(const std::string& corpus_dir)
+{
+	std::vector<std::string> programs;
+	std::error_code ec;
+	for (const auto& entry : std::filesystem::directory_iterator(corpus_dir, ec)) {
+		if (entry.is_regular_file() && to_lower(entry.path().extension().string()) == ".cbl")
+			programs.push_back(entry.path().string());
+	}
+
+	if (programs.empty()) {
+		fprintf(stderr, "ERROR: no programs found in %s\n", corpus_dir.c_str());
+		return false;
+	}
+
+	std::sort(programs.begin(), programs.end());
+
+	std::string work_dir = !opts.work_dir.empty() ? opts.work_dir : path_combine({ path_get_temp_path(), "gixpp-perf" });
+	std::filesystem::create_directories(work_dir, ec);
+
+	std::string copy_path = path_combine({ corpus_dir, "copy" });
+	if (!opts.copy_path.empty())
+		copy_path += PATH_LIST_SEP + opts.copy_path;
+
+	results.clear();
+
+	for (const auto& p : programs) {
+		std::string name = filename_get_name(p);
+		std::string outfile = path_combine({ work_dir, filename_get_name(filename_change_ext(p, ".cbsql")) });
+
+		for (int i = 0; i < opts.repeat; i++) {
+			if (!run_program(name, p, outfile, copy_path))
+				return false;
+		}
+
+		const PerfResult& r = results[name + "/" + TOTAL_PHASE];
+		printf("%-20s %10.3f ms %10llu KB\n", name.c_str(), r.wall_ms, (unsigned long long)r.peak_rss_kb);
+	}
+
+	return true;
+}
+
+bool PerfRunner::run_program(const std::string& program, const std::string& infile, const std::string& outfile, const std::string& copy_path)
+{
+	std::string cmd = "\"" + opts.gixpp_path + "\" " + opts.gixpp_args + " -I \"" + copy_path + "\" -i \"" + infile + "\" -o \"" + outfile + "\" --timings=json";
+
+#if defined(_WIN32)
+	// cmd.exe strips the outer quotes
+	cmd = "\"" + cmd + "\"";
+#endif
+
+	auto start = std::chrono::steady_clock::now();
+
+	FILE* fp = popen(cmd.c_str(), "r");
+	if (!fp) {
+		fprintf(stderr, "ERROR: cannot run %s\n", cmd.c_str());
+		return false;
+	}
+
+	std::string output;
+	char bfr[4096];
+	while (fgets(bfr, sizeof(bfr), fp))
+		output += bfr;
+
+	int rc = pclose(fp);
+
+	PerfResult total;
+	total.wall_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	if (rc != 0) {
+		fprintf(stderr, "ERROR: gixpp failed on %s (%d):\n%s\n", infile.c_str(), rc, cmd.c_str());
+		return false;
+	}
+
+	for (std::sregex_iterator it(output.begin(), output.end(), rx_phase), end; it != end; ++it) {
+		PerfResult r;
+		r.wall_ms = atof((*it)[2].str().c_str());
+		r.cpu_ms = atof((*it)[3].str().c_str());
+		r.peak_rss_kb = strtoull((*it)[4].str().c_str(), nullptr, 10);
+		add_result(program + "/" + (*it)[1].str(), r);
+
+		total.cpu_ms += r.cpu_ms;
+		total.peak_rss_kb = std::max(total.peak_rss_kb, r.peak_rss_kb);
+	}
+
+	add_result(program + "/" + TOTAL_PHASE, total);
+	return true;
+}
+
+// The best result of the repeated runs is kept
+void PerfRunner::add_result(const std::string& key, const PerfResult& r)
+{
+	auto it = results.find(key);
+	if (it == results.end()) {
+		results[key] = r;
+		return;
+	}
+
+	it->second.wall_ms = std::min(it->second.wall_ms, r.wall_ms);
+	it->second.cpu_ms = std::min(it->second.cpu_ms, r.cpu_ms);
+	it->second.peak_rss_kb = std::min(it->second.peak_rss_kb, r.peak_rss_kb);
+}
+
+bool PerfRunner::writeResults(const std::string& filename)
+{
+	std::vector<std::string> lines;
+	for (const auto& r : results) {
+		size_t p = r.first.find('/');
+		lines.push_back(string_format("%s\t%s\t%.3f\t%.3f\t%llu", r.first.substr(0, p), r.first.substr(p + 1),
+			r.second.wall_ms, r.second.cpu_ms, (unsigned long long)r.second.peak_rss_kb));
+	}
+
+	return file_write_all_lines(filename, lines);
+}
+
+bool PerfRunner::readResults(const std::string& filename, std::map<std::string, PerfResult>& res)
+{
+	if (!file_exists(filename))
+		return false;
+
+	for (const auto& l : file_read_all_lines(filename)) {
+		std::vector<std::string> items = string_split(l, "\t");
+		if (items.size() != 5)
+			continue;
+
+		PerfResult r;
+		r.wall_ms = atof(items.at(2).c_str());
+		r.cpu_ms = atof(items.at(3).c_str());
+		r.peak_rss_kb = strtoull(items.at(4).c_str(), nullptr, 10);
+		res[items.at(0) + "/" + items.at(1)] = r;
+	}
+
+	return true;
+}
+
+int PerfRunner::compare(const std::map<std::string, PerfResult>& baseline)
+{
+	int nregressions = 0;
+	double f = 1 + opts.tolerance / 100.0;
+
+	for (const auto& r : results) {
+		auto it = baseline.find(r.first);
+		if (it == baseline.end()) {
+			printf("NEW        %-40s %10.3f ms %10llu KB\n", r.first.c_str(), r.second.wall_ms, (unsigned long long)r.second.peak_rss_kb);
+			continue;
+		}
+
+		const PerfResult& b = it->second;
+
+		bool slower = r.second.wall_ms > b.wall_ms * f && (r.second.wall_ms - b.wall_ms) > opts.min_delta_ms;
+		bool bigger = r.second.peak_rss_kb > b.peak_rss_kb * f && (r.second.peak_rss_kb - b.peak_rss_kb) > opts.min_delta_kb;
+
+		if (slower || bigger) {
+			nregressions++;
+			printf("REGRESSION %-40s %10.3f ms (baseline %10.3f) %10llu KB (baseline %10llu)\n", r.first.c_str(),
+				r.second.wall_ms, b.wall_ms, (unsigned long long)r.second.peak_rss_kb, (unsigned long long)b.peak_rss_kb);
+		}
+	}
+
+	return nregressions;
+}
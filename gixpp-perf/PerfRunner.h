@@ -0,0 +1,71 @@
+/*
+This file is part of Gix-IDE, an IDE and platform for GnuCOBOL
+Copyright (C) 2021 Marco Ridoni
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+USA.
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+
+struct PerfRunnerOptions
+{
+	std::string gixpp_path = "gixpp";
+	std::string gixpp_args = "-e -S -m";	// added to the input/output/copy path parameters
+	std::string copy_path;					// additional COPY path (e.g. the directory containing SQLCA)
+	std::string work_dir;					// where the preprocessed files are written (default: temp dir)
+	int repeat = 3;							// the best result of each phase is kept
+	double tolerance = 25;					// %
+	double min_delta_ms = 5;				// smaller differences are ignored
+	uint64_t min_delta_kb = 4096;
+};
+
+struct PerfResult
+{
+	double wall_ms = 0;
+	double cpu_ms = 0;
+	uint64_t peak_rss_kb = 0;
+};
+
+// Runs gixpp --timings=json on every program in a corpus directory and compares the results with a baseline
+class PerfRunner
+{
+public:
+	PerfRunner(const PerfRunnerOptions& opts);
+
+	bool run(const std::string& corpus_dir);
+
+	// lines: <program> <phase> <wall_ms> <cpu_ms> <peak_rss_kb>
+	bool writeResults(const std::string& filename);
+	bool readResults(const std::string& filename, std::map<std::string, PerfResult>& res);
+
+	// returns the number of regressions
+	int compare(const std::map<std::string, PerfResult>& baseline);
+
+	const std::map<std::string, PerfResult>& getResults() const { return results; }
+
+private:
+	PerfRunnerOptions opts;
+
+	// key: <program>/<phase>
+	std::map<std::string, PerfResult> results;
+
+	bool run_program(const std::string& program, const std::string& infile, const std::string& outfile, const std::string& copy_path);
+	void add_result(const std::string& key, const PerfResult& r);
+};
@@ -0,0 +1,133 @@
+/*
+This file is part of Gix-IDE, an IDE and platform for GnuCOBOL
+Copyright (C) 2021 Marco Ridoni
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+USA.
+*/
+
+#include <iostream>
+#include <string>
+#include <map>
+
+#include "popl.hpp"
+
+#include "CorpusGenerator.h"
+#include "PerfRunner.h"
+
+using namespace popl;
+
+int main(int argc, char** argv)
+{
+	OptionParser options("gixpp-perf - performance regression suite for gixpp\n\nUsage:\n  gixpp-perf generate -d <dir> [options]\n  gixpp-perf run -d <dir> -g <gixpp> [options]\n\nOptions");
+
+	auto opt_help = options.add<Switch>("h", "help", "displays help on commandline options");
+	auto opt_dir = options.add<Value<std::string>>("d", "dir", "corpus directory");
+
+	auto opt_programs = options.add<Value<int>>("", "programs", "generate: number of programs", 5);
+	auto opt_lines = options.add<Value<int>>("", "lines", "generate: approximate number of lines of each program", 30000);
+	auto opt_blocks = options.add<Value<int>>("", "blocks", "generate: EXEC SQL blocks in each program", 2000);
+	auto opt_copy_depth = options.add<Value<int>>("", "copy-depth", "generate: nesting level of the copybooks", 8);
+	auto opt_group_fields = options.add<Value<int>>("", "group-fields", "generate: fields in the host variable group of each program", 500);
+	auto opt_seed = options.add<Value<unsigned int>>("", "seed", "generate: random seed", 1);
+
+	auto opt_gixpp = options.add<Value<std::string>>("g", "gixpp", "run: gixpp executable", "gixpp");
+	auto opt_gixpp_args = options.add<Value<std::string>>("a", "gixpp-args", "run: gixpp options", "-e -S -m");
+	auto opt_copypath = options.add<Value<std::string>>("I", "copypath", "run: additional COPY path (e.g. for SQLCA)");
+	auto opt_workdir = options.add<Value<std::string>>("w", "work-dir", "run: directory for the preprocessed files");
+	auto opt_repeat = options.add<Value<int>>("n", "repeat", "run: runs for each program (the best result is kept)", 3);
+	auto opt_tolerance = options.add<Value<double>>("t", "tolerance", "run: allowed slowdown/memory increase in %", 25);
+	auto opt_baseline = options.add<Value<std::string>>("b", "baseline", "run: baseline file");
+	auto opt_update_baseline = options.add<Switch>("u", "update-baseline", "run: write the results to the baseline file");
+	auto opt_results = options.add<Value<std::string>>("o", "results", "run: results file");
+
+	options.parse(argc, argv);
+
+	if (options.unknown_options().size() > 0) {
+		for (auto uo : options.unknown_options()) {
+			fprintf(stderr, "ERROR: unknown option: %s\n", uo.c_str());
+		}
+		return 1;
+	}
+
+	if (opt_help->is_set() || options.non_option_args().size() != 1 || !opt_dir->is_set()) {
+		std::cout << options << std::endl;
+		return opt_help->is_set() ? 0 : 1;
+	}
+
+	std::string cmd = options.non_option_args().at(0);
+
+	if (cmd == "generate") {
+		CorpusOptions copts;
+		copts.programs = opt_programs->value();
+		copts.lines = opt_lines->value();
+		copts.esql_blocks = opt_blocks->value();
+		copts.copy_depth = opt_copy_depth->value();
+		copts.group_fields = opt_group_fields->value();
+		copts.seed = opt_seed->value();
+
+		if (copts.programs < 1 || copts.lines < 1 || copts.esql_blocks < 1 || copts.copy_depth < 1 || copts.group_fields < 1) {
+			fprintf(stderr, "ERROR: invalid corpus parameters\n");
+			return 1;
+		}
+
+		CorpusGenerator g(copts);
+		return g.generate(opt_dir->value()) ? 0 : 1;
+	}
+
+	if (cmd == "run") {
+		PerfRunnerOptions ropts;
+		ropts.gixpp_path = opt_gixpp->value();
+		ropts.gixpp_args = opt_gixpp_args->value();
+		ropts.copy_path = opt_copypath->is_set() ? opt_copypath->value() : "";
+		ropts.work_dir = opt_workdir->is_set() ? opt_workdir->value() : "";
+		ropts.repeat = opt_repeat->value();
+		ropts.tolerance = opt_tolerance->value();
+
+		PerfRunner r(ropts);
+		if (!r.run(opt_dir->value()))
+			return 1;
+
+		if (opt_results->is_set() && !r.writeResults(opt_results->value())) {
+			fprintf(stderr, "ERROR: cannot write %s\n", opt_results->value().c_str());
+			return 1;
+		}
+
+		if (!opt_baseline->is_set())
+			return 0;
+
+		if (opt_update_baseline->is_set()) {
+			if (!r.writeResults(opt_baseline->value())) {
+				fprintf(stderr, "ERROR: cannot write %s\n", opt_baseline->value().c_str());
+				return 1;
+			}
+			printf("Baseline updated: %s\n", opt_baseline->value().c_str());
+			return 0;
+		}
+
+		std::map<std::string, PerfResult> baseline;
+		if (!r.readResults(opt_baseline->value(), baseline)) {
+			fprintf(stderr, "ERROR: cannot read baseline %s\n", opt_baseline->value().c_str());
+			return 1;
+		}
+
+		int n = r.compare(baseline);
+		printf("%d regression(s)\n", n);
+		return n > 0 ? 1 : 0;
+	}
+
+	fprintf(stderr, "ERROR: unknown command: %s\n", cmd.c_str());
+	return 1;
+}
@@ -0,0 +1,413 @@
+/*
+This file is part of Gix-IDE, an IDE and platform for GnuCOBOL
+Copyright (C) 2021 Marco Ridoni
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+USA.
+*/
+
+#include "GixppServer.h"
+
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#if !defined(_WIN32)
+#include <csignal>
+#include <cerrno>
+#include <climits>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
+
+#define GIXPP_SERVER_MAGIC			((uint32_t) 0x50505847)	// "GXPP"
+#define GIXPP_SERVER_PROTOCOL_VER	((uint32_t) 1)
+#define GIXPP_SERVER_MAX_ARGS		65536
+#define GIXPP_SERVER_MAX_ARG_LEN	(1024 * 1024)
+
+// Request: magic, version, number of strings, then each string as length + data (the first one is the 
+// working directory, then the command line). Response: a sequence of frames (type + length + data) where 
+// type is 'o' (stdout), 'e' (stderr) or 'x' (exit code as text, always the last one). Integers are in native 
+// byte order, since both ends are on the same machine.
+#define FRAME_STDOUT	'o'
+#define FRAME_STDERR	'e'
+#define FRAME_EXIT_CODE	'x'
+
+GixppServer::GixppServer(const std::string& _socket_path) : socket_path(_socket_path)
+{
+}
+
+#if defined(_WIN32)
+
+bool GixppServer::isSupported()
+{
+	return false;
+}
+
+std::string GixppServer::getDefaultSocketPath()
+{
+	return std::string();
+}
+
+bool GixppServer::run(JobHandler handler)
+{
+	fprintf(stderr, "ERROR: server mode is not supported on this platform\n");
+	return false;
+}
+
+bool GixppServer::forwardJob(const std::string& socket_path, const std::vector<std::string>& args, int* rc)
+{
+	return false;
+}
+
+bool GixppServer::handle_client(int fd, JobHandler& handler)
+{
+	return false;
+}
+
+#else
+
+#if defined(MSG_NOSIGNAL)
+#define SEND_FLAGS MSG_NOSIGNAL
+#else
+#define SEND_FLAGS 0
+#endif
+
+static volatile sig_atomic_t stop_requested = 0;
+
+static void on_stop_signal(int)
+{
+	stop_requested = 1;
+}
+
+static bool write_all(int fd, const void* data, size_t len)
+{
+	const char* p = (const char*)data;
+	while (len > 0) {
+		ssize_t n = send(fd, p, len, SEND_FLAGS);
+		if (n < 0 && errno == EINTR)
+			continue;
+
+		if (n <= 0)
+			return false;
+
+		p += n;
+		len -= n;
+	}
+	return true;
+}
+
+static bool read_all(int fd, void* data, size_t len)
+{
+	char* p = (char*)data;
+	while (len > 0) {
+		ssize_t n = recv(fd, p, len, 0);
+		if (n < 0 && errno == EINTR)
+			continue;
+
+		if (n <= 0)
+			return false;
+
+		p += n;
+		len -= n;
+	}
+	return true;
+}
+
+static bool write_uint32(int fd, uint32_t v)
+{
+	return write_all(fd, &v, sizeof(v));
+}
+
+static bool read_uint32(int fd, uint32_t* v)
+{
+	return read_all(fd, v, sizeof(uint32_t));
+}
+
+static bool write_string(int fd, const std::string& s)
+{
+	return write_uint32(fd, (uint32_t)s.size()) && write_all(fd, s.data(), s.size());
+}
+
+static bool read_string(int fd, std::string& s)
+{
+	uint32_t len;
+	if (!read_uint32(fd, &len) || len > GIXPP_SERVER_MAX_ARG_LEN)
+		return false;
+
+	s.resize(len);
+	return len == 0 || read_all(fd, &s[0], len);
+}
+
+static bool write_frame(int fd, char type, const std::string& data)
+{
+	return write_all(fd, &type, 1) && write_string(fd, data);
+}
+
+static std::string read_tmp_file(FILE* f)
+{
+	std::string s;
+	char bfr[8192];
+	size_t n;
+
+	fflush(f);
+	rewind(f);
+	while ((n = fread(bfr, 1, sizeof(bfr), f)) > 0)
+		s.append(bfr, n);
+
+	return s;
+}
+
+static bool init_socket_address(const std::string& socket_path, sockaddr_un* addr)
+{
+	if (socket_path.empty() || socket_path.size() >= sizeof(addr->sun_path))
+		return false;
+
+	memset(addr, 0, sizeof(sockaddr_un));
+	addr->sun_family = AF_UNIX;
+	strcpy(addr->sun_path, socket_path.c_str());
+	return true;
+}
+
+static int connect_to_server(const std::string& socket_path)
+{
+	sockaddr_un addr;
+	if (!init_socket_address(socket_path, &addr))
+		return -1;
+
+	int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0)
+		return -1;
+
+	if (connect(fd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+		close(fd);
+		return -1;
+	}
+
+	return fd;
+}
+
+bool GixppServer::isSupported()
+{
+	return true;
+}
+
+std::string GixppServer::getDefaultSocketPath()
+{
+	const char* rd = getenv("XDG_RUNTIME_DIR");
+	if (rd && *rd)
+		return std::string(rd) + "/gixpp.sock";
+
+	return "/tmp/gixpp-" + std::to_string(getuid()) + ".sock";
+}
+
+bool GixppServer::run(JobHandler handler)
+{
+	sockaddr_un addr;
+	if (!init_socket_address(socket_path, &addr)) {
+		fprintf(stderr, "ERROR: invalid socket path: %s\n", socket_path.c_str());
+		return false;
+	}
+
+	int fd = connect_to_server(socket_path);
+	if (fd >= 0) {
+		close(fd);
+		fprintf(stderr, "ERROR: a gixpp server is already listening on %s\n", socket_path.c_str());
+		return false;
+	}
+
+	// left over by a server that was not stopped cleanly
+	unlink(socket_path.c_str());
+
+	fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0) {
+		fprintf(stderr, "ERROR: cannot create socket: %s\n", strerror(errno));
+		return false;
+	}
+
+	// only the current user can submit jobs
+	mode_t old_mask = umask(077);
+	int rc = bind(fd, (sockaddr*)&addr, sizeof(addr));
+	umask(old_mask);
+
+	if (rc != 0 || listen(fd, 16) != 0) {
+		fprintf(stderr, "ERROR: cannot listen on %s: %s\n", socket_path.c_str(), strerror(errno));
+		close(fd);
+		return false;
+	}
+
+	// no SA_RESTART, so that accept is interrupted
+	struct sigaction sa;
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = on_stop_signal;
+	sigaction(SIGINT, &sa, nullptr);
+	sigaction(SIGTERM, &sa, nullptr);
+	signal(SIGPIPE, SIG_IGN);
+
+	printf("gixpp server listening on %s\n", socket_path.c_str());
+	fflush(stdout);
+
+	while (!stop_requested) {
+		int cfd = accept(fd, nullptr, nullptr);
+		if (cfd < 0) {
+			if (errno == EINTR || errno == ECONNABORTED)
+				continue;
+
+			fprintf(stderr, "ERROR: accept failed: %s\n", strerror(errno));
+			break;
+		}
+
+		if (!handle_client(cfd, handler))
+			fprintf(stderr, "WARNING: invalid request or client disconnected\n");
+
+		close(cfd);
+	}
+
+	close(fd);
+	unlink(socket_path.c_str());
+
+	printf("gixpp server stopped\n");
+	return true;
+}
+
+bool GixppServer::handle_client(int fd, JobHandler& handler)
+{
+	uint32_t magic, version, nstrings;
+
+	// a client checking if the server is running
+	if (!read_uint32(fd, &magic))
+		return true;
+
+	if (magic != GIXPP_SERVER_MAGIC || !read_uint32(fd, &version) || !read_uint32(fd, &nstrings))
+		return false;
+
+	if (version != GIXPP_SERVER_PROTOCOL_VER) {
+		write_frame(fd, FRAME_STDERR, "ERROR: gixpp client/server version mismatch\n");
+		write_frame(fd, FRAME_EXIT_CODE, std::to_string(1));
+		return false;
+	}
+
+	if (nstrings < 2 || nstrings > GIXPP_SERVER_MAX_ARGS)
+		return false;
+
+	std::string cwd;
+	std::vector<std::string> args(nstrings - 1);
+	if (!read_string(fd, cwd))
+		return false;
+
+	for (auto& a : args) {
+		if (!read_string(fd, a))
+			return false;
+	}
+
+	if (chdir(cwd.c_str()) != 0) {
+		write_frame(fd, FRAME_STDERR, "ERROR: cannot change directory to " + cwd + "\n");
+		return write_frame(fd, FRAME_EXIT_CODE, std::to_string(1));
+	}
+
+	// Jobs are run one at a time, so the server's stdout/stderr can be redirected while the job runs:
+	// this also captures the output from the libraries
+	FILE* job_out = tmpfile();
+	FILE* job_err = tmpfile();
+	if (!job_out || !job_err) {
+		if (job_out) fclose(job_out);
+		if (job_err) fclose(job_err);
+		write_frame(fd, FRAME_STDERR, "ERROR: cannot create temporary files on the gixpp server\n");
+		return write_frame(fd, FRAME_EXIT_CODE, std::to_string(1));
+	}
+
+	fflush(stdout);
+	fflush(stderr);
+	int saved_out = dup(STDOUT_FILENO);
+	int saved_err = dup(STDERR_FILENO);
+	dup2(fileno(job_out), STDOUT_FILENO);
+	dup2(fileno(job_err), STDERR_FILENO);
+
+	int job_rc;
+	try {
+		job_rc = handler(args);
+	}
+	catch (std::exception& e) {
+		fprintf(stderr, "ERROR: %s\n", e.what());
+		job_rc = 1;
+	}
+
+	std::cout.flush();
+	fflush(stdout);
+	fflush(stderr);
+	dup2(saved_out, STDOUT_FILENO);
+	dup2(saved_err, STDERR_FILENO);
+	close(saved_out);
+	close(saved_err);
+
+	bool b = write_frame(fd, FRAME_STDOUT, read_tmp_file(job_out)) && write_frame(fd, FRAME_STDERR, read_tmp_file(job_err)) &&
+		write_frame(fd, FRAME_EXIT_CODE, std::to_string(job_rc));
+
+	fclose(job_out);
+	fclose(job_err);
+	return b;
+}
+
+bool GixppServer::forwardJob(const std::string& socket_path, const std::vector<std::string>& args, int* rc)
+{
+	int fd = connect_to_server(socket_path);
+	if (fd < 0)
+		return false;
+
+	char cwd[PATH_MAX];
+	if (!getcwd(cwd, sizeof(cwd))) {
+		close(fd);
+		return false;
+	}
+
+	bool b = write_uint32(fd, GIXPP_SERVER_MAGIC) && write_uint32(fd, GIXPP_SERVER_PROTOCOL_VER) && write_uint32(fd, (uint32_t)args.size() + 1) && write_string(fd, cwd);
+	for (size_t i = 0; b && i < args.size(); i++)
+		b = write_string(fd, args.at(i));
+
+	// once the request has been sent the job cannot be run again in-process
+	while (b) {
+		char type;
+		std::string data;
+		if (!read_all(fd, &type, 1) || !read_string(fd, data))
+			break;
+
+		switch (type) {
+			case FRAME_STDOUT:
+				fwrite(data.data(), 1, data.size(), stdout);
+				break;
+
+			case FRAME_STDERR:
+				fwrite(data.data(), 1, data.size(), stderr);
+				break;
+
+			case FRAME_EXIT_CODE:
+				close(fd);
+				*rc = atoi(data.c_str());
+				return true;
+		}
+	}
+
+	close(fd);
+	fprintf(stderr, "ERROR: connection to the gixpp server on %s lost\n", socket_path.c_str());
+	*rc = 1;
+	return true;
+}
+
+#endif
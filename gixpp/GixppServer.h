@@ -0,0 +1,52 @@
+/*
+This file is part of Gix-IDE, an IDE and platform for GnuCOBOL
+Copyright (C) 2021 Marco Ridoni
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+USA.
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <functional>
+
+// gixpp --server: preprocessing jobs (working directory + command line) are received over
+// a local UNIX domain socket and run one at a time in the server process, so that the COPY 
+// resolution and COPY file caches stay warm between jobs. Output and exit code of each job 
+// are sent back to the client.
+class GixppServer
+{
+public:
+	// runs a job with the server's current directory set to the client's one, returns its exit code
+	using JobHandler = std::function<int(const std::vector<std::string>& args)>;
+
+	GixppServer(const std::string& socket_path);
+
+	// returns when the server is stopped (SIGINT/SIGTERM), false if the socket cannot be set up
+	bool run(JobHandler handler);
+
+	// Client side: false if no server is listening on socket_path (the job should be run in-process)
+	static bool forwardJob(const std::string& socket_path, const std::vector<std::string>& args, int* rc);
+
+	static bool isSupported();
+	static std::string getDefaultSocketPath();
+
+private:
+	std::string socket_path;
+
+	bool handle_client(int fd, JobHandler& handler);
+};
@@ -21,6 +21,12 @@ USA.
 #include <map>
 #include <vector>
 #include <string>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
 
 #include "popl.hpp"
 
@@ -29,7 +35,9 @@ USA.
 #include "TPSourceConsolidation.h"
 #include "TPESQLParser.h"
 #include "TPESQLProcessor.h"
+#include "MapFileData.h"
 #include "libcpputils.h"
+#include "GixppServer.h"
 
 #include "config.h"
 
@@ -51,15 +59,28 @@ using namespace popl;
 
 bool is_alias(const std::string& f, std::string& ext);
 std::string get_basename(const std::string& f);
+bool read_response_file(const std::string& f, std::vector<std::pair<std::string, std::string>>& jobs);
 
-int main(int argc, char** argv)
+// Caches kept by a gixpp server between jobs
+struct ServerCaches
 {
-	int rc = -1;
+	SourceFileCache source_file_cache;
+
+	// key: COPY search configuration
+	std::map<std::string, std::unique_ptr<CopyResolver>> copy_resolvers;
+};
 
-	GixPreProcessor gp;
+int run_gixpp(int argc, char** argv, ServerCaches* server_caches);
+int run_server(const std::string& socket_path);
+
+int main(int argc, char** argv)
+{
+	return run_gixpp(argc, argv, nullptr);
+}
 
-	std::shared_ptr<TPESQLParser> esql_parser;
-	std::shared_ptr<TPESQLProcessor> esql_generator;
+int run_gixpp(int argc, char** argv, ServerCaches* server_caches)
+{
+	int rc = -1;
 
 	// Do processing here
 	const auto args = argv;
@@ -88,11 +109,34 @@ int main(int argc, char** argv)
 	auto opt_verbose_debug = options.add<Switch>("d", "verbose-debug", "verbose (debug)");
 	auto opt_parser_scanner_debug = options.add<Switch>("D", "parser-scanner-debug", "parser/scanner debug output");
 	auto opt_emit_map_file = options.add<Switch>("m", "map", "emit map file");
+	auto opt_map_format = options.add<Value<std::string>>("", "map-format", "map file format (=text|binary)", "text");
+	auto opt_convert_map = options.add<Switch>("", "convert-map", "convert the map file given with -i to the other format (text/binary) and write it to the file given with -o");
 	auto opt_emit_cobol85 = options.add<Switch>("C", "cobol85", "emit COBOL85-compliant code");
 	auto opt_varying_ids = options.add<Value<std::string>>("Y", "varying", "length/data suffixes for varlen fields (=LEN,ARR)");
 	auto opt_varying_len_sz = options.add<Value<std::string>>("N", "varying-length-size", "size of the length indicator fields for VARYING fields(=2|4))", DEFAULT_VARYING_LEN_SZ);
 	auto opt_picx_as_varchar = options.add<Value<std::string>>("P", "picx-as", "text field options (=char|charf|varchar)", "char");
 	auto opt_no_rec_code = options.add<Value<std::string>>("", "no-rec-code", "custom code for \"no record\" condition(=nnn)");
+	auto opt_eager_prepare = options.add<Switch>("", "eager-prepare", "ESQL: prepare all static statements on first use of a connection");
+	auto opt_response_file = options.add<Value<std::string>>("r", "response-file", "file with input/output file pairs (one pair per line)");
+	auto opt_jobs = options.add<Value<int>>("j", "jobs", "number of files preprocessed in parallel (=0 for all available cores)", 1);
+	auto opt_incremental = options.add<Switch>("", "incremental", "skip files whose source, copy files and options did not change since the last run");
+	auto opt_copy_index = options.add<Value<std::string>>("", "copy-index", "COPY directory index file (created/updated if needed)");
+	auto opt_copy_case_insensitive = options.add<Switch>("", "copy-case-insensitive", "case-insensitive COPY file name resolution");
+	auto opt_timings = options.add<Implicit<std::string>>("", "timings", "print timing, memory usage and counters for each file (=human|json)", "human");
+	auto opt_depfile_md = options.add<Switch>("", "MD", "write a dependency file (<output file>.d) listing all the COPY files used");
+	auto opt_depfile_mf = options.add<Value<std::string>>("", "MF", "write the dependency file to the given file (implies -MD)");
+	auto opt_server = options.add<Implicit<std::string>>("", "server", "run as a server that accepts preprocessing jobs on a local socket (=socket path)", GixppServer::getDefaultSocketPath());
+	auto opt_use_server = options.add<Implicit<std::string>>("", "use-server", "send the job to a gixpp server, if one is running (=socket path, also set by GIXPP_SERVER)", GixppServer::getDefaultSocketPath());
+
+	// -MD/-MF are also accepted with a single dash, as in gcc
+	std::vector<std::string> arg_list(argv, argv + argc);
+	std::vector<char*> arg_ptrs;
+	for (auto& a : arg_list) {
+		if (a == "-MD" || a == "-MF")
+			a = "-" + a;
+		arg_ptrs.push_back(a.data());
+	}
+	argv = arg_ptrs.data();
 
 	options.parse(argc, argv);
 
@@ -117,18 +161,111 @@ int main(int argc, char** argv)
 		}
 		else {
 
+			if (opt_server->is_set()) {
+				if (server_caches) {
+					fprintf(stderr, "ERROR: --server cannot be used in a job sent to a server\n");
+					return 1;
+				}
+				return run_server(opt_server->value());
+			}
+
+			std::string server_socket = opt_use_server->is_set() ? opt_use_server->value() : (getenv("GIXPP_SERVER") ? getenv("GIXPP_SERVER") : "");
+			if (!server_socket.empty() && !server_caches) {
+				// the server parses the arguments again, if no server is running the job is run here
+				std::vector<std::string> server_args;
+				for (const auto& a : arg_list) {
+					if (!starts_with(a, "--use-server"))
+						server_args.push_back(a);
+				}
+
+				int server_rc;
+				if (GixppServer::forwardJob(server_socket, server_args, &server_rc))
+					return server_rc;
+			}
+
+			if (opt_convert_map->is_set()) {
+				if (!opt_infile->is_set() || !opt_outfile->is_set()) {
+					std::cout << options << std::endl;
+					fprintf(stderr, "ERROR: please enter the input and output map files\n");
+					return 1;
+				}
+
+				if (!MapFileData::convert(opt_infile->value(), opt_outfile->value())) {
+					fprintf(stderr, "ERROR: cannot convert map file %s\n", opt_infile->value().c_str());
+					return 1;
+				}
+
+				return 0;
+			}
+
 			if (!opt_consolidate->is_set() && !opt_esql->is_set()) {
 				std::cout << options << std::endl;
 				fprintf(stderr, "ERROR: please enter at least one of the -e or -c options\n");
 				return 1;
 			}
 
-			if (!opt_infile->is_set() || !opt_outfile->is_set()) {
+			std::vector<std::pair<std::string, std::string>> jobs;
+
+			if (opt_response_file->is_set()) {
+				if (!read_response_file(opt_response_file->value(), jobs)) {
+					fprintf(stderr, "ERROR: cannot read response file %s\n", opt_response_file->value().c_str());
+					return 1;
+				}
+			}
+
+			if (opt_infile->is_set() || opt_outfile->is_set()) {
+				if (opt_infile->count() != opt_outfile->count() && opt_outfile->count() != 1) {
+					std::cout << options << std::endl;
+					fprintf(stderr, "ERROR: please enter an output file for each input file\n");
+					return 1;
+				}
+
+				for (int i = 0; i < opt_infile->count(); i++)
+					jobs.push_back({ opt_infile->value(i), opt_outfile->value(opt_outfile->count() == 1 ? 0 : i) });
+			}
+
+			if (jobs.empty()) {
 				std::cout << options << std::endl;
 				fprintf(stderr, "ERROR: please enter at least the input and output file parameters\n");
 				return 1;
 			}
 
+			for (auto& job : jobs) {
+				std::string outext;
+				if (is_alias(job.second, outext)) {
+					job.second = get_basename(job.first) + "." + outext;
+				}
+
+				if (job.first == job.second) {
+					fprintf(stderr, "ERROR: input and output file must be different (%s)\n", job.first.c_str());
+					return 1;
+				}
+			}
+
+			if (opt_depfile_mf->is_set() && jobs.size() > 1) {
+				std::cout << options << std::endl;
+				fprintf(stderr, "ERROR: --MF can only be used with a single input file, use --MD instead\n");
+				return 1;
+			}
+
+			if (opt_timings->is_set() && opt_timings->value() != "human" && opt_timings->value() != "json") {
+				std::cout << options << std::endl;
+				fprintf(stderr, "ERROR: --timings argument must be one of \"human\", \"json\"\n");
+				return 1;
+			}
+
+			if (opt_map_format->value() != "text" && opt_map_format->value() != "binary") {
+				std::cout << options << std::endl;
+				fprintf(stderr, "ERROR: --map-format argument must be one of \"text\", \"binary\"\n");
+				return 1;
+			}
+
+			if (opt_jobs->value() < 0) {
+				std::cout << options << std::endl;
+				fprintf(stderr, "ERROR: -j/--jobs argument must be a positive number\n");
+				return 1;
+			}
+
 
 			if (opt_picx_as_varchar->is_set() && opt_picx_as_varchar->value() != "char" && opt_picx_as_varchar->value() != "charf" && opt_picx_as_varchar->value() != "varchar") {
 				std::cout << options << std::endl;
@@ -152,90 +289,189 @@ int main(int argc, char** argv)
 				return 1;
 			}
 
-			CopyResolver copy_resolver(filename_get_dir(filename_absolute_path(opt_infile->value())));
-
-			copy_resolver.setVerbose(opt_verbose->is_set());
-
+			std::vector<std::string> copy_dirs;
 			if (opt_copypath->is_set()) {
 				for (int i = 0; i < opt_copypath->count(); i++) {
-					std::vector<std::string> copy_dirs = string_split(opt_copypath->value(i), PATH_LIST_SEP);
-					if (copy_dirs.size() && !copy_dirs.at(0).empty()) {
-						copy_resolver.addCopyDirs(copy_dirs);
+					std::vector<std::string> cds = string_split(opt_copypath->value(i), PATH_LIST_SEP);
+					if (cds.size() && !cds.at(0).empty()) {
+						for (const auto& cd : cds) {
+							// jobs sent to a server can have different working directories
+							if (!cd.empty())
+								copy_dirs.push_back(server_caches ? filename_absolute_path(cd) : cd);
+						}
 					}
 				}
 			}
 
-			gp.setCopyResolver(&copy_resolver);
+			std::string copy_exts = (opt_esql->is_set() && opt_esql_copy_exts->is_set()) ? opt_esql_copy_exts->value() : "";
+			std::string copy_index = opt_copy_index->is_set() ? opt_copy_index->value() : "";
+
+			// The resolver (and its cache) is shared by all the files, a server keeps it for later jobs with the same COPY search configuration
+			std::unique_ptr<CopyResolver> local_copy_resolver;
+			CopyResolver* copy_resolver = nullptr;
+			std::string copy_resolver_key;
+
+			if (server_caches) {
+				copy_resolver_key = vector_join(copy_dirs, PATH_LIST_SEP) + "|" + copy_exts + "|" + (opt_copy_case_insensitive->is_set() ? "I" : "") + "|" + (copy_index.empty() ? "" : filename_absolute_path(copy_index));
+				auto it = server_caches->copy_resolvers.find(copy_resolver_key);
+				if (it != server_caches->copy_resolvers.end()) {
+					copy_resolver = it->second.get();
+					copy_resolver->revalidate();
+				}
+			}
+
+			if (!copy_resolver) {
+				local_copy_resolver = std::make_unique<CopyResolver>(filename_get_dir(filename_absolute_path(jobs.at(0).first)));
+				copy_resolver = local_copy_resolver.get();
+
+				if (copy_dirs.size())
+					copy_resolver->addCopyDirs(copy_dirs);
 
-			if (opt_consolidate->is_set())
-				gp.addStep(std::make_shared<TPSourceConsolidation>(&gp));
+				if (!copy_exts.empty())
+					copy_resolver->setExtensions(string_split(copy_exts, ","));
 
+				if (opt_copy_case_insensitive->is_set())
+					copy_resolver->setCaseInsensitive(true);
 
-			if (opt_esql->is_set()) {
-				if (opt_varying_ids->is_set())
-					gp.setOpt("varlen_suffixes", opt_varying_ids->value());
+				// a missing or invalid index file is simply rebuilt
+				if (!copy_index.empty())
+					copy_resolver->loadIndex(copy_index);
 
-				gp.setOpt("emit_static_calls", opt_esql_static_calls->is_set());
-				gp.setOpt("params_style", opt_esql_param_style->value());
-				gp.setOpt("preprocess_copy_files", opt_esql_preprocess_copy->is_set());
-				gp.setOpt("consolidated_map", true);
-				gp.setOpt("emit_map_file", opt_emit_map_file->is_set());
-				gp.setOpt("emit_cobol85", opt_emit_cobol85->is_set());
-				gp.setOpt("picx_as_varchar", to_lower(opt_picx_as_varchar->value()) == "varchar");
-				gp.setOpt("debug_parser_scanner", opt_parser_scanner_debug->is_set());
+				if (server_caches)
+					server_caches->copy_resolvers[copy_resolver_key] = std::move(local_copy_resolver);
+			}
 
-				std::string vls = opt_varying_len_sz->value_or(DEFAULT_VARYING_LEN_SZ);
-				gp.setOpt("varying_len_sz_short", (vls == "2"));
+			copy_resolver->setVerbose(opt_verbose->is_set());
 
-				if (opt_esql_copy_exts->is_set())
-					copy_resolver.setExtensions(string_split(opt_esql_copy_exts->value(), ","));
+			// COPY files are read only once, even when included by several files (or by several jobs sent to a server)
+			SourceFileCache local_source_file_cache;
+			SourceFileCache* source_file_cache = &local_source_file_cache;
+			if (server_caches) {
+				source_file_cache = &server_caches->source_file_cache;
+				source_file_cache->revalidate();
+			}
 
-				if (opt_no_rec_code->is_set()) {
-					std::string c = opt_no_rec_code->value();
-					int i = atoi(c.c_str());
-					if (i != 0 && i >= -999999999 && i <= 999999999) {
-						gp.setOpt("no_rec_code", i);
+			// Each file gets its own preprocessor instance, messages are collected and printed when the file is done
+			auto preprocess_file = [&](const std::string& infile, const std::string& outfile, std::vector<std::string>& messages, std::string& timings) -> int {
+
+				GixPreProcessor gp;
+
+				gp.setCopyResolver(copy_resolver);
+				gp.setSourceFileCache(source_file_cache);
+
+				if (opt_consolidate->is_set())
+					gp.addStep(std::make_shared<TPSourceConsolidation>(&gp));
+
+				if (opt_esql->is_set()) {
+					if (opt_varying_ids->is_set())
+						gp.setOpt("varlen_suffixes", opt_varying_ids->value());
+
+					gp.setOpt("emit_static_calls", opt_esql_static_calls->is_set());
+					gp.setOpt("eager_prepare", opt_eager_prepare->is_set());
+					gp.setOpt("params_style", opt_esql_param_style->value());
+					gp.setOpt("preprocess_copy_files", opt_esql_preprocess_copy->is_set());
+					gp.setOpt("consolidated_map", true);
+					gp.setOpt("emit_map_file", opt_emit_map_file->is_set());
+					gp.setOpt("binary_map_file", opt_map_format->value() == "binary");
+					gp.setOpt("emit_cobol85", opt_emit_cobol85->is_set());
+					gp.setOpt("picx_as_varchar", to_lower(opt_picx_as_varchar->value()) == "varchar");
+					gp.setOpt("debug_parser_scanner", opt_parser_scanner_debug->is_set());
+
+					std::string vls = opt_varying_len_sz->value_or(DEFAULT_VARYING_LEN_SZ);
+					gp.setOpt("varying_len_sz_short", (vls == "2"));
+
+					if (opt_no_rec_code->is_set()) {
+						std::string c = opt_no_rec_code->value();
+						int i = atoi(c.c_str());
+						if (i != 0 && i >= -999999999 && i <= 999999999) {
+							gp.setOpt("no_rec_code", i);
+						}
 					}
+
+					gp.addStep(std::make_shared<TPESQLParser>(&gp));
+					gp.addStep(std::make_shared<TPESQLProcessor>(&gp));
 				}
 
-				gp.addStep(std::make_shared<TPESQLParser>(&gp));
+				gp.setOpt("emit_debug_info", opt_debug_info->is_set());
+				gp.verbose = opt_verbose->is_set();
+				gp.verbose_debug = opt_verbose_debug->is_set();
+				gp.check_update_status = opt_incremental->is_set();
+				gp.collect_timings = opt_timings->is_set();
+
+				if (opt_depfile_mf->is_set())
+					gp.setOpt("depfile", opt_depfile_mf->value());
+				else
+					if (opt_depfile_md->is_set())
+						gp.setOpt("depfile", filename_change_ext(outfile, ".d"));
+
+				gp.setInputFile(infile);
+				gp.setOutputFile(outfile);
+
+				bool b = gp.process();
+				if (!b) {
+					for (std::string m : gp.err_data.err_messages)
+						messages.push_back(m);
+				}
 
-				esql_generator = std::make_shared<TPESQLProcessor>(&gp);
-				gp.addStep(esql_generator);
-			}
+				for (std::string w : gp.err_data.warnings)
+					messages.push_back(w);
 
-			gp.setOpt("emit_debug_info", opt_debug_info->is_set());
-			gp.verbose = opt_verbose->is_set();
-			gp.verbose_debug = opt_verbose_debug->is_set();
+				if (gp.collect_timings)
+					timings = gp.getTimingsReport(opt_timings->value() == "json");
 
+				return gp.err_data.err_code;
+			};
 
-			std::string infile = opt_infile->value(0);
-			std::string outfile = opt_outfile->value(0);
-			std::string outext;
+			int njobs = opt_jobs->value();
+			if (njobs == 0)
+				njobs = std::max(1, (int)std::thread::hardware_concurrency());
 
-			if (is_alias(outfile, outext)) {
-				outfile = get_basename(infile) + "." + outext;
-			}
+			if (njobs > jobs.size())
+				njobs = jobs.size();
 
-			if (infile == outfile) {
-				fprintf(stderr, "ERROR: input and output file must be different\n");
-				return 1;
-			}
+			std::vector<int> results(jobs.size(), 0);
+			std::atomic<size_t> next_job(0);
+			std::mutex output_lock;
+
+			auto worker = [&]() {
+				size_t n;
+				while ((n = next_job++) < jobs.size()) {
+					std::vector<std::string> messages;
+					std::string timings;
+					results[n] = preprocess_file(jobs[n].first, jobs[n].second, messages, timings);
+
+					std::lock_guard<std::mutex> lock(output_lock);
+					for (const auto& m : messages)
+						fprintf(stderr, "%s\n", m.c_str());
 
-			gp.setInputFile(infile);
-			gp.setOutputFile(outfile);
+					if (!timings.empty())
+						fprintf(stdout, "%s\n", timings.c_str());
+				}
+			};
+
+			if (njobs == 1) {
+				worker();
+			}
+			else {
+				std::vector<std::thread> workers;
+				for (int i = 0; i < njobs; i++)
+					workers.push_back(std::thread(worker));
 
-			bool b = gp.process();
-			if (!b) {
-				rc = gp.err_data.err_code;
-				for (std::string m : gp.err_data.err_messages)
-					fprintf(stderr, "%s\n", m.c_str());
+				for (auto& w : workers)
+					w.join();
 			}
 
-			for (std::string w : gp.err_data.warnings)
-				fprintf(stderr, "%s\n", w.c_str());
+			if (!copy_index.empty() && !copy_resolver->saveIndex(copy_index))
+				fprintf(stderr, "WARNING: cannot write COPY index file %s\n", opt_copy_index->value().c_str());
 
-			rc = gp.err_data.err_code;
+			// The first error (in input order) determines the exit code
+			rc = 0;
+			for (int r : results) {
+				if (r != 0) {
+					rc = r;
+					break;
+				}
+			}
 
 		}
 
@@ -244,6 +480,24 @@ int main(int argc, char** argv)
 
 }
 
+int run_server(const std::string& socket_path)
+{
+	ServerCaches server_caches;
+	GixppServer server(socket_path);
+
+	bool b = server.run([&server_caches](const std::vector<std::string>& args) {
+		std::vector<std::string> job_args(args);
+		std::vector<char*> job_argv;
+		for (auto& a : job_args)
+			job_argv.push_back(a.data());
+		job_argv.push_back(nullptr);
+
+		return run_gixpp(job_args.size(), job_argv.data(), &server_caches);
+	});
+
+	return b ? 0 : 1;
+}
+
 bool is_alias(const std::string& f, std::string& ext)
 {
 	std::filesystem::path p(f);
@@ -262,3 +516,28 @@ std::string get_basename(const std::string& f)
 
 	return p.stem().string();
 }
+
+bool read_response_file(const std::string& f, std::vector<std::pair<std::string, std::string>>& jobs)
+{
+	std::ifstream rf(f);
+	if (!rf.is_open())
+		return false;
+
+	// Each line contains an input and an output file name (use double quotes for names with spaces), 
+	// empty lines and lines starting with '#' are ignored
+	std::string line;
+	while (std::getline(rf, line)) {
+		trim(line);
+		if (line.empty() || line.at(0) == '#')
+			continue;
+
+		std::string infile, outfile;
+		std::istringstream iss(line);
+		if (!(iss >> std::quoted(infile) >> std::quoted(outfile)))
+			return false;
+
+		jobs.push_back({ infile, outfile });
+	}
+
+	return true;
+}
@@ -0,0 +1,205 @@
+/*
+This file is part of Gix-IDE, an IDE and platform for GnuCOBOL
+Copyright (C) 2021 Marco Ridoni
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+USA.
+*/
+
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "popl.hpp"
+
+#include "trace_events.h"
+
+using namespace popl;
+
+struct DecodedEvent {
+	uint64_t thread_id;
+	TraceEvent ev;
+};
+
+static std::string format_payload(const TraceEvent& e)
+{
+	size_t len = strnlen(e.payload, TRACE_PAYLOAD_SIZE);
+	std::string s;
+	for (size_t i = 0; i < len; i++) {
+		unsigned char c = (unsigned char)e.payload[i];
+		s += (c >= 32 && c < 127) ? (char)c : '.';
+	}
+	if (e.flags & TRACE_FLAG_TRUNCATED)
+		s += "...";
+	return s;
+}
+
+static std::string format_wall_clock(uint64_t ns)
+{
+	time_t secs = (time_t)(ns / 1000000000);
+	struct tm tm_info;
+#if defined(_WIN32) || defined(_WIN64)
+	localtime_s(&tm_info, &secs);
+#else
+	localtime_r(&secs, &tm_info);
+#endif
+	char bfr[64];
+	strftime(bfr, sizeof(bfr), "%Y-%m-%d %H:%M:%S", &tm_info);
+	snprintf(bfr + strlen(bfr), sizeof(bfr) - strlen(bfr), ".%06llu", (unsigned long long)((ns % 1000000000) / 1000));
+	return bfr;
+}
+
+int main(int argc, char** argv)
+{
+	OptionParser options("gixsql-trace - decodes the trace dumps written by the GixSQL runtime (GIXSQL_TRACE_RING)\n\nUsage:\n  gixsql-trace [options] <dump file>\n\nOptions");
+
+	auto opt_help = options.add<Switch>("h", "help", "displays help on commandline options");
+	auto opt_abs = options.add<Switch>("a", "absolute", "print wall-clock timestamps instead of the time relative to the first event");
+	auto opt_thread = options.add<Value<uint64_t>>("t", "thread", "only print the events of this thread");
+	auto opt_conn = options.add<Value<uint32_t>>("c", "connection", "only print the events of this connection id");
+	auto opt_summary = options.add<Switch>("s", "summary", "print the number of events and the total time for each event type");
+
+	try {
+		options.parse(argc, argv);
+	}
+	catch (std::exception& ex) {
+		std::cerr << ex.what() << std::endl;
+		return 1;
+	}
+
+	if (opt_help->is_set() || options.non_option_args().size() != 1) {
+		std::cout << options << std::endl;
+		return opt_help->is_set() ? 0 : 1;
+	}
+
+	std::string filename = options.non_option_args().at(0);
+	std::ifstream f(filename, std::ios::binary);
+	if (!f.is_open()) {
+		std::cerr << "Cannot open " << filename << std::endl;
+		return 1;
+	}
+
+	TraceFileHeader hdr;
+	if (!f.read((char*)&hdr, sizeof(TraceFileHeader)) || memcmp(hdr.magic, TRACE_FILE_MAGIC, 8) != 0) {
+		std::cerr << filename << " is not a GixSQL trace dump" << std::endl;
+		return 1;
+	}
+
+	if (hdr.byte_order != TRACE_BYTE_ORDER_MARK) {
+		std::cerr << filename << " was written on a platform with a different byte order" << std::endl;
+		return 1;
+	}
+
+	if (hdr.version != TRACE_FILE_VERSION || hdr.event_size != sizeof(TraceEvent)) {
+		std::cerr << "Unsupported trace dump version (" << hdr.version << ", event size " << hdr.event_size << ")" << std::endl;
+		return 1;
+	}
+
+	std::vector<DecodedEvent> events;
+	uint64_t total_dropped = 0;
+	for (uint32_t i = 0; i < hdr.thread_count; i++) {
+		TraceThreadHeader th;
+		if (!f.read((char*)&th, sizeof(TraceThreadHeader))) {
+			std::cerr << "Truncated trace dump (thread " << i << ")" << std::endl;
+			return 1;
+		}
+
+		total_dropped += th.dropped;
+		for (uint64_t n = 0; n < th.event_count; n++) {
+			DecodedEvent de;
+			de.thread_id = th.thread_id;
+			if (!f.read((char*)&de.ev, sizeof(TraceEvent))) {
+				std::cerr << "Truncated trace dump (thread " << th.thread_id << ")" << std::endl;
+				return 1;
+			}
+
+			if (opt_thread->is_set() && th.thread_id != opt_thread->value())
+				continue;
+
+			if (opt_conn->is_set() && de.ev.handle != opt_conn->value())
+				continue;
+
+			events.push_back(de);
+		}
+	}
+
+	std::stable_sort(events.begin(), events.end(), [](const DecodedEvent& a, const DecodedEvent& b) {
+		return a.ev.timestamp < b.ev.timestamp;
+	});
+
+	std::cout << "# pid " << hdr.pid << ", " << hdr.thread_count << " thread(s), " << events.size() << " event(s), " << total_dropped << " overwritten, dumped at " << format_wall_clock(hdr.wall_clock_ns) << std::endl;
+
+	if (opt_summary->is_set()) {
+		std::vector<uint64_t> counts(TRACE_EV_MAX + 1), elapsed(TRACE_EV_MAX + 1);
+		for (const auto& de : events) {
+			uint16_t id = de.ev.event_id <= TRACE_EV_MAX ? de.ev.event_id : 0;
+			if (de.ev.flags & TRACE_FLAG_END) {
+				elapsed[id] += (uint64_t)de.ev.value;
+				continue;
+			}
+			counts[id]++;
+		}
+
+		printf("%-16s %10s %14s %12s\n", "event", "count", "total (ms)", "avg (us)");
+		for (int id = 0; id <= TRACE_EV_MAX; id++) {
+			if (!counts[id])
+				continue;
+			printf("%-16s %10llu %14.3f %12.3f\n", trace_event_name(id), (unsigned long long)counts[id], elapsed[id] / 1e6, (elapsed[id] / 1e3) / counts[id]);
+		}
+		return 0;
+	}
+
+	uint64_t first = events.empty() ? 0 : events[0].ev.timestamp;
+	for (const auto& de : events) {
+		const TraceEvent& e = de.ev;
+		std::string ts;
+		if (opt_abs->is_set()) {
+			// timestamps are from the steady clock: convert them using the clock values saved in the header
+			ts = format_wall_clock(hdr.wall_clock_ns - (hdr.steady_clock_ns - e.timestamp));
+		}
+		else {
+			char bfr[32];
+			snprintf(bfr, sizeof(bfr), "%14.6f", (e.timestamp - first) / 1e9);
+			ts = bfr;
+		}
+
+		const char* kind = (e.flags & TRACE_FLAG_BEGIN) ? "begin" : (e.flags & TRACE_FLAG_END) ? "end" : "";
+		printf("%s [%llu] %-15s %-5s conn=%u", ts.c_str(), (unsigned long long)de.thread_id, trace_event_name(e.event_id), kind, e.handle);
+
+		if (e.flags & TRACE_FLAG_END) {
+			printf(" elapsed=%.3fus\n", e.value / 1e3);
+			continue;
+		}
+
+		if (e.ref)
+			printf(" ref=0x%llx", (unsigned long long)e.ref);
+
+		if (!(e.flags & TRACE_FLAG_BEGIN))
+			printf(" value=%lld", (long long)e.value);
+
+		std::string p = format_payload(e);
+		if (!p.empty())
+			printf(" \"%s\"", p.c_str());
+
+		printf("\n");
+	}
+
+	return 0;
+}
@@ -22,6 +22,10 @@ USA.
 #include "libcpputils.h"
 
 #include <filesystem>
+#include <fstream>
+#include <mutex>
+
+#define COPY_INDEX_HEADER	"gixpp-copy-index 1"
 
 
 CopyResolver::CopyResolver(const std::string& base_dir, const std::vector<std::string> &_copy_dirs)
@@ -38,6 +42,7 @@ CopyResolver::CopyResolver(const std::string& base_dir)
 
 void CopyResolver::resetCache()
 {
+	std::unique_lock<std::shared_mutex> lock(resolve_cache_lock);
 	resolve_cache.clear();
 }
 
@@ -99,9 +104,13 @@ bool CopyResolver::resolveCopyFile(const std::string copy_name, std::string &cop
 		return false;
 	}
 
-	if (map_contains<std::string>(resolve_cache, copy_name)) {
-		copy_file = resolve_cache[copy_name];
-		return true;
+	{
+		std::shared_lock<std::shared_mutex> lock(resolve_cache_lock);
+		auto it = resolve_cache.find(copy_name);
+		if (it != resolve_cache.end()) {
+			copy_file = it->second;
+			return true;
+		}
 	}
 
 	if (copy_dirs.empty())
@@ -129,6 +138,10 @@ bool CopyResolver::resolve_from_dir(const std::string& copy_dir, const std::stri
 	if (copy_dir.empty())
 		return false;
 
+	// names containing a path are probed directly
+	if (use_index && copy_name.find_first_of("/\\") == std::string::npos)
+		return resolve_from_index(copy_dir, copy_name, copy_file);
+
 	for (std::string ext : copy_exts) {
 
 		std::filesystem::path the_file(copy_dir + PATH_SEPARATOR + trim_copy(copy_name));
@@ -143,6 +156,8 @@ bool CopyResolver::resolve_from_dir(const std::string& copy_dir, const std::stri
 
 		if (std::filesystem::exists(the_file)) {
 			copy_file = filename_absolute_path(the_file);
+
+			std::unique_lock<std::shared_mutex> lock(resolve_cache_lock);
 			resolve_cache[copy_name] = copy_file;
 			if (verbose)
 				printf("OK\n");
@@ -155,3 +170,167 @@ bool CopyResolver::resolve_from_dir(const std::string& copy_dir, const std::stri
 	}
 	return false;
 }
+
+bool CopyResolver::resolve_from_index(const std::string& copy_dir, const std::string& copy_name, std::string& copy_file)
+{
+	std::unique_lock<std::shared_mutex> lock(resolve_cache_lock);
+
+	CopyDirIndex& idx = get_dir_index(copy_dir);
+
+	for (std::string ext : copy_exts) {
+
+		if (ext == ".")
+			ext = "";
+
+		if (verbose) {
+			printf("Trying \"%s\" (indexed): ", (copy_dir + PATH_SEPARATOR + copy_name + ext).c_str());
+		}
+
+		auto it = idx.files.find(get_index_key(copy_name + ext));
+		if (it != idx.files.end()) {
+			copy_file = filename_absolute_path(copy_dir + PATH_SEPARATOR + it->second);
+			resolve_cache[copy_name] = copy_file;
+			if (verbose)
+				printf("OK\n");
+
+			return true;
+		}
+
+		if (verbose)
+			printf("KO\n");
+	}
+	return false;
+}
+
+// Must be called with resolve_cache_lock held
+CopyResolver::CopyDirIndex& CopyResolver::get_dir_index(const std::string& copy_dir)
+{
+	CopyDirIndex& idx = dir_index[copy_dir];
+	if (idx.verified)
+		return idx;
+
+	// a single stat for the whole directory: its modification time changes when files are added, removed or renamed
+	std::error_code ec;
+	int64_t mtime = std::filesystem::last_write_time(copy_dir, ec).time_since_epoch().count();
+	if (ec) {
+		idx.files.clear();
+		idx.mtime = 0;
+		idx.verified = true;
+		return idx;
+	}
+
+	if (idx.mtime != mtime) {
+		idx.files.clear();
+		for (const auto& entry : std::filesystem::directory_iterator(copy_dir, ec)) {
+			std::error_code ec2;
+			if (entry.is_regular_file(ec2)) {
+				std::string f = entry.path().filename().string();
+				idx.files[get_index_key(f)] = f;
+			}
+		}
+		idx.mtime = mtime;
+		index_changed = true;
+	}
+
+	idx.verified = true;
+	return idx;
+}
+
+std::string CopyResolver::get_index_key(const std::string& f)
+{
+	return case_insensitive ? to_lower(f) : f;
+}
+
+void CopyResolver::setUseIndex(bool b)
+{
+	use_index = b;
+}
+
+void CopyResolver::setCaseInsensitive(bool b)
+{
+	std::unique_lock<std::shared_mutex> lock(resolve_cache_lock);
+
+	if (case_insensitive == b)
+		return;
+
+	case_insensitive = b;
+
+	// keys must be rebuilt
+	for (auto& di : dir_index) {
+		std::unordered_map<std::string, std::string> files;
+		for (const auto& f : di.second.files)
+			files[get_index_key(f.second)] = f.second;
+
+		di.second.files = files;
+	}
+}
+
+void CopyResolver::revalidate()
+{
+	std::unique_lock<std::shared_mutex> lock(resolve_cache_lock);
+
+	resolve_cache.clear();
+	for (auto& di : dir_index)
+		di.second.verified = false;
+}
+
+// Index file format: a header line, then for each directory a "D<tab>mtime<tab>path" line followed by a "F<tab>name" line for each file
+bool CopyResolver::loadIndex(const std::string& index_file)
+{
+	std::ifstream ifs(index_file);
+	if (!ifs.is_open())
+		return false;
+
+	std::string line;
+	if (!std::getline(ifs, line) || line != COPY_INDEX_HEADER)
+		return false;
+
+	std::unique_lock<std::shared_mutex> lock(resolve_cache_lock);
+
+	CopyDirIndex* cur = nullptr;
+	while (std::getline(ifs, line)) {
+		if (starts_with(line, "D\t")) {
+			size_t p = line.find('\t', 2);
+			if (p == std::string::npos)
+				return false;
+
+			cur = &dir_index[line.substr(p + 1)];
+			cur->mtime = strtoll(line.substr(2, p - 2).c_str(), nullptr, 10);
+			cur->verified = false;
+			cur->files.clear();
+		}
+		else {
+			if (starts_with(line, "F\t") && cur) {
+				std::string f = line.substr(2);
+				cur->files[get_index_key(f)] = f;
+			}
+		}
+	}
+
+	return true;
+}
+
+bool CopyResolver::saveIndex(const std::string& index_file)
+{
+	std::shared_lock<std::shared_mutex> lock(resolve_cache_lock);
+
+	if (!index_changed && file_exists(index_file))
+		return true;
+
+	std::ofstream ofs(index_file);
+	if (!ofs.is_open())
+		return false;
+
+	ofs << COPY_INDEX_HEADER << "\n";
+	for (const auto& di : dir_index) {
+		// missing directories are not saved
+		if (di.second.mtime == 0)
+			continue;
+
+		ofs << "D\t" << di.second.mtime << "\t" << di.first << "\n";
+		for (const auto& f : di.second.files)
+			ofs << "F\t" << f.second << "\n";
+	}
+
+	return ofs.good();
+}
@@ -23,6 +23,8 @@ USA.
 #include <string>
 #include <vector>
 #include <map>
+#include <unordered_map>
+#include <shared_mutex>
 
 //#include "libgixutils_global.h"
 
@@ -44,7 +46,24 @@ public:
 	bool resolveCopyFile(const std::string copy_name, std::string &copy_file);
 	void setVerbose(bool b);
 
+	// Copy directories are scanned once and names are resolved through an in-memory index, 
+	// the index can be persisted (with the directories' modification times) and reused by later runs
+	void setUseIndex(bool b);
+	void setCaseInsensitive(bool b);
+	bool loadIndex(const std::string& index_file);
+	bool saveIndex(const std::string& index_file);
+
+	// For long-lived resolvers (gixpp --server): forgets the resolved names and checks 
+	// again the modification time of each directory on its next use
+	void revalidate();
+
 private:
+	struct CopyDirIndex {
+		int64_t mtime = 0;
+		bool verified = false;
+		std::unordered_map<std::string, std::string> files;	// (lowercase if case-insensitive) name -> actual file name
+	};
+
 	std::vector<std::string> copy_dirs;
 	std::vector<std::string> copy_exts;
 	std::string base_dir;
@@ -52,8 +71,22 @@ private:
 
 	bool verbose = false;
 
+	bool use_index = true;
+#if defined(_WIN32)
+	bool case_insensitive = true;
+#else
+	bool case_insensitive = false;
+#endif
+	bool index_changed = false;
+	std::map<std::string, CopyDirIndex> dir_index;
+
+	// the resolver can be shared by several threads once it has been set up
 	std::map<std::string, std::string> resolve_cache;
+	std::shared_mutex resolve_cache_lock;
 
 	bool resolve_from_dir(const std::string& copy_dir, const std::string& copy_name, std::string& copy_file);
+	bool resolve_from_index(const std::string& copy_dir, const std::string& copy_name, std::string& copy_file);
+	CopyDirIndex& get_dir_index(const std::string& copy_dir);
+	std::string get_index_key(const std::string& f);
 };
 
@@ -0,0 +1,137 @@
+/*
+This file is part of Gix-IDE, an IDE and platform for GnuCOBOL
+Copyright (C) 2021 Marco Ridoni
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+USA.
+*/
+
+#include "SourceFileCache.h"
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <mutex>
+
+static int64_t get_file_mtime(const std::string& filename)
+{
+	std::error_code ec;
+	auto t = std::filesystem::last_write_time(filename, ec);
+	return ec ? 0 : t.time_since_epoch().count();
+}
+
+std::shared_ptr<const std::string> SourceFileCache::getContent(const std::string& filename)
+{
+	std::string key = get_key(filename);
+
+	{
+		std::shared_lock<std::shared_mutex> lock(files_lock);
+		auto it = files.find(key);
+		if (it != files.end() && it->second.content && it->second.generation == generation)
+			return it->second.content;
+	}
+
+	int64_t mtime = get_file_mtime(filename);
+
+	{
+		// cached before the last call to revalidate
+		std::unique_lock<std::shared_mutex> lock(files_lock);
+		auto it = files.find(key);
+		if (it != files.end() && it->second.content) {
+			if (it->second.mtime == mtime && mtime != 0) {
+				it->second.generation = generation;
+				return it->second.content;
+			}
+			files.erase(it);
+		}
+	}
+
+	// text mode, so that lines are split as file_read_all_lines would do
+	std::ifstream ifs(filename);
+	if (!ifs.is_open())
+		return nullptr;
+
+	std::stringstream ss;
+	ss << ifs.rdbuf();
+	auto content = std::make_shared<const std::string>(ss.str());
+
+	std::unique_lock<std::shared_mutex> lock(files_lock);
+	auto& cf = files[key];
+	if (!cf.content) {
+		cf.content = content;
+		cf.mtime = mtime;
+		cf.generation = generation;
+	}
+
+	return cf.content;
+}
+
+std::shared_ptr<const std::vector<std::string>> SourceFileCache::getLines(const std::string& filename)
+{
+	std::string key = get_key(filename);
+
+	{
+		std::shared_lock<std::shared_mutex> lock(files_lock);
+		auto it = files.find(key);
+		if (it != files.end() && it->second.lines && it->second.generation == generation)
+			return it->second.lines;
+	}
+
+	auto content = getContent(filename);
+	if (!content)
+		return std::make_shared<const std::vector<std::string>>();
+
+	{
+		std::shared_lock<std::shared_mutex> lock(files_lock);
+		auto it = files.find(key);
+		if (it != files.end() && it->second.lines && it->second.content == content)
+			return it->second.lines;
+	}
+
+	auto lines = std::make_shared<std::vector<std::string>>();
+	std::istringstream iss(*content);
+	std::string line;
+	while (std::getline(iss, line)) {
+		lines->push_back(line);
+	}
+
+	std::unique_lock<std::shared_mutex> lock(files_lock);
+	auto& cf = files[key];
+	if (cf.content != content)
+		return lines;
+
+	if (!cf.lines)
+		cf.lines = lines;
+
+	return cf.lines;
+}
+
+void SourceFileCache::clear()
+{
+	std::unique_lock<std::shared_mutex> lock(files_lock);
+	files.clear();
+}
+
+void SourceFileCache::revalidate()
+{
+	std::unique_lock<std::shared_mutex> lock(files_lock);
+	generation++;
+}
+
+std::string SourceFileCache::get_key(const std::string& filename)
+{
+	// no stat calls here
+	return std::filesystem::absolute(filename).lexically_normal().generic_string();
+}
@@ -0,0 +1,58 @@
+/*
+This file is part of Gix-IDE, an IDE and platform for GnuCOBOL
+Copyright (C) 2021 Marco Ridoni
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+USA.
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <shared_mutex>
+
+// Contents of the COPY files, read once and shared by all the files being preprocessed
+class SourceFileCache
+{
+public:
+	// nullptr if the file cannot be read
+	std::shared_ptr<const std::string> getContent(const std::string& filename);
+
+	// same as file_read_all_lines (empty if the file cannot be read)
+	std::shared_ptr<const std::vector<std::string>> getLines(const std::string& filename);
+
+	void clear();
+
+	// For long-lived caches (gixpp --server): the modification time of each file 
+	// is checked again on its next use and the file is reloaded if it changed
+	void revalidate();
+
+private:
+	struct CachedFile {
+		std::shared_ptr<const std::string> content;
+		std::shared_ptr<const std::vector<std::string>> lines;
+		int64_t mtime = 0;
+		unsigned int generation = 0;
+	};
+
+	std::map<std::string, CachedFile> files;
+	std::shared_mutex files_lock;
+	unsigned int generation = 0;
+
+	std::string get_key(const std::string& filename);
+};
@@ -336,15 +336,23 @@ bool file_write_all_lines(const std::string &filename, const std::vector<std::st
 {
 	std::filesystem::path filepath(filename);
 
-	std::ofstream ofs(filepath);
-
-	for (std::string line : lines) {
-		ofs << line << std::endl;
+	// built in memory and written at once
+	size_t sz = 0;
+	for (const std::string& line : lines)
+		sz += line.size() + 1;
+
+	std::string bfr;
+	bfr.reserve(sz);
+	for (const std::string& line : lines) {
+		bfr += line;
+		bfr += '\n';
 	}
 
+	std::ofstream ofs(filepath);
+	ofs.write(bfr.data(), bfr.size());
 	ofs.close();
 
-	return true;
+	return !ofs.fail();
 }
 
 bool file_exists(const std::string &filename)
@@ -390,7 +398,8 @@ std::string filename_absolute_path(const std::filesystem::path &filepath)
 
 std::string filename_clean_path(const std::string &filepath)
 {
-	std::string s = std::filesystem::canonical(filepath).string();
+	// the file might exist only in memory (e.g. consolidated sources)
+	std::string s = std::filesystem::weakly_canonical(filepath).string();
 	std::replace(s.begin(), s.end(), '\\', '/');
 	return s;
 }
@@ -627,6 +636,30 @@ uint8_t *file_read_all_bytes(const std::string &filename)
     return bfr;
 }
 
+// 64-bit FNV-1a hash of the file contents (not a cryptographic hash, only used to detect changes)
+bool file_get_hash(const std::string& filename, uint64_t* hash)
+{
+    FILE* fp = fopen(filename.c_str(), "rb");
+    if (!fp)
+        return false;
+
+    uint64_t h = 0xcbf29ce484222325ULL;
+    unsigned char bfr[65536];
+    size_t nread;
+    while ((nread = fread(bfr, 1, sizeof(bfr), fp)) > 0) {
+        for (size_t i = 0; i < nread; i++) {
+            h ^= bfr[i];
+            h *= 0x100000001b3ULL;
+        }
+    }
+
+    bool ok = !ferror(fp);
+    fclose(fp);
+
+    *hash = h;
+    return ok;
+}
+
 byte_array::byte_array()
 {
     bfr = nullptr;
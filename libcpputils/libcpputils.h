@@ -116,6 +116,7 @@ bool ends_with(std::string const& s1, std::string const& s2);
 std::vector<std::string> file_read_all_lines(const std::string& filename);
 bool file_write_all_lines(const std::string& filename, const std::vector<std::string>& lines);
 uint8_t *file_read_all_bytes(const std::string& filename);
+bool file_get_hash(const std::string& filename, uint64_t* hash);
 bool file_exists(const std::string& filename);
 bool file_remove(const std::string& filename);
 bool dir_exists(const std::string& dir_name);
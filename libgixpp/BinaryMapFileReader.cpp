@@ -0,0 +1,267 @@
+/*
+This file is part of Gix-IDE, an IDE and platform for GnuCOBOL
+Copyright (C) 2021 Marco Ridoni
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+USA.
+*/
+
+#include "BinaryMapFileReader.h"
+
+#include <cstring>
+#include <algorithm>
+
+#if defined(_WIN32)
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+BinaryMapFileReader::BinaryMapFileReader()
+{
+}
+
+BinaryMapFileReader::~BinaryMapFileReader()
+{
+	close();
+}
+
+bool BinaryMapFileReader::open(const std::string& filename)
+{
+	close();
+
+#if defined(_WIN32)
+	HANDLE fh = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (fh == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER fsize;
+	if (!GetFileSizeEx(fh, &fsize) || fsize.QuadPart < sizeof(BinaryMapFileHeader)) {
+		CloseHandle(fh);
+		return false;
+	}
+
+	HANDLE mh = CreateFileMappingA(fh, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (!mh) {
+		CloseHandle(fh);
+		return false;
+	}
+
+	void* p = MapViewOfFile(mh, FILE_MAP_READ, 0, 0, 0);
+	if (!p) {
+		CloseHandle(mh);
+		CloseHandle(fh);
+		return false;
+	}
+
+	file_handle = fh;
+	mapping_handle = mh;
+	data = (const char*)p;
+	size = fsize.QuadPart;
+#else
+	int f = ::open(filename.c_str(), O_RDONLY);
+	if (f < 0)
+		return false;
+
+	struct stat st;
+	if (fstat(f, &st) != 0 || st.st_size < (off_t)sizeof(BinaryMapFileHeader)) {
+		::close(f);
+		return false;
+	}
+
+	void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, f, 0);
+	if (p == MAP_FAILED) {
+		::close(f);
+		return false;
+	}
+
+	fd = f;
+	data = (const char*)p;
+	size = st.st_size;
+#endif
+
+	const BinaryMapFileHeader* h = header();
+	if (memcmp(h->magic, BINARY_MAP_FILE_MAGIC, sizeof(BINARY_MAP_FILE_MAGIC)) != 0 || h->version != BINARY_MAP_FILE_VERSION || h->byte_order != BINARY_MAP_FILE_BYTE_ORDER ||
+		!check_section(h->strings, 1) || !check_section(h->files, sizeof(BinaryMapFileFileRecord)) || !check_section(h->in_to_out, sizeof(BinaryMapFileLineRecord)) ||
+		!check_section(h->out_to_in, sizeof(BinaryMapFileLineRecord)) || !check_section(h->fields, sizeof(BinaryMapFileFieldRecord)) ||
+		(h->strings.count > 0 && data[h->strings.offset + h->strings.count - 1] != 0)) {
+		close();
+		return false;
+	}
+
+	return true;
+}
+
+void BinaryMapFileReader::close()
+{
+	if (!data)
+		return;
+
+#if defined(_WIN32)
+	UnmapViewOfFile(data);
+	CloseHandle((HANDLE)mapping_handle);
+	CloseHandle((HANDLE)file_handle);
+	mapping_handle = nullptr;
+	file_handle = nullptr;
+#else
+	munmap((void*)data, size);
+	::close(fd);
+	fd = -1;
+#endif
+
+	data = nullptr;
+	size = 0;
+}
+
+const BinaryMapFileHeader* BinaryMapFileReader::header() const
+{
+	return (const BinaryMapFileHeader*)data;
+}
+
+bool BinaryMapFileReader::check_section(const BinaryMapFileSection& s, uint64_t record_size) const
+{
+	if (s.count == 0)
+		return true;
+
+	// records are accessed in place, so they must be aligned
+	if (s.offset % (record_size >= 8 ? 8 : record_size >= 4 ? 4 : 1))
+		return false;
+
+	return s.offset >= sizeof(BinaryMapFileHeader) && s.offset <= size && s.count <= (size - s.offset) / record_size;
+}
+
+uint32_t BinaryMapFileReader::getFlags() const
+{
+	return data ? header()->flags : 0;
+}
+
+std::string BinaryMapFileReader::getInputFile() const
+{
+	return data ? getString(header()->input_file) : "";
+}
+
+std::string BinaryMapFileReader::getOutputFile() const
+{
+	return data ? getString(header()->output_file) : "";
+}
+
+int BinaryMapFileReader::getInputFileId() const
+{
+	return data ? header()->input_file_id : 0;
+}
+
+int BinaryMapFileReader::getOutputFileId() const
+{
+	return data ? header()->output_file_id : 0;
+}
+
+const char* BinaryMapFileReader::getString(uint32_t offset) const
+{
+	if (!data || offset >= header()->strings.count)
+		return "";
+
+	return data + header()->strings.offset + offset;
+}
+
+const BinaryMapFileFileRecord* BinaryMapFileReader::getFiles(uint64_t* count) const
+{
+	*count = data ? header()->files.count : 0;
+	return data ? (const BinaryMapFileFileRecord*)(data + header()->files.offset) : nullptr;
+}
+
+const BinaryMapFileLineRecord* BinaryMapFileReader::getInToOutMap(uint64_t* count) const
+{
+	*count = data ? header()->in_to_out.count : 0;
+	return data ? (const BinaryMapFileLineRecord*)(data + header()->in_to_out.offset) : nullptr;
+}
+
+const BinaryMapFileLineRecord* BinaryMapFileReader::getOutToInMap(uint64_t* count) const
+{
+	*count = data ? header()->out_to_in.count : 0;
+	return data ? (const BinaryMapFileLineRecord*)(data + header()->out_to_in.offset) : nullptr;
+}
+
+const BinaryMapFileFieldRecord* BinaryMapFileReader::getFields(uint64_t* count) const
+{
+	*count = data ? header()->fields.count : 0;
+	return data ? (const BinaryMapFileFieldRecord*)(data + header()->fields.offset) : nullptr;
+}
+
+std::string BinaryMapFileReader::getFileName(int file_id) const
+{
+	uint64_t n;
+	const BinaryMapFileFileRecord* files = getFiles(&n);
+	auto it = std::lower_bound(files, files + n, (uint32_t)file_id, [](const BinaryMapFileFileRecord& r, uint32_t id) { return r.id < id; });
+	if (it == files + n || it->id != (uint32_t)file_id)
+		return std::string();
+
+	return getString(it->name);
+}
+
+int BinaryMapFileReader::getFileId(const std::string& filename) const
+{
+	uint64_t n;
+	const BinaryMapFileFileRecord* files = getFiles(&n);
+	for (uint64_t i = 0; i < n; i++) {
+		if (filename == getString(files[i].name))
+			return files[i].id;
+	}
+	return 0;
+}
+
+bool BinaryMapFileReader::map_location(const BinaryMapFileSection& s, int file_id, int line, int* to_file_id, int* to_line) const
+{
+	if (!data)
+		return false;
+
+	const BinaryMapFileLineRecord* recs = (const BinaryMapFileLineRecord*)(data + s.offset);
+	uint64_t k = MAP_FILE_LOCATION(file_id, line);
+
+	auto it = std::lower_bound(recs, recs + s.count, k, [](const BinaryMapFileLineRecord& r, uint64_t k) { return r.from < k; });
+	if (it == recs + s.count || it->from != k)
+		return false;
+
+	*to_file_id = MAP_FILE_LOCATION_FILE(it->to);
+	*to_line = MAP_FILE_LOCATION_LINE(it->to);
+	return true;
+}
+
+bool BinaryMapFileReader::mapInputToOutput(int file_id, int line, int* out_file_id, int* out_line) const
+{
+	return data && map_location(header()->in_to_out, file_id, line, out_file_id, out_line);
+}
+
+bool BinaryMapFileReader::mapOutputToInput(int file_id, int line, int* in_file_id, int* in_line) const
+{
+	return data && map_location(header()->out_to_in, file_id, line, in_file_id, in_line);
+}
+
+bool BinaryMapFileReader::findField(const std::string& name, MapFileField& field) const
+{
+	uint64_t n;
+	const BinaryMapFileFieldRecord* fields = getFields(&n);
+	auto it = std::lower_bound(fields, fields + n, name, [this](const BinaryMapFileFieldRecord& r, const std::string& name) { return strcmp(getString(r.name), name.c_str()) < 0; });
+	if (it == fields + n || name != getString(it->name))
+		return false;
+
+	field.name = getString(it->name);
+	field.path = getString(it->path);
+	field.file = getString(it->file);
+	field.line = it->line;
+	return true;
+}
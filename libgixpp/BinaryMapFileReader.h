@@ -0,0 +1,72 @@
+/*
+This file is part of Gix-IDE, an IDE and platform for GnuCOBOL
+Copyright (C) 2021 Marco Ridoni
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+USA.
+*/
+
+#pragma once
+
+#include <string>
+
+#include "MapFileData.h"
+
+// Read-only access to a binary map file: the file is memory-mapped and searched in place
+class BinaryMapFileReader
+{
+public:
+	BinaryMapFileReader();
+	~BinaryMapFileReader();
+
+	bool open(const std::string& filename);
+	void close();
+
+	uint32_t getFlags() const;
+	std::string getInputFile() const;
+	std::string getOutputFile() const;
+	int getInputFileId() const;
+	int getOutputFileId() const;
+
+	std::string getFileName(int file_id) const;
+	int getFileId(const std::string& filename) const;
+
+	bool mapInputToOutput(int file_id, int line, int* out_file_id, int* out_line) const;
+	bool mapOutputToInput(int file_id, int line, int* in_file_id, int* in_line) const;
+
+	// first field with the given name
+	bool findField(const std::string& name, MapFileField& field) const;
+
+	const BinaryMapFileFileRecord* getFiles(uint64_t* count) const;
+	const BinaryMapFileLineRecord* getInToOutMap(uint64_t* count) const;
+	const BinaryMapFileLineRecord* getOutToInMap(uint64_t* count) const;
+	const BinaryMapFileFieldRecord* getFields(uint64_t* count) const;
+	const char* getString(uint32_t offset) const;
+
+private:
+	const char* data = nullptr;
+	uint64_t size = 0;
+
+#if defined(_WIN32)
+	void* file_handle = nullptr;
+	void* mapping_handle = nullptr;
+#else
+	int fd = -1;
+#endif
+
+	const BinaryMapFileHeader* header() const;
+	bool check_section(const BinaryMapFileSection& s, uint64_t record_size) const;
+	bool map_location(const BinaryMapFileSection& s, int file_id, int line, int* to_file_id, int* to_line) const;
+};
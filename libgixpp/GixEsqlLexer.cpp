@@ -24,7 +24,8 @@ USA.
 
 #include <istream>
 #include <filesystem>
-#include <regex>
+#include <algorithm>
+#include <string_view>
 
 #define YY_NULL 0
 
@@ -41,8 +42,33 @@ USA.
 #endif /* __ia64__ */
 #endif
 
-//static QRegularExpression rxUserDefinedCobolWord(R"([A-Za-z0-9]+ ([\-]+ [A-Za-z0-9]+)*)");
-static std::regex rxUserDefinedCobolWord(R"(^[A-Za-z0-9]+([\-]+[A-Za-z0-9]+)*$)");
+// Words that can appear alone (followed by a period) on a line in the PROCEDURE DIVISION 
+// and must not be taken for paragraph names (sorted, for binary search)
+static const std::string_view cobol_statement_words[] = {
+	"CONTINUE", "ELSE", "END-ACCEPT", "END-ADD", "END-CALL", "END-COMPUTE", "END-DELETE", "END-DISPLAY",
+	"END-DIVIDE", "END-EVALUATE", "END-EXEC", "END-IF", "END-MULTIPLY", "END-PERFORM", "END-READ", "END-RETURN",
+	"END-REWRITE", "END-SEARCH", "END-START", "END-STRING", "END-SUBTRACT", "END-UNSTRING", "END-WRITE", "EXIT",
+	"GOBACK"
+};
+
+static inline bool is_ascii_alnum(char c)
+{
+	return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9');
+}
+
+// Same as matching ^[A-Za-z0-9]+([\-]+[A-Za-z0-9]+)*$
+static bool is_user_defined_cobol_word(const std::string& t)
+{
+	if (t.empty() || !is_ascii_alnum(t.front()) || !is_ascii_alnum(t.back()))
+		return false;
+
+	for (char c : t) {
+		if (!is_ascii_alnum(c) && c != '-')
+			return false;
+	}
+
+	return true;
+}
 
 #if (defined(_WIN32) || defined(_WIN64)) && !defined(__MINGW32__)
 #define SYS_EOL "\r\n"
@@ -50,6 +76,8 @@ static std::regex rxUserDefinedCobolWord(R"(^[A-Za-z0-9]+([\-]+[A-Za-z0-9]+)*$)"
 #define SYS_EOL "\n"
 #endif
 
+#define SYS_EOL_LEN (sizeof(SYS_EOL) - 1)
+
 int GixEsqlLexer::LexerInput(char* buff, int max_size)
 {
 	char* bp;
@@ -57,26 +85,33 @@ int GixEsqlLexer::LexerInput(char* buff, int max_size)
 	char is_continuing = 0;
 	std::string partial_line;
 
-	memset(buff, 0, max_size);
+	// leave room for the EOL (yyin.getline discards it)
+	int max_line_size = max_size - (int)SYS_EOL_LEN;
+
+	while (yyin.getline(buff, max_line_size)) {
 
-	while (yyin.getline(buff, max_size)) {
+		lines_read++;
 
-		cur_line_content = buff;
+		size_t len = strlen(buff);
+		cur_line_content.assign(buff, len);
 
 		if (driver->preprocessor()->verbose_debug)
 			printf("%05d : %s\n", yylineno + 1, buff);
 
 		// This is needed to properly consume EOLs (yyin.getline discards them)
-		strcat(buff, SYS_EOL);
+		memcpy(buff + len, SYS_EOL, SYS_EOL_LEN + 1);
+		len += SYS_EOL_LEN;
 
-		if (strlen(buff) > 7) {
+		if (len > 7) {
 			bp = buff + 7;
 
 			switch (buff[6]) {
 			case ' ':
 			{
 				if (is_continued_line(buff, &is_continuing, partial_line)) {
-					partial_line = string_replace(partial_line, SYS_EOL, "");
+					size_t eol_pos = partial_line.find(SYS_EOL);
+					if (eol_pos != std::string::npos)
+						partial_line.erase(eol_pos, SYS_EOL_LEN);
 					continue;
 				}
 			}
@@ -88,12 +123,13 @@ int GixEsqlLexer::LexerInput(char* buff, int max_size)
 					if (!append_continuation_line(partial_line, is_continuing, buff, &is_terminal))
 						return 0;	// ERROR
 
-					//partial_line = string_replace(partial_line, SYS_EOL, "");
-
 					if (is_terminal) {
-						strcpy(buff, partial_line.c_str());
-						strcat(buff, SYS_EOL);
-						return strlen(buff);
+						if (partial_line.size() + SYS_EOL_LEN >= (size_t)max_size)
+							return 0;	// ERROR
+
+						memcpy(buff, partial_line.data(), partial_line.size());
+						memcpy(buff + partial_line.size(), SYS_EOL, SYS_EOL_LEN + 1);
+						return partial_line.size() + SYS_EOL_LEN;
 					}
 					else
 						continue;
@@ -107,57 +143,41 @@ int GixEsqlLexer::LexerInput(char* buff, int max_size)
 			case '\n':
 			case '\0':
 				/* ignore line */
-				strcpy(buff, "\n");
-				return strlen(buff);
-
 			case '*':
-				/* comment line */
-				strcpy(buff, "\n");
-				return strlen(buff);
-
 			case '/':
-				/* comment line */
-				strcpy(buff, "\n");
-				return strlen(buff);
-
 			case 'D':
-				/* comment line */
-				strcpy(buff, "\n");
-				return strlen(buff);
-
 			case 'd':
-				/* comment line */
-				strcpy(buff, "\n");
-				return strlen(buff);
-
 			case '$':
 				/* comment line */
-				strcpy(buff, "\n");
-				return strlen(buff);
-
 			case '>':
 				/* preprocessor line, treat as comment */
-				strcpy(buff, "\n");
-				return strlen(buff);
+				buff[0] = '\n';
+				buff[1] = '\0';
+				return 1;
 
 			default:
 				driver->error("Wrong file format or unexpected end of file", ERR_SYNTAX_ERROR, driver->file, yylineno + 1);
 				return YY_NULL;
 			}
-			if (strlen(buff) > 72) {
+			if (len > 72) {
 				memmove(buff, bp, 65);
-				strcpy(buff + 65, "\n");
+				buff[65] = '\n';
+				buff[66] = '\0';
+				len = 66;
 			}
 			else {
-				memmove(buff, bp, strlen(bp) + 1);
+				memmove(buff, bp, len - 7 + 1);
+				len -= 7;
 			}
 
 			comment = strstr(buff, "*>");
-			if (comment)
+			if (comment) {
 				*comment = '\0';
+				len = comment - buff;
+			}
 		}
 
-		return strlen(buff);
+		return len;
 	}
 
 	return 0;
@@ -171,13 +191,13 @@ void GixEsqlLexer::pushNewFile(const std::string file_name, gix_esql_driver* dri
 		printf("Resolving %s\n", file_name.c_str());
 
 	if (resolve_as_copy) {
-		if (!driver->preprocessor()->getCopyResolver()->resolveCopyFile(file_name, file_full_name)) {
+		if (!driver->preprocessor()->resolveCopyFile(file_name, file_full_name)) {
 			driver->error("Cannot resolve copy file " + file_name, ERR_MISSING_COPYFILE);
 			return;
 		}
 	}
 
-	std::istream* in_file = new std::ifstream(file_full_name);
+	std::istream* in_file = driver->preprocessor()->openFile(file_full_name, resolve_as_copy);
 	yy_buffer_state* new_buffer = yy_create_buffer(in_file, YY_BUF_SIZE);
 
 	if (driver->preprocessor()->verbose_debug)
@@ -198,6 +218,13 @@ void GixEsqlLexer::pushNewFile(const std::string file_name, gix_esql_driver* dri
 	yylineno = 1;
 }
 
+void GixEsqlLexer::setReservedWordsList(const std::vector<std::string>& rwl)
+{
+	reserved_words.clear();
+	for (const auto& rw : rwl)
+		reserved_words.insert(to_upper(rw));
+}
+
 bool GixEsqlLexer::isParagraph(const std::string& text)
 {
 	if (!driver->procedure_division_started)
@@ -205,8 +232,14 @@ bool GixEsqlLexer::isParagraph(const std::string& text)
 
 	std::string t = trim_copy(string_chop(trim_copy(text), 1));
 
-	bool b = std::regex_match(t, rxUserDefinedCobolWord) && std::find(reserved_words_list.begin(), reserved_words_list.end(), t) == reserved_words_list.end();
-	return b;
+	if (!is_user_defined_cobol_word(t))
+		return false;
+
+	std::string ut = to_upper(t);
+	if (std::binary_search(std::begin(cobol_statement_words), std::end(cobol_statement_words), std::string_view(ut)))
+		return false;
+
+	return reserved_words.find(ut) == reserved_words.end();
 }
 
 
@@ -34,6 +34,8 @@ USA.
 #include <stack>
 #include <map>
 #include <string>
+#include <vector>
+#include <unordered_set>
 
 #include "gix_esql_parser.hh"
 
@@ -66,7 +68,7 @@ public:
 		driver = _driver;
 	}
 
-	void setReservedWordsList(const std::vector<std::string>& rwl) { reserved_words_list = rwl; }
+	void setReservedWordsList(const std::vector<std::string>& rwl);
 
 
 	int LexerInput(char* buf, int max_size);
@@ -81,18 +83,32 @@ public:
 
 	std::string cur_line_content;
 
+	// Scanner state is kept in the instance, so that several files can be processed concurrently
+	// (each one with its own driver/lexer)
+
+	// The location of the current token.
+	yy::location loc;
+
+	int subquery_level = 0;
+
+	// source lines read (including copy files)
+	uint64_t lines_read = 0;
+	std::vector<std::string> cur_token_list;
 
 
 
 private:
 	bool isParagraph(const std::string& text);
 
-	std::vector<std::string> reserved_words_list;
+	// additional reserved words (uppercase)
+	std::unordered_set<std::string> reserved_words;
 
 	bool is_current_cmd_dml();
 	bool is_current_cmd_select();
 	bool is_current_cmd_passthru();
 
+	yy::gix_esql_parser::symbol_type __MAKE_TOKEN(char* s, yy::location loc);
+
 	bool is_continued_line(char* buff, char* quote_char, std::string& pline);
 	bool append_continuation_line(std::string& string, char quote_char, char* buff, bool* is_terminal);
 
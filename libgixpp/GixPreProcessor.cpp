@@ -21,7 +21,20 @@ USA.
 #include "GixPreProcessor.h"
 
 #include <string>
-
+#include <typeinfo>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <time.h>
+#include <sys/resource.h>
+#endif
+
+#include "libgixpp.h"
 #include "FileData.h"
 #include "libcpputils.h"
 #include "TPESQLParser.h"
@@ -29,9 +42,12 @@ USA.
 
 #define SET_PP_ERR(I,S) err_data.err_code = I; err_data.err_messages.push_back(S)
 
+#define CACHE_RECORD_HEADER	"gixpp-cache 1"
+#define CACHE_RECORD_EXT	".gixpp-cache"
+
 GixPreProcessor::GixPreProcessor()
 {
-	check_update_status = true;
+	check_update_status = false;
 	keep_temp_files = false;
 	verbose = false;
 	verbose_debug = false;
@@ -64,6 +80,45 @@ CopyResolver *GixPreProcessor::getCopyResolver() const
 	return copy_resolver;
 }
 
+bool GixPreProcessor::resolveCopyFile(const std::string& copy_name, std::string& copy_file)
+{
+	std::unique_ptr<PhaseTimer> t;
+	if (collect_timings)
+		t = std::make_unique<PhaseTimer>(this, "copy resolution", true);
+
+	bool b = copy_resolver->resolveCopyFile(copy_name, copy_file);
+	dependencies[copy_name] = b ? copy_file : std::string();
+
+	if (b && collect_timings)
+		addCounter("copy_files_resolved");
+
+	return b;
+}
+
+void GixPreProcessor::setSourceFileCache(SourceFileCache* c)
+{
+	source_file_cache = c;
+}
+
+std::shared_ptr<const std::vector<std::string>> GixPreProcessor::readFileLines(const std::string& filename, bool is_copy)
+{
+	if (is_copy && source_file_cache)
+		return source_file_cache->getLines(filename);
+
+	return std::make_shared<const std::vector<std::string>>(file_read_all_lines(filename));
+}
+
+std::istream* GixPreProcessor::openFile(const std::string& filename, bool is_copy)
+{
+	if (is_copy && source_file_cache) {
+		auto content = source_file_cache->getContent(filename);
+		if (content)
+			return new std::istringstream(*content);
+	}
+
+	return new std::ifstream(filename);
+}
+
 //void GixPreProcessor::setCopyDirs(const std::stringList cdl)
 //{
 //	copy_dirs = cdl;
@@ -140,8 +195,33 @@ bool GixPreProcessor::process()
 		}
 	}
 
+	bool use_cache = check_update_status && !std::get<bool>(getOpt("no_output", false));
+	if (use_cache) {
+		if (is_up_to_date()) {
+			if (verbose)
+				printf("ESQL: Output file is up to date, skipping\n");
+
+			return true;
+		}
+
+		// the record is rewritten only if processing succeeds
+		std::string cache_file = get_cache_file();
+		if (file_exists(cache_file))
+			file_remove(cache_file);
+	}
+
 	bool b = this->transform();
 
+	std::string depfile = std::get<std::string>(getOpt("depfile", std::string()));
+	if (b && !depfile.empty() && !std::get<bool>(getOpt("no_output", false)) && !write_dep_file(depfile)) {
+		SET_PP_ERR(3, "Cannot write dependency file " + depfile);
+		return false;
+	}
+
+	// a failure here is not an error, the file will just be processed again next time
+	if (b && use_cache && !write_cache_record() && verbose)
+		printf("ESQL: Cannot write cache record %s\n", get_cache_file().c_str());
+
 	return b;
 }
 
@@ -153,7 +233,16 @@ bool GixPreProcessor::transform()
 		if (step != steps.at(0))
 			step->setInput(prev_step->getOutput());
 
-		if (!step->run(prev_step)) {
+		bool b;
+		{
+			std::unique_ptr<PhaseTimer> t;
+			if (collect_timings)
+				t = std::make_unique<PhaseTimer>(this, step->getName());
+
+			b = step->run(prev_step);
+		}
+
+		if (!b) {
 			return false;
 		}
 		
@@ -244,3 +333,340 @@ std::string GixPreProcessor::getTempPath()
 {
 	return temp_file_path;
 }
+
+static std::string hash_to_string(uint64_t h)
+{
+	return string_format("%016llx", (unsigned long long) h);
+}
+
+static std::string get_file_hash(const std::string& f)
+{
+	uint64_t h;
+	return file_get_hash(f, &h) ? hash_to_string(h) : std::string();
+}
+
+std::string GixPreProcessor::get_cache_file()
+{
+	return _outfile + CACHE_RECORD_EXT;
+}
+
+std::string GixPreProcessor::get_options_hash()
+{
+	std::string s = std::string(LIBGIXPP_VER) + "\n";
+
+	for (auto it = opts.begin(); it != opts.end(); ++it)
+		s += it->first + "=" + variant_to_string(it->second) + "\n";
+
+	for (auto step : steps)
+		s += std::string("step=") + typeid(*step).name() + "\n";
+
+	for (std::string cd : copy_resolver->getCopyDirs())
+		s += "copy_dir=" + cd + "\n";
+
+	for (std::string ce : copy_resolver->getExtensions())
+		s += "copy_ext=" + ce + "\n";
+
+	// 64-bit FNV-1a, same as file_get_hash
+	uint64_t h = 0xcbf29ce484222325ULL;
+	for (unsigned char c : s) {
+		h ^= c;
+		h *= 0x100000001b3ULL;
+	}
+
+	return hash_to_string(h);
+}
+
+std::vector<std::string> GixPreProcessor::get_output_files()
+{
+	std::vector<std::string> res = { _outfile };
+	if (std::get<bool>(getOpt("emit_map_file", false)))
+		res.push_back(filename_change_ext(_outfile, ".cbsql.map"));
+
+	std::string depfile = std::get<std::string>(getOpt("depfile", std::string()));
+	if (!depfile.empty())
+		res.push_back(depfile);
+
+	return res;
+}
+
+// The cache record is a text file (one item per line, tab-separated fields):
+//   options <hash>
+//   input <hash> <file>
+//   output <hash> <file>
+//   copy <hash> <copy name> <file>		(hash is "-" if the copy file could not be resolved)
+bool GixPreProcessor::is_up_to_date()
+{
+	std::vector<std::string> lines = file_read_all_lines(get_cache_file());
+	if (lines.size() < 4 || lines.at(0) != CACHE_RECORD_HEADER)
+		return false;
+
+	int n_outputs = 0;
+	bool has_input = false, has_options = false;
+
+	for (int i = 1; i < lines.size(); i++) {
+		std::vector<std::string> items = string_split(lines.at(i), "\t");
+		if (items.size() < 2)
+			return false;
+
+		std::string kind = items.at(0);
+		std::string hash = items.at(1);
+
+		if (kind == "options") {
+			if (hash != get_options_hash())
+				return false;
+
+			has_options = true;
+		}
+		else if (kind == "input" || kind == "output") {
+			if (items.size() != 3 || hash != get_file_hash(items.at(2)))
+				return false;
+
+			if (kind == "input") {
+				if (items.at(2) != _infile)
+					return false;
+
+				has_input = true;
+			}
+			else
+				n_outputs++;
+		}
+		else if (kind == "copy") {
+			// the copy must still resolve to the same file (a new file in the search path might now take precedence)
+			if (items.size() < 3)
+				return false;
+
+			std::string copy_file;
+			bool resolved = copy_resolver->resolveCopyFile(items.at(2), copy_file);
+			if (hash == "-") {
+				if (resolved)
+					return false;
+			}
+			else {
+				if (!resolved || items.size() != 4 || copy_file != items.at(3) || hash != get_file_hash(copy_file))
+					return false;
+			}
+		}
+		else
+			return false;
+	}
+
+	return has_options && has_input && n_outputs == get_output_files().size();
+}
+
+bool GixPreProcessor::write_cache_record()
+{
+	std::vector<std::string> lines;
+
+	lines.push_back(CACHE_RECORD_HEADER);
+	lines.push_back("options\t" + get_options_hash());
+
+	std::string h = get_file_hash(_infile);
+	if (h.empty())
+		return false;
+
+	lines.push_back("input\t" + h + "\t" + _infile);
+
+	for (auto f : get_output_files()) {
+		h = get_file_hash(f);
+		if (h.empty())
+			return false;
+
+		lines.push_back("output\t" + h + "\t" + f);
+	}
+
+	for (auto it = dependencies.begin(); it != dependencies.end(); ++it) {
+		if (it->second.empty()) {
+			lines.push_back("copy\t-\t" + it->first);
+			continue;
+		}
+
+		h = get_file_hash(it->second);
+		if (h.empty())
+			return false;
+
+		lines.push_back("copy\t" + h + "\t" + it->first + "\t" + it->second);
+	}
+
+	return file_write_all_lines(get_cache_file(), lines);
+}
+
+static std::string escape_dep_file_name(const std::string& f)
+{
+	std::string res;
+	for (char c : f) {
+		switch (c) {
+			case ' ':
+			case '#':
+				res += '\\';
+				break;
+
+			case '$':
+				res += '$';
+				break;
+		}
+		res += c;
+	}
+	return res;
+}
+
+// Writes a make/ninja compatible dependency file: the output file depends on the input file and on every copy file that was resolved
+bool GixPreProcessor::write_dep_file(const std::string& depfile)
+{
+	std::vector<std::string> deps = { _infile };
+	for (auto it = dependencies.begin(); it != dependencies.end(); ++it) {
+		if (!it->second.empty() && !vector_contains<std::string>(deps, it->second))
+			deps.push_back(it->second);
+	}
+
+	std::vector<std::string> lines;
+	lines.push_back(escape_dep_file_name(_outfile) + ":");
+	for (auto d : deps) {
+		lines.back() += " \\";
+		lines.push_back("  " + escape_dep_file_name(d));
+	}
+
+	return file_write_all_lines(depfile, lines);
+}
+
+void GixPreProcessor::addPhaseTiming(const std::string& name, double wall_time, double cpu_time, bool accumulate)
+{
+	if (accumulate) {
+		for (auto& t : timings) {
+			if (t.name == name) {
+				t.wall_time += wall_time;
+				t.cpu_time += cpu_time;
+				t.peak_rss = PhaseTimer::getPeakRss();
+				return;
+			}
+		}
+	}
+
+	PhaseTiming t;
+	t.name = name;
+	t.wall_time = wall_time;
+	t.cpu_time = cpu_time;
+	t.peak_rss = PhaseTimer::getPeakRss();
+	timings.push_back(t);
+}
+
+void GixPreProcessor::addCounter(const std::string& name, uint64_t n)
+{
+	counters[name] += n;
+}
+
+static std::string json_escape(const std::string& s)
+{
+	std::string res;
+	for (char c : s) {
+		switch (c) {
+			case '"': res += "\\\""; break;
+			case '\\': res += "\\\\"; break;
+			case '\n': res += "\\n"; break;
+			case '\r': res += "\\r"; break;
+			case '\t': res += "\\t"; break;
+			default:
+				if ((unsigned char)c < 0x20)
+					res += string_format("\\u%04x", (int)c);
+				else
+					res += c;
+		}
+	}
+	return res;
+}
+
+std::string GixPreProcessor::getTimingsReport(bool json)
+{
+	std::string s;
+
+	if (json) {
+		// a single line (JSON Lines), so that reports for several files can be concatenated
+		s = "{\"file\":\"" + json_escape(_infile) + "\",\"phases\":[";
+		for (int i = 0; i < timings.size(); i++) {
+			const PhaseTiming& t = timings.at(i);
+			s += string_format("%s{\"name\":\"%s\",\"wall_ms\":%.3f,\"cpu_ms\":%.3f,\"peak_rss_kb\":%llu}",
+				i ? "," : "", json_escape(t.name), t.wall_time, t.cpu_time, (unsigned long long)t.peak_rss);
+		}
+		s += "],\"counters\":{";
+		for (auto it = counters.begin(); it != counters.end(); ++it) {
+			s += string_format("%s\"%s\":%llu", it != counters.begin() ? "," : "", json_escape(it->first), (unsigned long long)it->second);
+		}
+		s += "}}";
+	}
+	else {
+		s = "Timings for " + _infile + ":\n";
+		for (const auto& t : timings) {
+			s += string_format("  %-20s wall: %10.3f ms  cpu: %10.3f ms  peak RSS: %8llu KB\n",
+				t.name, t.wall_time, t.cpu_time, (unsigned long long)t.peak_rss);
+		}
+		for (auto it = counters.begin(); it != counters.end(); ++it) {
+			s += string_format("  %-20s %llu\n", it->first, (unsigned long long)it->second);
+		}
+		if (!s.empty() && s.back() == '\n')
+			s.pop_back();
+	}
+
+	return s;
+}
+
+PhaseTimer::PhaseTimer(GixPreProcessor* gp, const std::string& _name, bool _accumulate)
+{
+	owner = gp;
+	name = _name;
+	accumulate = _accumulate;
+	wall_start = getWallTime();
+	cpu_start = getThreadCpuTime();
+}
+
+PhaseTimer::~PhaseTimer()
+{
+	owner->addPhaseTiming(name, getWallTime() - wall_start, getThreadCpuTime() - cpu_start, accumulate);
+}
+
+double PhaseTimer::getWallTime()
+{
+	auto now = std::chrono::steady_clock::now().time_since_epoch();
+	return std::chrono::duration<double, std::milli>(now).count();
+}
+
+double PhaseTimer::getThreadCpuTime()
+{
+#if defined(_WIN32)
+	FILETIME ct, et, kt, ut;
+	if (!GetThreadTimes(GetCurrentThread(), &ct, &et, &kt, &ut))
+		return 0;
+
+	ULARGE_INTEGER k, u;
+	k.LowPart = kt.dwLowDateTime;
+	k.HighPart = kt.dwHighDateTime;
+	u.LowPart = ut.dwLowDateTime;
+	u.HighPart = ut.dwHighDateTime;
+	return (k.QuadPart + u.QuadPart) / 10000.0;	// 100ns units
+#else
+	struct timespec ts;
+	if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts))
+		return 0;
+
+	return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+#endif
+}
+
+uint64_t PhaseTimer::getPeakRss()
+{
+#if defined(_WIN32)
+	PROCESS_MEMORY_COUNTERS pmc;
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+		return 0;
+
+	return pmc.PeakWorkingSetSize / 1024;
+#else
+	struct rusage ru;
+	if (getrusage(RUSAGE_SELF, &ru))
+		return 0;
+
+#if defined(__APPLE__)
+	return ru.ru_maxrss / 1024;	// bytes
+#else
+	return ru.ru_maxrss;		// KB
+#endif
+#endif
+}
@@ -27,6 +27,7 @@ USA.
 
 #include "ITransformationStep.h"
 #include "CopyResolver.h"
+#include "SourceFileCache.h"
 #include "ErrorData.h"
 
 class FileData;
@@ -34,21 +35,41 @@ class FileData;
 using variant = std::variant<int, float, bool, std::string>;
 using variant_map = std::map<std::string, variant>;
 
+struct PhaseTiming
+{
+	std::string name;
+	double wall_time = 0;	// ms
+	double cpu_time = 0;	// ms (current thread)
+	uint64_t peak_rss = 0;	// KB (whole process)
+};
+
 class GixPreProcessor
 {
 public:
 	GixPreProcessor();
 	~GixPreProcessor();
 
+	// skip processing if the cache record shows that sources, copy files and options are unchanged
 	bool check_update_status = false;
 
 	bool keep_temp_files = false;
 	bool verbose = false;
 	bool verbose_debug = false;
 
+	// collect timing/memory data for each step and the counters below (see getTimingsReport)
+	bool collect_timings = false;
+
 	void setCopyResolver(const CopyResolver *cr);
 	CopyResolver *getCopyResolver() const;
 
+	// Resolves a copy file through the copy resolver and records it as a dependency
+	bool resolveCopyFile(const std::string& copy_name, std::string& copy_file);
+
+	// COPY file contents are read through the cache (if set), which can be shared by several preprocessor instances
+	void setSourceFileCache(SourceFileCache* c);
+	std::shared_ptr<const std::vector<std::string>> readFileLines(const std::string& filename, bool is_copy);
+	std::istream* openFile(const std::string& filename, bool is_copy);
+
 	void addCustomStep(std::shared_ptr<ITransformationStep> stp);
 
 	ErrorData err_data;
@@ -68,6 +89,10 @@ public:
 	variant getOpt(std::string id, int i);
 	void setOpt(std::string id, variant v);
 
+	void addPhaseTiming(const std::string& name, double wall_time, double cpu_time, bool accumulate = false);
+	void addCounter(const std::string& name, uint64_t n = 1);
+	std::string getTimingsReport(bool json);
+
 	std::shared_ptr<ITransformationStep> firstStep();
 	std::shared_ptr<ITransformationStep> lastStep();
 	bool isLastStep(std::shared_ptr<ITransformationStep>);
@@ -91,7 +116,39 @@ private:
 	variant_map opts;
 
 	CopyResolver *copy_resolver;
+	SourceFileCache *source_file_cache = nullptr;
+
+	std::vector<PhaseTiming> timings;
+	std::map<std::string, uint64_t> counters;
+
+	// copy name -> resolved file (empty if it could not be resolved)
+	std::map<std::string, std::string> dependencies;
 
 	bool transform();
+
+	std::string get_cache_file();
+	std::string get_options_hash();
+	std::vector<std::string> get_output_files();
+	bool is_up_to_date();
+	bool write_cache_record();
+	bool write_dep_file(const std::string& depfile);
 };
 
+// Records the wall/CPU time between construction and destruction as a phase of the preprocessor
+class PhaseTimer
+{
+public:
+	PhaseTimer(GixPreProcessor* gp, const std::string& name, bool accumulate = false);
+	~PhaseTimer();
+
+	static double getWallTime();
+	static double getThreadCpuTime();
+	static uint64_t getPeakRss();
+
+private:
+	GixPreProcessor* owner;
+	std::string name;
+	bool accumulate;
+	double wall_start = 0;
+	double cpu_start = 0;
+};
@@ -22,6 +22,7 @@ USA.
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #define SET_ERR(I,S) owner->err_data.err_code = I; owner->err_data.err_messages.push_back(S)
 
@@ -33,7 +34,9 @@ enum class TransformationStepDataType
 {
 	NotSet = 0,
 	Filename = 1,
-	ESQLParserData = 2
+	ESQLParserData = 2,
+	// source lines passed in memory to the next step, the filename only identifies them
+	LineBuffer = 3
 };
 
 class TransformationStepData {
@@ -45,6 +48,7 @@ public:
 	}
 
 	void setType(TransformationStepDataType t) { _type = t; }
+	TransformationStepDataType type() { return _type; }
 	void setFilename(const std::string& s) {
 		_filename = s;
 	}
@@ -53,12 +57,19 @@ public:
 		_parser_data = pd;
 	}
 
+	void setLineBuffer(std::shared_ptr<const std::vector<std::string>> lb) {
+		_line_buffer = lb;
+	}
+
 	bool isValid() {
 		switch (_type)
 		{
 			case TransformationStepDataType::Filename:
 				return !_filename.empty();
 
+			case TransformationStepDataType::LineBuffer:
+				return !_filename.empty() && _line_buffer.get() != nullptr;
+
 			case TransformationStepDataType::ESQLParserData:
 			default:
 				return (_parser_data.get() != nullptr);
@@ -67,11 +78,14 @@ public:
 
 	std::shared_ptr<ESQLParserData> parserData() { return  _parser_data;  }
 
+	std::shared_ptr<const std::vector<std::string>> lineBuffer() { return _line_buffer; }
+
 	std::string filename()
 	{
 		switch (_type)
 		{
 		case TransformationStepDataType::Filename:
+		case TransformationStepDataType::LineBuffer:
 			return _filename;
 			
 		default:
@@ -89,6 +103,9 @@ public:
 			case TransformationStepDataType::ESQLParserData:
 				return "(binary data)";
 
+			case TransformationStepDataType::LineBuffer:
+				return _filename + " (in memory)";
+
 			default:
 				return "N/A";
 		}
@@ -100,6 +117,7 @@ private:
 
 	std::string _filename;
 	std::shared_ptr<ESQLParserData> _parser_data;
+	std::shared_ptr<const std::vector<std::string>> _line_buffer;
 	
 };
 
@@ -113,6 +131,9 @@ public:
 	virtual TransformationStepDataType getOutputType() = 0;
 	virtual bool run(std::shared_ptr<ITransformationStep> prev_step) = 0;
 
+	// used in timing reports
+	virtual std::string getName() { return "custom step"; }
+
 	virtual TransformationStepData* getInput();
 	virtual TransformationStepData* getOutput(std::shared_ptr<ITransformationStep> me = nullptr);
 
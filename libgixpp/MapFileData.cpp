@@ -0,0 +1,300 @@
+/*
+This file is part of Gix-IDE, an IDE and platform for GnuCOBOL
+Copyright (C) 2021 Marco Ridoni
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+USA.
+*/
+
+#include "MapFileData.h"
+#include "MapFileReader.h"
+#include "MapFileWriter.h"
+#include "BinaryMapFileReader.h"
+#include "libcpputils.h"
+
+#include <cstring>
+#include <fstream>
+#include <algorithm>
+#include <unordered_map>
+
+static bool parse_line_map_entry(const std::string& s, BinaryMapFileLineRecord& r)
+{
+	int from_line, from_file, to_line, to_file;
+	if (sscanf(s.c_str(), "%d@%d:%d@%d", &from_line, &from_file, &to_line, &to_file) != 4)
+		return false;
+
+	r.from = MAP_FILE_LOCATION(from_file, from_line);
+	r.to = MAP_FILE_LOCATION(to_file, to_line);
+	return true;
+}
+
+static std::string format_line_map_entry(const BinaryMapFileLineRecord& r)
+{
+	return string_format("%d@%d:%d@%d", MAP_FILE_LOCATION_LINE(r.from), MAP_FILE_LOCATION_FILE(r.from), MAP_FILE_LOCATION_LINE(r.to), MAP_FILE_LOCATION_FILE(r.to));
+}
+
+std::vector<std::pair<std::string, std::vector<std::string>>> MapFileData::getTextSections() const
+{
+	std::vector<std::pair<std::string, std::vector<std::string>>> sections;
+
+	sections.push_back({ "map", { std::to_string(MAP_FILE_FMT_VER), std::to_string(flags), input_file, output_file, std::to_string(input_file_id), std::to_string(output_file_id) } });
+
+	std::vector<std::string> items;
+	items.reserve(files.size() + 1);
+	items.push_back(std::to_string(files.size()));
+	for (const auto& f : files)
+		items.push_back(string_format("#%d:%s", f.first, f.second));
+	sections.push_back({ "filemap", std::move(items) });
+
+	items.clear();
+	items.reserve(in_to_out.size() + 1);
+	items.push_back(std::to_string(in_to_out.size()));
+	for (const auto& r : in_to_out)
+		items.push_back(format_line_map_entry(r));
+	sections.push_back({ "in_to_out_map", std::move(items) });
+
+	items.clear();
+	items.reserve(out_to_in.size() + 1);
+	items.push_back(std::to_string(out_to_in.size()));
+	for (const auto& r : out_to_in)
+		items.push_back(format_line_map_entry(r));
+	sections.push_back({ "out_to_in_map", std::move(items) });
+
+	items.clear();
+	items.reserve(fields.size() + 1);
+	items.push_back(std::to_string(fields.size()));
+	for (const auto& f : fields)
+		items.push_back(string_format("%s/%s@%s:%d", f.name, f.path, f.file, f.line));
+	sections.push_back({ "field_map", std::move(items) });
+
+	return sections;
+}
+
+bool MapFileData::loadText(const std::string& filename)
+{
+	MapFileReader mr(filename);
+	if (!mr.read())
+		return false;
+
+	std::vector<std::string> items;
+	if (!mr.getSectionData("map", items) || items.size() < 6)
+		return false;
+
+	flags = atoi(items.at(1).c_str());
+	input_file = items.at(2);
+	output_file = items.at(3);
+	input_file_id = atoi(items.at(4).c_str());
+	output_file_id = atoi(items.at(5).c_str());
+
+	// the first item of each section is the number of entries
+	files.clear();
+	if (mr.getSectionData("filemap", items)) {
+		for (int i = 1; i < items.size(); i++) {
+			const std::string& s = items.at(i);
+			size_t p = s.find(':');
+			if (!starts_with(s, "#") || p == std::string::npos)
+				return false;
+
+			files[atoi(s.substr(1, p - 1).c_str())] = s.substr(p + 1);
+		}
+	}
+
+	in_to_out.clear();
+	if (mr.getSectionData("in_to_out_map", items)) {
+		in_to_out.resize(items.size() > 0 ? items.size() - 1 : 0);
+		for (int i = 1; i < items.size(); i++) {
+			if (!parse_line_map_entry(items.at(i), in_to_out.at(i - 1)))
+				return false;
+		}
+	}
+
+	out_to_in.clear();
+	if (mr.getSectionData("out_to_in_map", items)) {
+		out_to_in.resize(items.size() > 0 ? items.size() - 1 : 0);
+		for (int i = 1; i < items.size(); i++) {
+			if (!parse_line_map_entry(items.at(i), out_to_in.at(i - 1)))
+				return false;
+		}
+	}
+
+	// name/path@file:line
+	fields.clear();
+	if (mr.getSectionData("field_map", items)) {
+		for (int i = 1; i < items.size(); i++) {
+			const std::string& s = items.at(i);
+			size_t p1 = s.find('/');
+			size_t p2 = s.find('@', p1);
+			size_t p3 = s.rfind(':');
+			if (p1 == std::string::npos || p2 == std::string::npos || p3 == std::string::npos || p3 < p2)
+				return false;
+
+			MapFileField f;
+			f.name = s.substr(0, p1);
+			f.path = s.substr(p1 + 1, p2 - p1 - 1);
+			f.file = s.substr(p2 + 1, p3 - p2 - 1);
+			f.line = atoi(s.substr(p3 + 1).c_str());
+			fields.push_back(f);
+		}
+	}
+
+	return true;
+}
+
+bool MapFileData::saveText(const std::string& filename) const
+{
+	MapFileWriter mw;
+	for (auto& s : getTextSections())
+		mw.addSection(s.first, s.second);
+
+	return mw.writeToFile(filename);
+}
+
+bool MapFileData::loadBinary(const std::string& filename)
+{
+	BinaryMapFileReader r;
+	if (!r.open(filename))
+		return false;
+
+	uint64_t n;
+
+	flags = r.getFlags();
+	input_file = r.getInputFile();
+	output_file = r.getOutputFile();
+	input_file_id = r.getInputFileId();
+	output_file_id = r.getOutputFileId();
+
+	files.clear();
+	const BinaryMapFileFileRecord* fr = r.getFiles(&n);
+	for (uint64_t i = 0; i < n; i++)
+		files[fr[i].id] = r.getString(fr[i].name);
+
+	const BinaryMapFileLineRecord* lr = r.getInToOutMap(&n);
+	in_to_out.assign(lr, lr + n);
+
+	lr = r.getOutToInMap(&n);
+	out_to_in.assign(lr, lr + n);
+
+	fields.clear();
+	const BinaryMapFileFieldRecord* fdr = r.getFields(&n);
+	for (uint64_t i = 0; i < n; i++) {
+		MapFileField f;
+		f.name = r.getString(fdr[i].name);
+		f.path = r.getString(fdr[i].path);
+		f.file = r.getString(fdr[i].file);
+		f.line = fdr[i].line;
+		fields.push_back(f);
+	}
+
+	return true;
+}
+
+bool MapFileData::saveBinary(const std::string& filename) const
+{
+	std::string strings;
+	std::unordered_map<std::string, uint32_t> string_offsets;
+
+	auto add_string = [&](const std::string& s) -> uint32_t {
+		auto it = string_offsets.find(s);
+		if (it != string_offsets.end())
+			return it->second;
+
+		uint32_t offset = strings.size();
+		strings.append(s.c_str(), s.size() + 1);
+		string_offsets[s] = offset;
+		return offset;
+	};
+
+	BinaryMapFileHeader h;
+	memset(&h, 0, sizeof(h));
+	memcpy(h.magic, BINARY_MAP_FILE_MAGIC, sizeof(BINARY_MAP_FILE_MAGIC));
+	h.version = BINARY_MAP_FILE_VERSION;
+	h.byte_order = BINARY_MAP_FILE_BYTE_ORDER;
+	h.flags = flags;
+	h.input_file_id = input_file_id;
+	h.output_file_id = output_file_id;
+	h.input_file = add_string(input_file);
+	h.output_file = add_string(output_file);
+
+	std::vector<BinaryMapFileFileRecord> file_recs;
+	for (const auto& f : files)
+		file_recs.push_back({ (uint32_t)f.first, add_string(f.second) });
+
+	std::vector<BinaryMapFileLineRecord> in_to_out_recs(in_to_out);
+	std::vector<BinaryMapFileLineRecord> out_to_in_recs(out_to_in);
+	auto by_from = [](const BinaryMapFileLineRecord& a, const BinaryMapFileLineRecord& b) { return a.from < b.from; };
+	std::stable_sort(in_to_out_recs.begin(), in_to_out_recs.end(), by_from);
+	std::stable_sort(out_to_in_recs.begin(), out_to_in_recs.end(), by_from);
+
+	std::vector<const MapFileField*> sorted_fields;
+	for (const auto& f : fields)
+		sorted_fields.push_back(&f);
+	std::stable_sort(sorted_fields.begin(), sorted_fields.end(), [](const MapFileField* a, const MapFileField* b) { return a->name < b->name; });
+
+	std::vector<BinaryMapFileFieldRecord> field_recs;
+	for (const auto f : sorted_fields)
+		field_recs.push_back({ add_string(f->name), add_string(f->path), add_string(f->file), (uint32_t)f->line });
+
+	// all the records are 8-byte aligned, the string table goes at the end
+	uint64_t offset = sizeof(BinaryMapFileHeader);
+	auto place = [&offset](BinaryMapFileSection& s, uint64_t count, uint64_t record_size) {
+		s.offset = offset;
+		s.count = count;
+		offset += ((count * record_size + 7) / 8) * 8;
+	};
+
+	place(h.files, file_recs.size(), sizeof(BinaryMapFileFileRecord));
+	place(h.in_to_out, in_to_out_recs.size(), sizeof(BinaryMapFileLineRecord));
+	place(h.out_to_in, out_to_in_recs.size(), sizeof(BinaryMapFileLineRecord));
+	place(h.fields, field_recs.size(), sizeof(BinaryMapFileFieldRecord));
+	place(h.strings, strings.size(), 1);
+
+	std::ofstream ofs(filename, std::ios::binary | std::ios::trunc);
+	if (!ofs.is_open())
+		return false;
+
+	auto write_section = [&ofs](const void* d, uint64_t len) {
+		static const char pad[8] = { 0 };
+		ofs.write((const char*)d, len);
+		if (len % 8)
+			ofs.write(pad, 8 - (len % 8));
+	};
+
+	ofs.write((const char*)&h, sizeof(h));
+	write_section(file_recs.data(), file_recs.size() * sizeof(BinaryMapFileFileRecord));
+	write_section(in_to_out_recs.data(), in_to_out_recs.size() * sizeof(BinaryMapFileLineRecord));
+	write_section(out_to_in_recs.data(), out_to_in_recs.size() * sizeof(BinaryMapFileLineRecord));
+	write_section(field_recs.data(), field_recs.size() * sizeof(BinaryMapFileFieldRecord));
+	write_section(strings.data(), strings.size());
+
+	ofs.close();
+	return !ofs.fail();
+}
+
+bool MapFileData::isBinaryMapFile(const std::string& filename)
+{
+	char magic[sizeof(BINARY_MAP_FILE_MAGIC)];
+	std::ifstream ifs(filename, std::ios::binary);
+	return ifs.read(magic, sizeof(magic)) && memcmp(magic, BINARY_MAP_FILE_MAGIC, sizeof(magic)) == 0;
+}
+
+bool MapFileData::convert(const std::string& from_file, const std::string& to_file)
+{
+	MapFileData md;
+
+	if (isBinaryMapFile(from_file))
+		return md.loadBinary(from_file) && md.saveText(to_file);
+
+	return md.loadText(from_file) && md.saveBinary(to_file);
+}
@@ -0,0 +1,123 @@
+/*
+This file is part of Gix-IDE, an IDE and platform for GnuCOBOL
+Copyright (C) 2021 Marco Ridoni
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+USA.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <map>
+
+// Locations are packed as (file id << 32) + line
+#define MAP_FILE_LOCATION(f, l)		(((uint64_t)(f) << 32) + (uint32_t)(l))
+#define MAP_FILE_LOCATION_FILE(k)	((int)((k) >> 32))
+#define MAP_FILE_LOCATION_LINE(k)	((int)((k) & 0xffffffff))
+
+#define MAP_FILE_FMT_VER ((uint16_t) 0x0100)
+
+#define BINARY_MAP_FILE_MAGIC		"GIXMAPB"
+#define BINARY_MAP_FILE_VERSION		((uint32_t) 1)
+#define BINARY_MAP_FILE_BYTE_ORDER	((uint32_t) 0x01020304)
+
+// Binary map file layout: the header, then the sections it points to. Strings are stored 
+// (NUL-terminated) in the string table and referenced by their offset in it. Line map records 
+// are sorted by source location, field records by name, so that they can be searched in place.
+struct BinaryMapFileSection
+{
+	uint64_t offset;
+	uint64_t count;
+};
+
+struct BinaryMapFileHeader
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t byte_order;
+	uint32_t flags;
+	uint32_t input_file_id;
+	uint32_t output_file_id;
+	uint32_t input_file;				// string table offsets
+	uint32_t output_file;
+	uint32_t reserved;
+	BinaryMapFileSection strings;		// count = size in bytes
+	BinaryMapFileSection files;			// BinaryMapFileFileRecord
+	BinaryMapFileSection in_to_out;		// BinaryMapFileLineRecord
+	BinaryMapFileSection out_to_in;		// BinaryMapFileLineRecord
+	BinaryMapFileSection fields;		// BinaryMapFileFieldRecord
+};
+
+static_assert(sizeof(BinaryMapFileHeader) == 120, "unexpected BinaryMapFileHeader size");
+
+struct BinaryMapFileFileRecord
+{
+	uint32_t id;
+	uint32_t name;
+};
+
+struct BinaryMapFileLineRecord
+{
+	uint64_t from;
+	uint64_t to;
+};
+
+struct BinaryMapFileFieldRecord
+{
+	uint32_t name;
+	uint32_t path;
+	uint32_t file;
+	uint32_t line;
+};
+
+struct MapFileField
+{
+	std::string name;
+	std::string path;
+	std::string file;
+	int line = 0;
+};
+
+// Contents of a map file, in either form: the text one (see MapFileWriter/MapFileReader) or the binary one
+struct MapFileData
+{
+	uint32_t flags = 0;
+	std::string input_file;
+	std::string output_file;
+	int input_file_id = 0;
+	int output_file_id = 0;
+
+	std::map<int, std::string> files;
+	std::vector<BinaryMapFileLineRecord> in_to_out;
+	std::vector<BinaryMapFileLineRecord> out_to_in;
+	std::vector<MapFileField> fields;
+
+	// the sections of the text form: name, lines
+	std::vector<std::pair<std::string, std::vector<std::string>>> getTextSections() const;
+
+	bool loadText(const std::string& filename);
+	bool loadBinary(const std::string& filename);
+
+	bool saveText(const std::string& filename) const;
+	bool saveBinary(const std::string& filename) const;
+
+	static bool isBinaryMapFile(const std::string& filename);
+
+	// converts a map file to the other form
+	static bool convert(const std::string& from_file, const std::string& to_file);
+};
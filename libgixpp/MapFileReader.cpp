@@ -19,6 +19,7 @@ USA.
 */
 
 #include "MapFileReader.h"
+#include "MapFileData.h"
 #include "libcpputils.h"
 #include "linq/linq.hpp"
 
@@ -47,6 +48,19 @@ bool MapFileReader::read()
     if (!file_exists(filename))
         return false;
 
+    // binary map files are read through the same interface
+    if (MapFileData::isBinaryMapFile(filename)) {
+        MapFileData md;
+        if (!md.loadBinary(filename))
+            return false;
+
+        for (auto& sd : md.getTextSections()) {
+            sections.push_back(sd.first);
+            data[sd.first] = std::move(sd.second);
+        }
+        return true;
+    }
+
     std::vector<std::string> lines = file_read_all_lines(filename);
     if (!lines.size())
         return false;
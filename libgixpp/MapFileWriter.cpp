@@ -37,23 +37,18 @@ void MapFileWriter::setSectionContents(const std::string & section_name, const s
 
 void MapFileWriter::appendToSectionContents(const std::string & section_name, const std::vector<std::string> & more_contents)
 {
-    std::vector<std::string> cur_contents = data.find(section_name) == data.end() ? std::vector<std::string>() : data[section_name];
+    std::vector<std::string>& cur_contents = data[section_name];
     cur_contents.insert(cur_contents.end(), more_contents.begin(), more_contents.end());
-    data[section_name] = cur_contents;
 }
 
 void MapFileWriter::appendToSectionContents(const std::string & section_name, const std::string & content)
 {
-    std::vector<std::string> cur_contents = data.find(section_name) == data.end() ? std::vector<std::string>() : data[section_name];
-    cur_contents.push_back(content);
-    data[section_name] = cur_contents;
+    data[section_name].push_back(content);
 }
 
 void MapFileWriter::appendToSectionContents(const std::string &section_name, int content)
 {
-    std::vector<std::string> cur_contents = data.find(section_name) == data.end() ? std::vector<std::string>() : data[section_name];
-    cur_contents.push_back(std::to_string(content));
-    data[section_name] = cur_contents;
+    data[section_name].push_back(std::to_string(content));
 }
 
 bool MapFileWriter::writeToFile(const std::string& filename)
@@ -62,16 +57,15 @@ bool MapFileWriter::writeToFile(const std::string& filename)
 
     std::ofstream ofs(filepath);
 
-    for (std::string section_name : sections) {
-        ofs << string_format("[%s]\n", trim_copy(section_name));
-        for (std::string ln : data[section_name]) {
-            ofs << string_format("%s\n", trim_copy(ln));
+    for (const std::string& section_name : sections) {
+        ofs << "[" << trim_copy(section_name) << "]\n";
+        for (const std::string& ln : data[section_name]) {
+            ofs << trim_copy(ln) << "\n";
         }
         ofs << "\n";
     }
 
     ofs.close();
 
-
-    return true;
+    return !ofs.fail();
 }
@@ -56,6 +56,16 @@ std::string ESQLParserData::parsed_filename() const
 	return _parsed_filename;
 }
 
+std::shared_ptr<const std::vector<std::string>> ESQLParserData::parsed_lines() const
+{
+	return _parsed_lines;
+}
+
+void ESQLParserData::set_parsed_lines(std::shared_ptr<const std::vector<std::string>> lines)
+{
+	_parsed_lines = lines;
+}
+
 std::map<std::string, srcLocation>& ESQLParserData::paragraphs()
 {
 	return _paragraphs;
@@ -41,6 +41,7 @@
 #define ESQL_PREPARE					"PREPARE_STATEMENT"
 #define ESQL_EXEC_PREPARED				"EXECUTE_PREPARED"
 #define ESQL_EXEC_IMMEDIATE				"EXECUTE_IMMEDIATE"
+#define ESQL_DEALLOCATE_PREPARED		"DEALLOCATE_PREPARE"
 #define ESQL_PASSTHRU					"PASSTHRU"
 #define ESQL_WHENEVER					"WHENEVER"
 
@@ -73,6 +74,7 @@ enum class ESQL_Command
 	PrepareStatement,
 	ExecPrepared,
 	ExecImmediate,
+	DeallocatePrepared,
 	Whenever,
 
 	// Helpers
@@ -119,6 +121,7 @@ struct ESQLJobParams
 	bool opt_picx_as_varchar;
 	int opt_norec_sqlcode = 100;
 	bool opt_varying_len_sz_short = false;
+	bool opt_eager_prepare = false;
 	std::string opt_varlen_suffix_len;
 	std::string opt_varlen_suffix_data;
 };
@@ -152,6 +155,10 @@ public:
 	std::string parsed_filename() const;
 	void set_parsed_filename(const std::string& filename);
 
+	// Contents of the parsed file, if it was passed in memory by the previous step
+	std::shared_ptr<const std::vector<std::string>> parsed_lines() const;
+	void set_parsed_lines(std::shared_ptr<const std::vector<std::string>> lines);
+
 	std::map<std::string, srcLocation>& paragraphs();
 	void paragraph_add(std::string, srcLocation p);
 
@@ -176,6 +183,7 @@ private:
 	std::map<std::string, std::shared_ptr<std::vector<std::string>>> _file_deps;
 
 	std::string _parsed_filename;
+	std::shared_ptr<const std::vector<std::string>> _parsed_lines;
 
 };
 
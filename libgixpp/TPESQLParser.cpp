@@ -71,6 +71,13 @@ bool TPESQLParser::run(std::shared_ptr<ITransformationStep> prev_step)
 
 
 	int rc = main_module_driver.parse(input, _parser_data);
+
+	if (owner->collect_timings) {
+		owner->addCounter("lines_read", main_module_driver.lexer.lines_read);
+		owner->addCounter("esql_blocks", _parser_data->exec_list()->size());
+		owner->addCounter("fields", _parser_data->get_field_map().size());
+	}
+
 	if (rc == 0) {
 		output = new TransformationStepData();
 		output->setType(TransformationStepDataType::ESQLParserData);
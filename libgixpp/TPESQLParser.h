@@ -14,6 +14,7 @@ public:
 	bool run(std::shared_ptr<ITransformationStep> prev_step) override;
 	TransformationStepDataType getInputType() override;
 	TransformationStepDataType getOutputType() override;
+	std::string getName() override { return "parsing"; }
 
 	std::vector<std::shared_ptr<PreprocessedBlockInfo>>& _preprocessed_blocks() const;
 
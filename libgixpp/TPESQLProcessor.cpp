@@ -18,17 +18,20 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
 USA.
 */
 
+#include <algorithm>
+
 #include "TPESQLProcessor.h"
 #include "TPESQLCommon.h"
 #include "ESQLCall.h"
 #include "gix_esql_driver.hh"
-#include "MapFileWriter.h"
+#include "MapFileData.h"
 #include "libcpputils.h"
 #include "limits.h"
 #include "linq/linq.hpp"
 
 #include "cobol_var_types.h"
 #include "varlen_defs.h"
+#include "stmt_flags.h"
 
 #if defined(_WIN32) && defined(_DEBUG)
 #include <Windows.h>
@@ -54,7 +57,6 @@ USA.
 
 #define CBL_FIELD_FLAG_AUTOTRIM	(uint32_t)0x200
 
-#define MAP_FILE_FMT_VER ((uint16_t) 0x0100)
 #define FLAG_M_BASE					0
 
 #define ERR_NOTDEF_CONVERSION -1
@@ -74,7 +76,7 @@ USA.
 
 static bool check_sql_type_compatibility(uint64_t type_info, cb_field_ptr var);
 
-static std::map<std::string, ESQL_Command> ESQL_cmd_map{ { ESQL_CONNECT, ESQL_Command::Connect }, { ESQL_CONNECT_RESET, ESQL_Command::ConnectReset },
+static const std::map<std::string, ESQL_Command> ESQL_cmd_map{ { ESQL_CONNECT, ESQL_Command::Connect }, { ESQL_CONNECT_RESET, ESQL_Command::ConnectReset },
 												 { ESQL_DISCONNECT, ESQL_Command::Disconnect }, { ESQL_CLOSE, ESQL_Command::Close },
 												 { ESQL_COMMIT, ESQL_Command::Commit }, { ESQL_ROLLBACK, ESQL_Command::Rollback },
 												 { ESQL_FETCH, ESQL_Command::Fetch }, { ESQL_DELETE, ESQL_Command::Delete },
@@ -85,25 +87,13 @@ static std::map<std::string, ESQL_Command> ESQL_cmd_map{ { ESQL_CONNECT, ESQL_Co
 												 { ESQL_FILE_BEGIN, ESQL_Command::FileBegin }, { ESQL_FILE_END, ESQL_Command::FileEnd } ,
 												 { ESQL_PROCEDURE_DIVISION, ESQL_Command::ProcedureDivision }, { ESQL_DECLARE_TABLE, ESQL_Command::DeclareTable },
 												 { ESQL_PREPARE, ESQL_Command::PrepareStatement }, { ESQL_EXEC_PREPARED, ESQL_Command::ExecPrepared },
-												 { ESQL_EXEC_IMMEDIATE, ESQL_Command::ExecImmediate}, { ESQL_WHENEVER, ESQL_Command::Whenever}, { ESQL_DECLARE_VAR, ESQL_Command::DeclareVar },
+												 { ESQL_EXEC_IMMEDIATE, ESQL_Command::ExecImmediate}, { ESQL_DEALLOCATE_PREPARED, ESQL_Command::DeallocatePrepared }, { ESQL_WHENEVER, ESQL_Command::Whenever}, { ESQL_DECLARE_VAR, ESQL_Command::DeclareVar },
 												 { BEGIN_DECLARE_SECTION, ESQL_Command::BeginDeclareSection}, { END_DECLARE_SECTION, ESQL_Command::EndDeclareSection },
 												 { ESQL_COMMENT, ESQL_Command::Comment } , { ESQL_IGNORE, ESQL_Command::Ignore }, { ESQL_PASSTHRU, ESQL_Command::PassThru } };
 
 #define CALL_PREFIX	"GIXSQL"
 #define TAG_PREFIX	"GIXSQL"
 
-struct esql_whenever_clause_handler_t {
-	int action = WHENEVER_ACTION_CONTINUE;
-	std::string host_label;
-};
-
-static struct esql_whenever_handler_t
-{
-	esql_whenever_clause_handler_t not_found;
-	esql_whenever_clause_handler_t sqlwarning;
-	esql_whenever_clause_handler_t sqlerror;
-} esql_whenever_handler;
-
 inline std::string TPESQLProcessor::get_call_id(const std::string s)
 {
 	return CALL_PREFIX + s;
@@ -131,6 +121,7 @@ bool TPESQLProcessor::run(std::shared_ptr<ITransformationStep> prev_step)
 	parser_data->job_params()->opt_emit_cobol85 = std::get<bool>(owner->getOpt("emit_cobol85", false));
 	parser_data->job_params()->opt_picx_as_varchar = std::get<bool>(owner->getOpt("picx_as_varchar", false));
 	parser_data->job_params()->opt_varying_len_sz_short = std::get<bool>(owner->getOpt("varying_len_sz_short", false));
+	parser_data->job_params()->opt_eager_prepare = std::get<bool>(owner->getOpt("eager_prepare", false));
 
 	auto vsfxs = std::get<std::string>(owner->getOpt("varlen_suffixes", std::string()));
 	if (vsfxs.empty()) {
@@ -201,6 +192,12 @@ int TPESQLProcessor::outputESQL()
 		return -1;
 	}
 
+	out_to_in.clear();
+	in_to_out.clear();
+	map_file_ids.clear();
+	map_files.clear();
+	get_map_file_id(output_file);
+
 	input_file_stack.push(filename_clean_path(input_file));
 
 	if (!find_working_storage(&working_begin_line, &working_end_line))
@@ -241,6 +238,14 @@ int TPESQLProcessor::outputESQL()
 
 	bool b1 = parser_data->job_params()->opt_no_output ? true : file_write_all_lines(output_file, output_lines);
 	bool b2;
+
+	if (owner->collect_timings)
+		owner->addCounter("lines_written", output_lines.size());
+
+	std::unique_ptr<PhaseTimer> t;
+	if (owner->collect_timings)
+		t = std::make_unique<PhaseTimer>(owner, "map data");
+
 	if (parser_data->job_params()->opt_no_output) {
 		build_map_data();
 		b2 = true;
@@ -284,7 +289,8 @@ bool TPESQLProcessor::generate_consolidated_map()
 bool TPESQLProcessor::processNextFile()
 {
 	std::string the_file = input_file_stack.top();
-	std::vector<std::string> input_lines = file_read_all_lines(the_file);
+	auto input_lines_ptr = (!is_current_file_included() && parser_data->parsed_lines()) ? parser_data->parsed_lines() : owner->readFileLines(the_file, is_current_file_included());
+	const std::vector<std::string>& input_lines = *input_lines_ptr;
 
 #if defined(_WIN32) && defined(_DEBUG) && defined(VERBOSE)
 	char bfr[512];
@@ -315,7 +321,7 @@ bool TPESQLProcessor::processNextFile()
 		}
 
 		std::string cmdname = exec_sql_stmt->commandName;
-		ESQL_Command cmd = map_contains<std::string, ESQL_Command>(ESQL_cmd_map, cmdname) ? ESQL_cmd_map[cmdname] : ESQL_Command::Unknown;
+		ESQL_Command cmd = map_contains<std::string, ESQL_Command>(ESQL_cmd_map, cmdname) ? ESQL_cmd_map.at(cmdname) : ESQL_Command::Unknown;
 
 		switch (cmd) {
 
@@ -628,6 +634,9 @@ bool TPESQLProcessor::put_cursor_declarations()
 		}
 	}
 
+	if (parser_data->job_params()->opt_eager_prepare && !put_statement_registry())
+		return false;
+
 	put_output_line(AREA_A_CPREFIX "GIX-SKIP-CRSR-INIT.");
 
 	put_output_line(code_tag + "*");
@@ -691,13 +700,7 @@ void TPESQLProcessor::put_output_line(const std::string& line)
 
 	output_lines.push_back(line);
 
-	std::string output_id = string_format("%d@%s", output_line, output_file);
-	std::string input_id = string_format("%d@%s", current_input_line, input_file_stack.top());
-#if defined(_WIN32) && defined(_DEBUG) && defined(_DEBUG_LOG_ON)
-	OutputDebugStringA((input_id + "-> " + output_id + "\n").toLocal8Bit().constData());
-#endif
-	out_to_in[output_id] = input_id;
-	in_to_out[input_id] = output_id;
+	out_to_in.push_back(MAP_FILE_LOCATION(get_map_file_id(input_file_stack.top()), current_input_line));
 }
 
 bool TPESQLProcessor::handle_esql_stmt(const ESQL_Command cmd, const cb_exec_sql_stmt_ptr stmt, bool in_ws)
@@ -727,6 +730,10 @@ bool TPESQLProcessor::handle_esql_stmt(const ESQL_Command cmd, const cb_exec_sql
 
 		// Cursor initialization flags (if requested)
 		put_smart_cursor_init_flags();
+
+		// Static statement registration flag
+		if (parser_data->job_params()->opt_eager_prepare)
+			put_output_line(code_tag + " 01  GIXSQL-SR-F PIC X.");
 		break;
 
 	case ESQL_Command::Incfile:
@@ -736,7 +743,7 @@ bool TPESQLProcessor::handle_esql_stmt(const ESQL_Command cmd, const cb_exec_sql
 		std::string inc_copy_name = (cmd == ESQL_Command::Incfile) ? stmt->incfileName : "SQLCA";
 		if (parser_data->job_params()->opt_preprocess_copy_files) {
 			// inline file
-			if (!owner->getCopyResolver()->resolveCopyFile(inc_copy_name, copy_file)) {
+			if (!owner->resolveCopyFile(inc_copy_name, copy_file)) {
 				//owner->err_data.err_messages.push_back("Cannot resolve copybook: " + inc_copy_name);
 				raise_error("Cannot resolve copybook: " + inc_copy_name, ERR_MISSING_COPYFILE);
 				return false;
@@ -760,7 +767,7 @@ bool TPESQLProcessor::handle_esql_stmt(const ESQL_Command cmd, const cb_exec_sql
 			// but we still try to resolve the copy to gather some metadata
 			put_output_line(AREA_B_PREFIX + string_format("COPY %s.", inc_copy_name));
 
-			if (owner->getCopyResolver()->resolveCopyFile(inc_copy_name, copy_file)) {
+			if (owner->resolveCopyFile(inc_copy_name, copy_file)) {
 				add_dependency(input_file_stack.top(), copy_file);
 			}
 			else
@@ -829,8 +836,13 @@ bool TPESQLProcessor::handle_esql_stmt(const ESQL_Command cmd, const cb_exec_sql
 		if (stmt->cursorName.empty()) {
 			int res_params_count = 0;
 
+			put_statement_registry_check();
+
 			put_start_exec_sql(false);
 
+			if (!put_statement_flags(cmd, stmt))
+				return false;
+
 			if (!put_res_host_parameters(stmt, &res_params_count))
 				return false;
 
@@ -1049,6 +1061,10 @@ bool TPESQLProcessor::handle_esql_stmt(const ESQL_Command cmd, const cb_exec_sql
 	{
 		// Note: RELEASE not supported, in case check the stmt->transaction_release flag
 		put_start_exec_sql(false);
+
+		if (!put_statement_flags(cmd, stmt))
+			return false;
+
 		ESQLCall commit_call(get_call_id("Exec"), emit_static);
 		commit_call.addParameter("SQLCA", BY_REFERENCE);
 		commit_call.addParameter(parser_data.get(), stmt->connectionId);
@@ -1067,6 +1083,10 @@ bool TPESQLProcessor::handle_esql_stmt(const ESQL_Command cmd, const cb_exec_sql
 	{
 		// Note: RELEASE not supported, in case check the stmt->transaction_release flag
 		put_start_exec_sql(false);
+
+		if (!put_statement_flags(cmd, stmt))
+			return false;
+
 		ESQLCall rollback_call(get_call_id("Exec"), emit_static);
 		rollback_call.addParameter("SQLCA", BY_REFERENCE);
 		rollback_call.addParameter(parser_data.get(), stmt->connectionId);
@@ -1086,108 +1106,16 @@ bool TPESQLProcessor::handle_esql_stmt(const ESQL_Command cmd, const cb_exec_sql
 	case ESQL_Command::Delete:
 	case ESQL_Command::Insert:
 	{
-		put_start_exec_sql(false);
-
-		int sql_params_count = 0;
-
-		// Special case: we cannot use the put_host_parameters method because we need to handle group variables
-		for (cb_hostreference_ptr p : *stmt->host_list) {
-
-			std::string var_name, ind_name;
-			bool has_indicator = decode_indicator(p->hostreference.substr(1), var_name, ind_name);
-			if (!parser_data->field_exists(var_name)) {
-				raise_error("Cannot find host variable: " + p->hostreference.substr(1), ERR_MISSING_HOSTVAR, stmt->src_abs_path, p->lineno);
-				return false;
-			}
-
-			cb_field_ptr hr = parser_data->field_map(var_name);
-			bool is_varlen = parser_data->get_actual_field_data(hr, &f_type, &f_size, &f_scale);
-
-			// Support for group items used as host variables in INSERT statements
-			// They are decomposed into their sub-elements
-			if (cmd == ESQL_Command::Insert && f_type == CobolVarType::COBOL_TYPE_GROUP && !is_varlen) {
-
-				if (has_indicator) {
-					raise_error("Invalid null indicator reference: " + var_name, ERR_INVALID_NULLIND_REF, stmt->src_abs_path, p->lineno);
-					return false;
-				}
-
-				if (hr->group_levels_count != 1) {
-					raise_error("Nested levels not allowed in group variable: " + var_name, ERR_MISSING_HOSTVAR, stmt->src_abs_path, p->lineno);
-					return false;
-				}
-
-				cb_field_ptr pp = hr->children;
-				if (!pp) {
-					raise_error("Inconsistent data for group field : " + hr->sname, ERR_MISSING_HOSTVAR, stmt->src_abs_path, p->lineno);
-					return false;
-				}
-
-				while (pp) {
-
-					ESQLCall pp_call(get_call_id("SetSQLParams"), emit_static);
-					int pp_flags = (pp->usage == Usage::Binary) ? CBL_FIELD_FLAG_BINARY : CBL_FIELD_FLAG_NONE;
-
-					uint32_t _type, _precision;
-					uint16_t _scale;
-					uint8_t _flags;
-					decode_sql_type_info(hr->sql_type, &_type, &_precision, &_scale, &_flags);
-					if (HAS_PICX_AS_VARCHAR(_flags) || parser_data->job_params()->opt_picx_as_varchar)
-						pp_flags |= CBL_FIELD_FLAG_AUTOTRIM;
-
-					CobolVarType pp_type = CobolVarType::UNKNOWN;
-					int pp_size = 0, pp_scale = 0;
-					bool pp_is_varlen = parser_data->get_actual_field_data(pp, &pp_type, &pp_size, &pp_scale);
-					if (pp_is_varlen) {
-						raise_error("Inconsistent data for group field member: " + pp->sname, ERR_MISSING_HOSTVAR, stmt->src_abs_path, p->lineno);
-						return false;
-					}
-
-					pp_call.addParameter(pp_type, BY_VALUE);
-					pp_call.addParameter(pp_size, BY_VALUE);
-					pp_call.addParameter(pp_scale > 0 ? -pp_scale : 0, BY_VALUE);
-					pp_call.addParameter(pp_flags, BY_VALUE);
+		put_statement_registry_check();
 
-					pp_call.addParameter(pp->sname, BY_REFERENCE);
-					pp_call.addParameter(0, BY_VALUE);
-
-					if (!put_call(pp_call, false))
-						return false;
-
-					sql_params_count++;
-
-					pp = pp->sister;
-				}
-
-			}
-			else {
-				ESQLCall p_call(get_call_id("SetSQLParams"), emit_static);
-				int flags = is_varlen ? CBL_FIELD_FLAG_VARLEN : CBL_FIELD_FLAG_NONE;
-				flags |= (hr->usage == Usage::Binary) ? CBL_FIELD_FLAG_BINARY : CBL_FIELD_FLAG_NONE;
-
-				uint32_t _type, _precision;
-				uint16_t _scale;
-				uint8_t _flags;
-				decode_sql_type_info(hr->sql_type, &_type, &_precision, &_scale, &_flags);
-				if (HAS_PICX_AS_VARCHAR(_flags) || parser_data->job_params()->opt_picx_as_varchar)
-					flags |= CBL_FIELD_FLAG_AUTOTRIM;
-
-				p_call.addParameter(f_type, BY_VALUE);
-				p_call.addParameter(f_size, BY_VALUE);
-				p_call.addParameter(f_scale > 0 ? -f_scale : 0, BY_VALUE);
-				p_call.addParameter(flags, BY_VALUE);
-				p_call.addParameter(var_name, BY_REFERENCE);
-				if (has_indicator)
-					p_call.addParameter(ind_name, BY_REFERENCE);
-				else
-					p_call.addParameter(0, BY_REFERENCE);
+		put_start_exec_sql(false);
 
-				if (!put_call(p_call, false))
-					return false;
+		if (!put_statement_flags(cmd, stmt))
+			return false;
 
-				sql_params_count++;
-			}
-		}
+		int sql_params_count = 0;
+		if (!put_dml_host_parameters(cmd, stmt, &sql_params_count))
+			return false;
 
 		std::string dml_call_id = get_call_id(stmt->host_list->size() == 0 ? "Exec" : "ExecParams");
 		ESQLCall dml_call(dml_call_id, emit_static);
@@ -1475,6 +1403,20 @@ bool TPESQLProcessor::handle_esql_stmt(const ESQL_Command cmd, const cb_exec_sql
 	}
 	break;
 
+	case ESQL_Command::DeallocatePrepared:
+	{
+		ESQLCall dp_call(get_call_id("DeallocatePrepared"), emit_static);
+		dp_call.addParameter("SQLCA", BY_REFERENCE);
+		dp_call.addParameter(parser_data.get(), stmt->connectionId);
+		dp_call.addParameter("\"" + stmt->statementName + "\" & x\"00\"", BY_REFERENCE);
+
+		if (!put_call(dp_call, false))
+			return false;
+
+		put_whenever_handler(stmt->period);
+	}
+	break;
+
 	case ESQL_Command::BeginDeclareSection:
 	case ESQL_Command::EndDeclareSection:
 		/* Do nothing (for now) */
@@ -1762,53 +1704,34 @@ bool TPESQLProcessor::fixup_declared_vars()
 	return true;
 }
 
-std::map<uint64_t, uint64_t>& TPESQLProcessor::getBinarySrcLineMap() const
-{
-	return const_cast<std::map<uint64_t, uint64_t>&>(b_in_to_out);
-}
-
-std::map<uint64_t, uint64_t>& TPESQLProcessor::getBinarySrcLineMapReverse() const
-{
-	return const_cast<std::map<uint64_t, uint64_t>&>(b_out_to_in);
-}
-
 bool TPESQLProcessor::build_map_data()
 {
 	map_collect_files(filemap);
 
-	std::string file;
-	int line_in, line_out;
-	//uint64_t k, v;
-
-	// in to out map
-	for (std::map<std::string, std::string>::const_iterator it = in_to_out.begin(); it != in_to_out.end(); ++it) {
-		splitLineEntry(it->first, file, &line_in);
-		int fin_id = filemap[file];
-
-		splitLineEntry(it->second, file, &line_out);
-		int fout_id = filemap[file];
+	if (in_to_out.size())
+		return true;
 
-		uint64_t k = ((uint64_t)fin_id << 32) + line_in;
-		uint64_t v = ((uint64_t)fout_id << 32) + line_out;
+	int fout_id = map_file_ids[output_file];
 
-		b_in_to_out[k] = v;
+	in_to_out.reserve(out_to_in.size());
+	for (int i = 0; i < out_to_in.size(); i++) {
+		in_to_out.push_back({ out_to_in.at(i), MAP_FILE_LOCATION(fout_id, i + 1) });
 	}
 
-	// out to in map
-	for (std::map<std::string, std::string>::const_iterator it = out_to_in.begin(); it != out_to_in.end(); ++it) {
-
-		splitLineEntry(it->first, file, &line_out);
-		int fout_id = filemap[file];
-
-		splitLineEntry(it->second, file, &line_in);
-		int fin_id = filemap[file];
+	std::sort(in_to_out.begin(), in_to_out.end(), [](const SrcLineMapEntry& a, const SrcLineMapEntry& b) {
+		return a.from < b.from || (a.from == b.from && a.to < b.to);
+	});
 
-		uint64_t k = ((uint64_t)fout_id << 32) + line_out;
-		uint64_t v = ((uint64_t)fin_id << 32) + line_in;
-
-		b_out_to_in[k] = v;
+	// when an input line generates more than one output line, the last one is kept
+	size_t n = 0;
+	for (size_t i = 0; i < in_to_out.size(); i++) {
+		if (i + 1 < in_to_out.size() && in_to_out.at(i + 1).from == in_to_out.at(i).from)
+			continue;
 
+		in_to_out[n++] = in_to_out.at(i);
 	}
+	in_to_out.resize(n);
+	in_to_out.shrink_to_fit();
 
 	// Variable declaraton source location info
 
@@ -1838,69 +1761,42 @@ bool TPESQLProcessor::build_map_data()
 
 bool TPESQLProcessor::write_map_file(const std::string& preprocd_file)
 {
-	map_collect_files(filemap);
+	build_map_data();
 
 	if (parser_data->job_params()->opt_no_output)
 		return true;
 
-	MapFileWriter mw;
 	std::string outfile = filename_change_ext(preprocd_file, ".cbsql.map");
 
-	uint32_t nflags = FLAG_M_BASE;
-
 	// global data
-	mw.addSection("map");
-	mw.appendToSectionContents("map", MAP_FILE_FMT_VER);
-	mw.appendToSectionContents("map", nflags);
-	mw.appendToSectionContents("map", input_file);
-	mw.appendToSectionContents("map", output_file);
-	mw.appendToSectionContents("map", filemap[input_file]);
-	mw.appendToSectionContents("map", filemap[output_file]);
+	MapFileData md;
+	md.flags = FLAG_M_BASE;
+	md.input_file = input_file;
+	md.output_file = output_file;
+	md.input_file_id = filemap[input_file];
+	md.output_file_id = filemap[output_file];
 
 	// file map
-	mw.addSection("filemap");
-	mw.appendToSectionContents("filemap", filemap.size());
-	for (std::map<std::string, int>::const_iterator it = filemap.begin(); it != filemap.end(); ++it) {
-		mw.appendToSectionContents("filemap", string_format("#%d:%s", it->second, it->first));
+	for (const auto& f : filemap) {
+		md.files[f.second] = f.first;
 	}
 
-	std::string file;
-	int line_in, line_out;
-
-	// in to out map
-	mw.addSection("in_to_out_map");
-	mw.appendToSectionContents("in_to_out_map", in_to_out.size());
-
-	for (std::map<std::string, std::string>::const_iterator it = in_to_out.begin(); it != in_to_out.end(); ++it) {
-		splitLineEntry(it->first, file, &line_in);
-		int fin_id = filemap[file];
-
-		splitLineEntry(it->second, file, &line_out);
-		int fout_id = filemap[file];
-
-		mw.appendToSectionContents("in_to_out_map", string_format("%d@%d:%d@%d", line_in, fin_id, line_out, fout_id));
+	// line maps
+	md.in_to_out.reserve(in_to_out.size());
+	for (const auto& e : in_to_out) {
+		md.in_to_out.push_back({ e.from, e.to });
 	}
 
-	// out to in map
-	mw.addSection("out_to_in_map");
-	mw.appendToSectionContents("out_to_in_map", out_to_in.size());
-
-	for (std::map<std::string, std::string>::const_iterator it = out_to_in.begin(); it != out_to_in.end(); ++it) {
+	int fout_id = map_file_ids[output_file];
 
-		splitLineEntry(it->first, file, &line_out);
-		int fout_id = filemap[file];
-
-		splitLineEntry(it->second, file, &line_in);
-		int fin_id = filemap[file];
-
-		mw.appendToSectionContents("out_to_in_map", string_format("%d@%d:%d@%d", line_out, fout_id, line_in, fin_id));
+	md.out_to_in.reserve(out_to_in.size());
+	for (int i = 0; i < out_to_in.size(); i++) {
+		md.out_to_in.push_back({ MAP_FILE_LOCATION(fout_id, i + 1), out_to_in.at(i) });
 	}
 
 	// Variable declaraton source location info
 
-	mw.addSection("field_map");
 	auto const fmap = parser_data->get_field_map();
-	mw.appendToSectionContents("field_map", fmap.size());
 	for (std::map<std::string, cb_field_ptr>::const_iterator it = fmap.begin(); it != fmap.end(); ++it) {
 		std::string path;
 		std::string var = it->first;
@@ -1917,10 +1813,18 @@ bool TPESQLProcessor::write_map_file(const std::string& preprocd_file)
 
 		path = "WS:" + path;
 
-		mw.appendToSectionContents("field_map", string_format("%s/%s@%s:%d", fld->sname, path, fld->defined_at_source_file, fld->defined_at_source_line));
+		MapFileField mf;
+		mf.name = fld->sname;
+		mf.path = path;
+		mf.file = fld->defined_at_source_file;
+		mf.line = fld->defined_at_source_line;
+		md.fields.push_back(mf);
 	}
 
-	return mw.writeToFile(outfile);
+	if (std::get<bool>(owner->getOpt("binary_map_file", false)))
+		return md.saveBinary(outfile);
+
+	return md.saveText(outfile);
 }
 
 void TPESQLProcessor::add_dependency(const std::string& parent, const std::string& dep_path)
@@ -1996,6 +1900,119 @@ void TPESQLProcessor::put_smart_cursor_init_check(const std::string& crsr_name,
 	put_output_line(string_format(AREA_B_CPREFIX "END-IF"));
 }
 
+bool TPESQLProcessor::is_static_registry_item(const cb_exec_sql_stmt_ptr stmt)
+{
+	if (stmt->startup_item || stmt->sql_query_list_id <= 0)
+		return false;
+
+	if (stmt->commandName != ESQL_SELECT && stmt->commandName != ESQL_INSERT && stmt->commandName != ESQL_UPDATE && stmt->commandName != ESQL_DELETE)
+		return false;
+
+	// cursors have their own initialization block
+	if (stmt->commandName == ESQL_SELECT && !stmt->cursorName.empty())
+		return false;
+
+	// positioned updates/deletes depend on an open cursor
+	std::string sql_content = to_upper(this->ws_query_list.at(stmt->sql_query_list_id - 1));
+	return sql_content.find("CURRENT OF") == std::string::npos;
+}
+
+bool TPESQLProcessor::put_statement_registry()
+{
+	bool emit_static = parser_data->job_params()->opt_emit_static_calls;
+	std::string module_name = parser_data->program_id();
+
+	put_output_line(AREA_A_CPREFIX "GIXSQL-SR-INIT.");
+
+	for (cb_exec_sql_stmt_ptr stmt : *(parser_data->exec_list())) {
+		if (!is_static_registry_item(stmt))
+			continue;
+
+		int sql_params_count = 0;
+
+		put_start_exec_sql(false);
+
+		if (stmt->commandName == ESQL_SELECT) {
+			if (!put_host_parameters(stmt))
+				return false;
+
+			sql_params_count = stmt->host_list->size();
+		}
+		else {
+			ESQL_Command cmd = stmt->commandName == ESQL_INSERT ? ESQL_Command::Insert : (stmt->commandName == ESQL_UPDATE ? ESQL_Command::Update : ESQL_Command::Delete);
+			if (!put_dml_host_parameters(cmd, stmt, &sql_params_count))
+				return false;
+		}
+
+		ESQLCall rs_call(get_call_id("RegisterStatement"), emit_static);
+		rs_call.addParameter("SQLCA", BY_REFERENCE);
+		rs_call.addParameter(parser_data.get(), stmt->connectionId);
+		rs_call.addParameter("\"" + module_name + "\" & x\"00\"", BY_REFERENCE);
+		rs_call.addParameter(string_format("SQ%04d", stmt->sql_query_list_id), BY_REFERENCE);
+		rs_call.addParameter(sql_params_count, BY_VALUE);
+
+		if (!put_call(rs_call, false))
+			return false;
+
+		put_end_exec_sql(false);
+	}
+
+	put_output_line(AREA_B_CPREFIX "CONTINUE.");
+	return true;
+}
+
+void TPESQLProcessor::put_statement_registry_check()
+{
+	if (!parser_data->job_params()->opt_eager_prepare)
+		return;
+
+	put_output_line(AREA_B_CPREFIX "IF GIXSQL-SR-F = ' ' THEN");
+	put_output_line(AREA_B_CPREFIX "    PERFORM GIXSQL-SR-INIT");
+	put_output_line(AREA_B_CPREFIX "    MOVE 'X' TO GIXSQL-SR-F");
+	put_output_line(AREA_B_CPREFIX "END-IF");
+}
+
+// Only the statements whose kind is known at this stage are classified, 
+// the runtime will inspect the text of the others
+bool TPESQLProcessor::put_statement_flags(const ESQL_Command cmd, const cb_exec_sql_stmt_ptr stmt)
+{
+	bool emit_static = parser_data->job_params()->opt_emit_static_calls;
+	uint32_t flags = STMT_FLAG_CLASSIFIED;
+
+	switch (cmd) {
+	case ESQL_Command::Select:
+		flags |= STMT_FLAG_SELECT;
+		break;
+
+	case ESQL_Command::Insert:
+		flags |= STMT_FLAG_INSERT;
+		break;
+
+	case ESQL_Command::Update:
+	case ESQL_Command::Delete:
+	{
+		flags |= (cmd == ESQL_Command::Update) ? STMT_FLAG_UPDATE : STMT_FLAG_DELETE;
+		std::string sql_content = to_upper(this->ws_query_list.at(stmt->sql_query_list_id - 1));
+		if (sql_content.find("CURRENT OF") != std::string::npos)
+			flags |= STMT_FLAG_CURRENT_OF;
+	}
+	break;
+
+	case ESQL_Command::Commit:
+	case ESQL_Command::Rollback:
+		flags |= STMT_FLAG_TX_TERMINATION;
+		break;
+
+	default:
+		return true;
+	}
+
+	ESQLCall sf_call(get_call_id("SetStatementFlags"), emit_static);
+	sf_call.addParameter(flags, BY_VALUE);
+
+	return put_call(sf_call, false);
+}
+
 bool TPESQLProcessor::put_res_host_parameters(const cb_exec_sql_stmt_ptr stmt, int* res_params_count)
 {
 	int rp_count = 0;
@@ -2140,6 +2157,115 @@ bool TPESQLProcessor::put_host_parameters(const cb_exec_sql_stmt_ptr stmt)
 	return true;
 }
 
+bool TPESQLProcessor::put_dml_host_parameters(const ESQL_Command cmd, const cb_exec_sql_stmt_ptr stmt, int* params_count)
+{
+	CobolVarType f_type;
+	int f_size, f_scale;
+	bool emit_static = parser_data->job_params()->opt_emit_static_calls;
+
+	*params_count = 0;
+
+	// Special case: we cannot use the put_host_parameters method because we need to handle group variables
+	for (cb_hostreference_ptr p : *stmt->host_list) {
+
+		std::string var_name, ind_name;
+		bool has_indicator = decode_indicator(p->hostreference.substr(1), var_name, ind_name);
+		if (!parser_data->field_exists(var_name)) {
+			raise_error("Cannot find host variable: " + p->hostreference.substr(1), ERR_MISSING_HOSTVAR, stmt->src_abs_path, p->lineno);
+			return false;
+		}
+
+		cb_field_ptr hr = parser_data->field_map(var_name);
+		bool is_varlen = parser_data->get_actual_field_data(hr, &f_type, &f_size, &f_scale);
+
+		// Support for group items used as host variables in INSERT statements
+		// They are decomposed into their sub-elements
+		if (cmd == ESQL_Command::Insert && f_type == CobolVarType::COBOL_TYPE_GROUP && !is_varlen) {
+
+			if (has_indicator) {
+				raise_error("Invalid null indicator reference: " + var_name, ERR_INVALID_NULLIND_REF, stmt->src_abs_path, p->lineno);
+				return false;
+			}
+
+			if (hr->group_levels_count != 1) {
+				raise_error("Nested levels not allowed in group variable: " + var_name, ERR_MISSING_HOSTVAR, stmt->src_abs_path, p->lineno);
+				return false;
+			}
+
+			cb_field_ptr pp = hr->children;
+			if (!pp) {
+				raise_error("Inconsistent data for group field : " + hr->sname, ERR_MISSING_HOSTVAR, stmt->src_abs_path, p->lineno);
+				return false;
+			}
+
+			while (pp) {
+
+				ESQLCall pp_call(get_call_id("SetSQLParams"), emit_static);
+				int pp_flags = (pp->usage == Usage::Binary) ? CBL_FIELD_FLAG_BINARY : CBL_FIELD_FLAG_NONE;
+
+				uint32_t _type, _precision;
+				uint16_t _scale;
+				uint8_t _flags;
+				decode_sql_type_info(hr->sql_type, &_type, &_precision, &_scale, &_flags);
+				if (HAS_PICX_AS_VARCHAR(_flags) || parser_data->job_params()->opt_picx_as_varchar)
+					pp_flags |= CBL_FIELD_FLAG_AUTOTRIM;
+
+				CobolVarType pp_type = CobolVarType::UNKNOWN;
+				int pp_size = 0, pp_scale = 0;
+				bool pp_is_varlen = parser_data->get_actual_field_data(pp, &pp_type, &pp_size, &pp_scale);
+				if (pp_is_varlen) {
+					raise_error("Inconsistent data for group field member: " + pp->sname, ERR_MISSING_HOSTVAR, stmt->src_abs_path, p->lineno);
+					return false;
+				}
+
+				pp_call.addParameter(pp_type, BY_VALUE);
+				pp_call.addParameter(pp_size, BY_VALUE);
+				pp_call.addParameter(pp_scale > 0 ? -pp_scale : 0, BY_VALUE);
+				pp_call.addParameter(pp_flags, BY_VALUE);
+
+				pp_call.addParameter(pp->sname, BY_REFERENCE);
+				pp_call.addParameter(0, BY_VALUE);
+
+				if (!put_call(pp_call, false))
+					return false;
+
+				(*params_count)++;
+
+				pp = pp->sister;
+			}
+
+		}
+		else {
+			ESQLCall p_call(get_call_id("SetSQLParams"), emit_static);
+			int flags = is_varlen ? CBL_FIELD_FLAG_VARLEN : CBL_FIELD_FLAG_NONE;
+			flags |= (hr->usage == Usage::Binary) ? CBL_FIELD_FLAG_BINARY : CBL_FIELD_FLAG_NONE;
+
+			uint32_t _type, _precision;
+			uint16_t _scale;
+			uint8_t _flags;
+			decode_sql_type_info(hr->sql_type, &_type, &_precision, &_scale, &_flags);
+			if (HAS_PICX_AS_VARCHAR(_flags) || parser_data->job_params()->opt_picx_as_varchar)
+				flags |= CBL_FIELD_FLAG_AUTOTRIM;
+
+			p_call.addParameter(f_type, BY_VALUE);
+			p_call.addParameter(f_size, BY_VALUE);
+			p_call.addParameter(f_scale > 0 ? -f_scale : 0, BY_VALUE);
+			p_call.addParameter(flags, BY_VALUE);
+			p_call.addParameter(var_name, BY_REFERENCE);
+			if (has_indicator)
+				p_call.addParameter(ind_name, BY_REFERENCE);
+			else
+				p_call.addParameter(0, BY_REFERENCE);
+
+			if (!put_call(p_call, false))
+				return false;
+
+			(*params_count)++;
+		}
+	}
+	return true;
+}
+
 void TPESQLProcessor::add_preprocessed_blocks()
 {
 	std::vector<cb_exec_sql_stmt_ptr>* p = parser_data->exec_list();
@@ -2153,9 +2279,7 @@ void TPESQLProcessor::add_preprocessed_blocks()
 		bi->orig_start_line = e->startLine;
 		bi->orig_end_line = e->endLine;
 
-		auto in_out_start_key = std::to_string(bi->orig_start_line) + "@" + bi->orig_source_file;
-		auto in_out_end_key = std::to_string(bi->orig_end_line) + "@" + bi->orig_source_file;
-		if (in_to_out.find(in_out_start_key) == in_to_out.end() || in_to_out.find(in_out_end_key) == in_to_out.end()) {
+		if (!find_output_line(bi->orig_source_file, bi->orig_start_line, &bi->pp_start_line) || !find_output_line(bi->orig_source_file, bi->orig_end_line, &bi->pp_end_line)) {
 			continue;
 		}
 
@@ -2163,13 +2287,7 @@ void TPESQLProcessor::add_preprocessed_blocks()
 			continue;
 		}
 
-		auto in_out_start_val = in_to_out[in_out_start_key];
-		auto in_out_end_val = in_to_out[in_out_end_key];
-
-		bi->pp_source_file = in_out_start_val.substr(in_out_start_val.find("@") + 1);
-		bi->pp_start_line = atoi(in_out_start_val.substr(0, in_out_start_val.find("@")).c_str());
-
-		bi->pp_end_line = atoi(in_out_end_val.substr(0, in_out_end_val.find("@")).c_str());
+		bi->pp_source_file = output_file;
 
 		bi->module_name = parser_data->program_id();
 
@@ -2262,51 +2380,49 @@ std::string TPESQLProcessor::getModuleName()
 	return parser_data->program_id();
 }
 
-void TPESQLProcessor::splitLineEntry(const std::string& k, std::string& s, int* i)
+void TPESQLProcessor::map_collect_files(std::map<std::string, int>& filemap)
 {
-	int p = k.find("@");
-	s = k.substr(p + 1);
-	*i = std::stoi(k.substr(0, p));
+	filemap.clear();
+	for (int i = 0; i < map_files.size(); i++) {
+		filemap[map_files.at(i)] = i + 1;
+	}
 }
 
-void TPESQLProcessor::map_collect_files(std::map<std::string, int>& filemap)
+int TPESQLProcessor::get_map_file_id(const std::string& f)
 {
-	int l;
-	int n = 1;
-	std::string f;
-
-	if (!in_to_out.size())
-		return;
-
-	//std::string s = in_to_out[in_to_out.keys().at(0)];
-	std::string s = in_to_out.begin()->second;
-
-	splitLineEntry(s, f, &l);
-	filemap[f] = n++;
+	auto it = map_file_ids.find(f);
+	if (it != map_file_ids.end())
+		return it->second;
+
+	map_files.push_back(f);
+	int id = map_files.size();
+	map_file_ids[f] = id;
+	return id;
+}
 
-	std::map<std::string, std::string>::const_iterator it = in_to_out.begin();
-	auto end = in_to_out.end();
-	while (it != end) {
-		splitLineEntry(it->first, f, &l);
-		if (!map_contains<std::string, int>(filemap, f))
-			filemap[f] = n++;
+bool TPESQLProcessor::find_output_line(const std::string& f, int line, int* out_line)
+{
+	auto it_id = map_file_ids.find(f);
+	if (it_id == map_file_ids.end())
+		return false;
 
-		splitLineEntry(it->second, f, &l);
-		if (!map_contains<std::string, int>(filemap, f))
-			filemap[f] = n++;
+	uint64_t k = MAP_FILE_LOCATION(it_id->second, line);
+	auto it = std::lower_bound(in_to_out.begin(), in_to_out.end(), k, [](const SrcLineMapEntry& e, uint64_t k) { return e.from < k; });
+	if (it == in_to_out.end() || it->from != k)
+		return false;
 
-		++it;
-	}
+	*out_line = MAP_FILE_LOCATION_LINE(it->to);
+	return true;
 }
 
-std::map<std::string, std::string>& TPESQLProcessor::getSrcLineMap() const
+const std::vector<SrcLineMapEntry>& TPESQLProcessor::getSrcLineMap() const
 {
-	return const_cast<std::map<std::string, std::string>&>(in_to_out);
+	return in_to_out;
 }
 
-std::map<std::string, std::string>& TPESQLProcessor::getSrcLineMapReverse() const
+const std::vector<uint64_t>& TPESQLProcessor::getSrcLineMapReverse() const
 {
-	return const_cast<std::map<std::string, std::string>&>(out_to_in);
+	return out_to_in;
 }
 
 std::map<std::string, int>& TPESQLProcessor::getFileMap() const
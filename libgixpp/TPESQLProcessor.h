@@ -23,6 +23,7 @@ USA.
 #include <string>
 #include <vector>
 #include <map>
+#include <unordered_map>
 #include <stack>
 #include <memory>
 
@@ -32,10 +33,28 @@ USA.
 #include "ESQLCall.h"
 
 class gix_esql_driver;
-struct esql_whenever_clause_handler_t;
 
 enum class ESQL_Command;
 
+struct esql_whenever_clause_handler_t {
+	int action = WHENEVER_ACTION_CONTINUE;
+	std::string host_label;
+};
+
+// Source line map entry, locations are packed as (file id << 32) + line (file ids are the ones in getFileMap)
+struct SrcLineMapEntry
+{
+	uint64_t from;
+	uint64_t to;
+};
+
+struct esql_whenever_handler_t
+{
+	esql_whenever_clause_handler_t not_found;
+	esql_whenever_clause_handler_t sqlwarning;
+	esql_whenever_clause_handler_t sqlerror;
+};
+
 class TPESQLProcessor : public ITransformationStep
 {
 	friend class gix_esql_driver;
@@ -45,11 +64,11 @@ public:
 
 	std::string getModuleName();
 
-	std::map<std::string, std::string> &getSrcLineMap() const;
-	std::map<std::string, std::string> &getSrcLineMapReverse() const;
+	// input location -> output location, sorted by input location
+	const std::vector<SrcLineMapEntry> &getSrcLineMap() const;
 
-	std::map<uint64_t, uint64_t> &getBinarySrcLineMap() const;
-	std::map<uint64_t, uint64_t> &getBinarySrcLineMapReverse() const;
+	// input location of each output line (element n is output line n + 1)
+	const std::vector<uint64_t> &getSrcLineMapReverse() const;
 
 	std::map<std::string, int> &getFileMap() const;
 	std::map<int, std::string> getReverseFileMap();
@@ -62,6 +81,7 @@ public:
 	virtual bool run(std::shared_ptr<ITransformationStep> prev_step) override;
 	TransformationStepDataType getInputType() override;
 	TransformationStepDataType getOutputType() override;
+	std::string getName() override { return "code generation"; }
 	virtual TransformationStepData* getOutput(std::shared_ptr<ITransformationStep> me = nullptr) override;
 
 
@@ -76,11 +96,12 @@ private:
 
 	int output_line;
 
-	std::map<std::string, std::string> in_to_out;
-	std::map<std::string, std::string> out_to_in;
+	std::vector<uint64_t> out_to_in;
+	std::vector<SrcLineMapEntry> in_to_out;	// built from out_to_in by build_map_data
 
-	std::map<uint64_t, uint64_t> b_in_to_out;
-	std::map<uint64_t, uint64_t> b_out_to_in;
+	// ids for the line maps (1-based, the output file is always #1)
+	std::unordered_map<std::string, int> map_file_ids;
+	std::vector<std::string> map_files;
 
 	//std::vector<PreprocessedBlockInfo*> preprocessed_blocks;
 	std::map<cb_exec_sql_stmt_ptr, std::tuple<int, int>> generated_blocks;
@@ -117,8 +138,8 @@ private:
 	bool build_map_data();
 
 	void map_collect_files(std::map<std::string, int> &filemap);
-
-	void splitLineEntry(const std::string &k, std::string &s, int *i);
+	int get_map_file_id(const std::string& f);
+	bool find_output_line(const std::string& f, int line, int* out_line);
 
 	bool generate_consolidated_map();
 
@@ -131,8 +152,14 @@ private:
 	void put_smart_cursor_init_flags();
 	void put_smart_cursor_init_check(const std::string& crsr_name, bool reset_sqlcode = false);
 
+	bool is_static_registry_item(const cb_exec_sql_stmt_ptr stmt);
+	bool put_statement_registry();
+	void put_statement_registry_check();
+
 	bool put_res_host_parameters(const cb_exec_sql_stmt_ptr stmt, int *res_params_count);
 	bool put_host_parameters(const cb_exec_sql_stmt_ptr stmt);
+	bool put_dml_host_parameters(const ESQL_Command cmd, const cb_exec_sql_stmt_ptr stmt, int* params_count);
+	bool put_statement_flags(const ESQL_Command cmd, const cb_exec_sql_stmt_ptr stmt);
 
 	void add_preprocessed_blocks();
 	bool decode_indicator(const std::string& orig_name, std::string& var_name, std::string& ind_name);
@@ -155,6 +182,8 @@ private:
 
 	int current_input_line;
 
+	esql_whenever_handler_t esql_whenever_handler;
+
 	bool emitted_query_defs = false;
 	bool emitted_smart_cursor_init_flags = false;
 
@@ -51,29 +51,37 @@ bool TPSourceConsolidation::run(std::shared_ptr<ITransformationStep> prev_step)
 	
 	map_only = std::get<bool>(owner->getOpt("no_output", false));
 
-	if (!map_only) {
-		if (output_file.empty()) {
-			std::string f = filename_change_ext(input_file, ".cblpp");
-			f = owner->getTempPath() + PATH_SEPARATOR + std::filesystem::path(f).filename().string();
-			output_file = f;
-		}
-
-		if (!file_is_writable(output_file))
-			return false;
+	// if another step follows, the consolidated source is passed to it in memory
+	// and the temporary file is only written if requested (for inspection)
+	bool in_memory = owner->lastStep().get() != this;
+	bool write_file = !map_only && (!in_memory || owner->keep_temp_files);
+
+	if (output_file.empty()) {
+		std::string f = filename_change_ext(input_file, ".cblpp");
+		f = owner->getTempPath() + PATH_SEPARATOR + std::filesystem::path(f).filename().string();
+		output_file = f;
 	}
 
+	if (write_file && !file_is_writable(output_file))
+		return false;
+
 	input_file_stack.push(input_file);
 	if (!processNextFile())
 		return false;
 
-	if (!map_only) {
-		file_write_all_lines(output_file, all_lines);
-	}
+	if (write_file && !file_write_all_lines(output_file, all_lines))
+		return false;
 
 	output = new TransformationStepData();
-	output->setType(TransformationStepDataType::Filename);
 	output->setFilename(output_file);
 
+	if (in_memory) {
+		output->setType(TransformationStepDataType::LineBuffer);
+		output->setLineBuffer(std::make_shared<const std::vector<std::string>>(std::move(all_lines)));
+	}
+	else
+		output->setType(TransformationStepDataType::Filename);
+
 	return true;
 }
 
@@ -105,7 +113,8 @@ std::map<std::string, std::string> &TPSourceConsolidation::getSrcLineMap() const
 bool TPSourceConsolidation::processNextFile()
 {
 	std::string the_file = input_file_stack.top();
-	std::vector<std::string> input_lines = file_read_all_lines(the_file);
+	auto input_lines_ptr = owner->readFileLines(the_file, input_file_stack.size() > 1);
+	const std::vector<std::string>& input_lines = *input_lines_ptr;
 	std::string copy_name, copy_file;
 
 	if (!input_lines.size()) {
@@ -120,7 +129,7 @@ bool TPSourceConsolidation::processNextFile()
 		std::string cur_line = input_lines.at(input_line - 1);
 
 		if (is_copy_statement(cur_line, copy_name)) {
-			if (!owner->getCopyResolver()->resolveCopyFile(copy_name, copy_file)) {
+			if (!owner->resolveCopyFile(copy_name, copy_file)) {
 				SET_ERR(5, string_format("Cannot resolve copy %s", copy_name));
 				return false;
 			}
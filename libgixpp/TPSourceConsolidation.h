@@ -36,6 +36,7 @@ public:
 	virtual bool run(std::shared_ptr<ITransformationStep> prev_step) override;
 	TransformationStepDataType getInputType() override;
 	TransformationStepDataType getOutputType() override;
+	std::string getName() override { return "consolidation"; }
 
 	virtual TransformationStepData *getOutput(std::shared_ptr<ITransformationStep> me = nullptr) override;
 
@@ -122,6 +122,17 @@ int gix_esql_driver::parse (TransformationStepData *input, std::shared_ptr<ESQLP
 	_parser_data->set_parsed_filename(input->filename());
 	lexer.src_location_stack.push({ filename_absolute_path(input->filename()), 1 });
 
+	if (input->type() == TransformationStepDataType::LineBuffer) {
+		_parser_data->set_parsed_lines(input->lineBuffer());
+
+		std::string src;
+		for (const auto& l : *input->lineBuffer()) {
+			src += l;
+			src += '\n';
+		}
+		mem_instream.str(src);
+	}
+
     scan_begin ();
     yy::gix_esql_parser parser (this);
     parser.set_debug_level (trace_parsing);
@@ -174,6 +185,11 @@ void gix_esql_driver::scan_begin()
 {
     lexer.set_debug( trace_scanning );
 
+    if (_parser_data->parsed_lines()) {
+        lexer.switch_streams(&mem_instream, 0);
+        return;
+    }
+
     // Try to open the file:
     instream.open(file);
 
@@ -412,7 +428,7 @@ std::string gix_esql_driver::try_resolve_included_file(const std::string& f)
 {
 	std::string resolved;
 	GixPreProcessor *gp = this->getParser()->getOwner();
-	if (!gp->getCopyResolver()->resolveCopyFile(f, resolved))
+	if (!gp->resolveCopyFile(f, resolved))
 		return std::string();
 
 	return resolved;
@@ -22,6 +22,7 @@ USA.
 
 // CHANGE: added <fstream> for new std::ifstream member "instream":
 #include <fstream>
+#include <sstream>
 #include <string>
 #include <memory>
 
@@ -85,6 +86,9 @@ public:
     // CHANGE: add ifstream object as a member
     std::ifstream instream;
 
+    // used when the source is passed in memory by the previous step
+    std::istringstream mem_instream;
+
     // Handling the scanner.
     void scan_begin ();
     void scan_end ();
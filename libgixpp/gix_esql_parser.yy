@@ -186,6 +186,7 @@ static std::string to_std_string(connect_to_info_t *i) { if (i) { char buffer [3
 %token<int> WITH_HOLD		"WITH HOLD"
 %token WHERE_CURRENT_OF		"WHERE CURRENT OF"
 %token PREPARE
+%token DEALLOCATE_PREPARE		"DEALLOCATE PREPARE"
 
 %type <std::vector<std::string> *> token_list declaresql includesql incfile opt_othersql_tokens
 %type <std::vector<std::string> *> opensql selectintosql select insertsql insert updatesql 
@@ -232,6 +233,7 @@ sqlvariantstates
 | othersql
 | declaresql
 | preparesql
+| deallocatesql
 | executesql
 | ignoresql
 | wheneversql
@@ -686,6 +688,14 @@ execsql_with_opt_at PREPARE TOKEN FROM strliteral_or_hostref END_EXEC {
 }
 ;
 
+deallocatesql:
+execsql_with_opt_at DEALLOCATE_PREPARE TOKEN END_EXEC {
+	driver->commandname = "DEALLOCATE_PREPARE";
+	driver->statement_name = $3;
+	driver->put_exec_list();
+}
+;
+
 executesql:
 execsql_with_opt_at EXECUTE IMMEDIATE strliteral_or_hostref END_EXEC {
 	driver->commandname = "EXECUTE_IMMEDIATE";
@@ -31,9 +31,6 @@
 #include "libcpputils.h"
 
 
-int subquery_level = 0;
-int cursor_hold = 0;
-
 int find_last_space(char * s);
 int count_crlf(char *s);
 int count_open_par(char *s);
@@ -41,8 +38,6 @@ int count_close_par(char *s);
 uint32_t extract_len(char * s);
 void extract_precision_scale(char * s, uint32_t *precision, uint16_t *scale);
 
-std::vector<std::string> cur_token_list;
-
 #ifdef _MSC_VER 
 #define strncasecmp _strnicmp
 #define strcasecmp _stricmp
@@ -69,9 +64,6 @@ std::vector<std::string> cur_token_list;
 // <http://bugs.debian.org/cgi-bin/bugreport.cgi?bug=333231>.
 # undef yywrap
 
-// The location of the current token.
-static yy::location loc;
-
 // CHANGE: "Code run each time a pattern is matched" moved from its
 // own block below (this change was not strictly necessary).
 #define YY_USER_ACTION  loc.columns (yyleng);
@@ -88,8 +80,6 @@ const char *GixEsqlLexer::yy_state_descs[NUM_YY_STATES] = { "INITIAL", "PICTURE_
 													"ESQL_PREPARE_STATE", "ESQL_DECLARE_STATE", "ESQL_EXECUTE_STATE", "ESQL_CONNECT_STATE", "ESQL_IGNORE_STATE", "ESQL_WHENEVER_STATE"  };
 #endif
 
-yy::gix_esql_parser::symbol_type __MAKE_TOKEN(char *s, yy::location loc);
-
 %}
 
 /* Options: */
@@ -322,6 +312,14 @@ SUBSYSTEM "SQL"|"CICS"|"DLI"
 		driver->statement_source = nullptr;
 		return yy::gix_esql_parser::make_PREPARE(loc);
 	}
+
+	"DEALLOCATE"([ ]+"PREPARE")? {
+		__yy_push_state(ESQL_PREPARE_STATE);
+		driver->commandname = "DEALLOCATE_PREPARE";
+		driver->statement_name = "";
+		driver->statement_source = nullptr;
+		return yy::gix_esql_parser::make_DEALLOCATE_PREPARE(loc);
+	}
      
 	"EXECUTE" {
 		__yy_push_state(ESQL_EXECUTE_STATE);
@@ -1595,7 +1593,7 @@ void extract_precision_scale(char *s, uint32_t *precision, uint16_t *scale)
 	*scale = (uint16_t) atoi(sn.c_str());
 }
 
-yy::gix_esql_parser::symbol_type __MAKE_TOKEN(char *s, yy::location loc)
+yy::gix_esql_parser::symbol_type GixEsqlLexer::__MAKE_TOKEN(char *s, yy::location loc)
 {
 	cur_token_list.push_back(s);
 	if (subquery_level > 0) {
@@ -19,6 +19,7 @@
 */
 
 #include <cstring>
+#include <type_traits>
 
 #include "DbInterfaceMySQL.h"
 #include "IConnection.h"
@@ -127,6 +128,7 @@ int DbInterfaceMySQL::connect(std::shared_ptr<IDataSourceInfo> _conn_info, std::
 		lib_logger->trace(FMT_FILE_FUNC "MYSQL::updatable cursor support is disabled", __FILE__, __func__);
 
 	connaddr = conn;
+	connection_thread_id = mysql_thread_id(conn);
 	current_statement_data = nullptr;
 
 	this->connection_opts = _conn_opts;
@@ -147,6 +149,7 @@ int DbInterfaceMySQL::reset()
 int DbInterfaceMySQL::terminate_connection()
 {
 	current_statement_data.reset();
+	_cursor_stmts.clear();
 
 	if (connaddr) {
 		mysql_close(connaddr);
@@ -314,6 +317,25 @@ int DbInterfaceMySQL::exec_prepared(const std::string& _stmt_name, std::vector<C
 	return DBERR_NO_ERROR;
 }
 
+int DbInterfaceMySQL::deallocate_prepared(const std::string& _stmt_name)
+{
+	std::string stmt_name = to_lower(_stmt_name);
+
+	lib_logger->trace(FMT_FILE_FUNC "statement name: {}", __FILE__, __func__, stmt_name);
+
+	auto it = _prepared_stmts.find(stmt_name);
+	if (it == _prepared_stmts.end()) {
+		mysqlSetError(DBERR_SQL_ERROR, "26000", "Invalid prepared statement name: " + stmt_name);
+		return DBERR_SQL_ERROR;
+	}
+
+	// the statement is closed on the server when the last reference to it (e.g. from an open cursor) is released
+	_prepared_stmts.erase(it);
+
+	mysqlClearError();
+	return DBERR_NO_ERROR;
+}
+
 DbPropertySetResult DbInterfaceMySQL::set_property(DbProperty p, std::variant<bool, int, std::string> v)
 {
 	return DbPropertySetResult::Unsupported;
@@ -381,7 +403,7 @@ int DbInterfaceMySQL::_mysql_exec_params(std::shared_ptr<ICursor> crsr, const st
 
 		wk_rs = std::make_shared<MySQLStatementData>();
 
-		if (updatable_cursors_emu && is_update_or_delete_where_current_of(query, table_name, cursor_name, &is_delete)) {
+		if (updatable_cursors_emu && (!STMT_IS_CLASSIFIED(stmt_flags) || STMT_IS_CURRENT_OF(stmt_flags)) && is_update_or_delete_where_current_of(query, table_name, cursor_name, &is_delete)) {
 
 			// No cursor was passed, we need to find it
 			if (cursor_name.empty() || this->_declared_cursors.find(cursor_name) == this->_declared_cursors.end() || !this->_declared_cursors[cursor_name]) {
@@ -506,7 +528,7 @@ int DbInterfaceMySQL::_mysql_exec_params(std::shared_ptr<ICursor> crsr, const st
 	}
 
 	if (!prep_stmt_data) {
-		if (is_update_or_delete_statement(query)) {
+		if (STMT_IS_CLASSIFIED(stmt_flags) ? STMT_IS_UPDATE_OR_DELETE(stmt_flags) : is_update_or_delete_statement(query)) {
 			int nrows = mysql_stmt_affected_rows(wk_rs->statement);
 			if (nrows <= 0) {
 				last_rc = 100;
@@ -552,7 +574,7 @@ int DbInterfaceMySQL::_mysql_exec(std::shared_ptr<ICursor> crsr, const std::stri
 
 		wk_rs = std::make_shared<MySQLStatementData>();
 
-		if (updatable_cursors_emu && is_update_or_delete_where_current_of(query, table_name, cursor_name, &is_delete)) {
+		if (updatable_cursors_emu && (!STMT_IS_CLASSIFIED(stmt_flags) || STMT_IS_CURRENT_OF(stmt_flags)) && is_update_or_delete_where_current_of(query, table_name, cursor_name, &is_delete)) {
 
 			// No cursor was passed, we need to find it
 			if (cursor_name.empty() || this->_declared_cursors.find(cursor_name) == this->_declared_cursors.end() || !this->_declared_cursors[cursor_name]) {
@@ -655,7 +677,7 @@ int DbInterfaceMySQL::_mysql_exec(std::shared_ptr<ICursor> crsr, const std::stri
 	}
 
 	if (!prep_stmt_data) {
-		if (is_update_or_delete_statement(query)) {
+		if (STMT_IS_CLASSIFIED(stmt_flags) ? STMT_IS_UPDATE_OR_DELETE(stmt_flags) : is_update_or_delete_statement(query)) {
 			int nrows = mysql_stmt_affected_rows(wk_rs->statement);
 			if (nrows <= 0) {
 				last_rc = 100;
@@ -710,6 +732,13 @@ int DbInterfaceMySQL::cursor_close(const std::shared_ptr<ICursor>& cursor)
 			return DBERR_CLOSE_CURSOR_FAILED;
 		}
 
+		// Statements cached for the cursor are kept for the next OPEN
+		auto it = _cursor_stmts.find(cursor->getName());
+		if (it != _cursor_stmts.end() && it->second == dp) {
+			cursor->setPrivateData(nullptr);
+			return DBERR_NO_ERROR;
+		}
+
 		rc = mysql_stmt_close(dp->statement);
 		dp->statement = nullptr;
 		if (mysqlRetrieveError(rc) != MYSQL_OK) {
@@ -773,6 +802,12 @@ int DbInterfaceMySQL::cursor_open(const std::shared_ptr<ICursor>& cursor)
 		return DBERR_OPEN_CURSOR_FAILED;
 	}
 
+	if (!prepared_stmt_data) {
+		prepared_stmt_data = get_cursor_statement(cursor, squery);
+		if (!prepared_stmt_data)
+			return DBERR_OPEN_CURSOR_FAILED;
+	}
+
 	if (cursor->getNumParams() > 0) {
 		std::vector<std_binary_data> param_values = cursor->getParameterValues();
 		std::vector<CobolVarType> param_types = cursor->getParameterTypes();
@@ -935,6 +970,106 @@ bool DbInterfaceMySQL::move_to_first_record(const std::string& _stmt_name)
 	return true;
 }
 
+int DbInterfaceMySQL::explain(const std::string& query, const std::vector<CobolVarType>& paramTypes, const std::vector<std_binary_data>& paramValues, const std::vector<unsigned long>& paramLengths, const std::vector<uint32_t>& paramFlags, std::string& plan)
+{
+	// errors are only logged: last_rc/last_error still refer to the statement being explained
+	std::string explain_query = "EXPLAIN FORMAT=JSON " + query;
+	MYSQL_STMT* stmt = mysql_stmt_init(connaddr);
+	if (!stmt)
+		return DBERR_OUT_OF_MEMORY;
+
+	int nParams = paramValues.size();
+	std::unique_ptr<MYSQL_BIND[]> bound_param_defs = std::make_unique<MYSQL_BIND[]>(nParams > 0 ? nParams : 1);
+	for (int i = 0; i < nParams; i++) {
+		MYSQL_BIND* bound_param = &bound_param_defs[i];
+		if (paramLengths.at(i) != DB_NULL) {
+			bound_param->buffer_type = CBL_FIELD_IS_BINARY(paramFlags[i]) ? MYSQL_TYPE_BLOB : MYSQL_TYPE_STRING;
+			bound_param->buffer = (char*)paramValues.at(i).data();
+			bound_param->buffer_length = paramLengths.at(i);
+		}
+		else {
+			bound_param->buffer_type = MYSQL_TYPE_NULL;
+		}
+	}
+
+	if (mysql_stmt_prepare(stmt, explain_query.c_str(), explain_query.size()) ||
+		(nParams > 0 && mysql_stmt_bind_param(stmt, bound_param_defs.get())) ||
+		mysql_stmt_execute(stmt) ||
+		mysql_stmt_store_result(stmt)) {
+		lib_logger->error("MySQL: EXPLAIN failed ({}): {}", mysql_stmt_errno(stmt), mysql_stmt_error(stmt));
+		mysql_stmt_close(stmt);
+		return DBERR_SQL_ERROR;
+	}
+
+	// the result is a single row with a single (JSON) column
+	unsigned long len = 0;
+	// bool in MySQL 8, my_bool in MariaDB/older clients
+	std::remove_pointer_t<decltype(MYSQL_BIND::is_null)> is_null = 0;
+	MYSQL_BIND res_col;
+	memset(&res_col, 0, sizeof(MYSQL_BIND));
+	res_col.buffer_type = MYSQL_TYPE_STRING;
+	res_col.length = &len;
+	res_col.is_null = &is_null;
+
+	int rc = DBERR_NO_ERROR;
+	plan.clear();
+	if (mysql_stmt_bind_result(stmt, &res_col) == 0) {
+		while (true) {
+			int frc = mysql_stmt_fetch(stmt);
+			if (frc == MYSQL_NO_DATA || frc == 1)
+				break;
+
+			// MYSQL_DATA_TRUNCATED: len holds the actual length
+			if (!is_null && len > 0) {
+				std::string col(len, '\0');
+				res_col.buffer = col.data();
+				res_col.buffer_length = len;
+				if (mysql_stmt_fetch_column(stmt, &res_col, 0, 0) == 0)
+					plan += col;
+				res_col.buffer = nullptr;
+				res_col.buffer_length = 0;
+			}
+		}
+	}
+	else {
+		lib_logger->error("MySQL: EXPLAIN failed ({}): {}", mysql_stmt_errno(stmt), mysql_stmt_error(stmt));
+		rc = DBERR_SQL_ERROR;
+	}
+
+	mysql_stmt_close(stmt);
+	return rc;
+}
+
+int DbInterfaceMySQL::cancel()
+{
+	if (!connaddr || !data_source_info)
+		return DBERR_CONN_NOT_FOUND;
+
+	// The connection is busy running the statement: KILL QUERY is sent over a separate, 
+	// short-lived connection. The statement fails with ER_QUERY_INTERRUPTED, the connection stays open
+	unsigned int port = data_source_info->getPort() > 0 ? data_source_info->getPort() : 3306;
+	MYSQL* side_conn = mysql_init(NULL);
+	if (!mysql_real_connect(side_conn, data_source_info->getHost().c_str(), data_source_info->getUsername().c_str(),
+		data_source_info->getPassword().c_str(), nullptr, port, NULL, 0)) {
+		lib_logger->error("MySQL: cannot connect to cancel the statement: {}", mysql_error(side_conn));
+		mysql_close(side_conn);
+		mysql_thread_end();
+		return DBERR_CONNECTION_FAILED;
+	}
+
+	std::string q = "KILL QUERY " + std::to_string(connection_thread_id);
+	int rc = mysql_real_query(side_conn, q.c_str(), q.size());
+	if (rc != MYSQL_OK)
+		lib_logger->error("MySQL: cannot cancel the statement: {}", mysql_error(side_conn));
+
+	mysql_close(side_conn);
+
+	// called from the watchdog thread, that would otherwise keep the per-thread client data
+	mysql_thread_end();
+
+	return (rc == MYSQL_OK) ? DBERR_NO_ERROR : DBERR_SQL_ERROR;
+}
+
 uint64_t DbInterfaceMySQL::get_native_features()
 {
 	return (uint64_t)DbNativeFeature::ResultSetRowCount;
@@ -1089,6 +1224,36 @@ static std::string mysql_fixup_parameters(const std::string& sql)
 	return out_sql;
 }
 
+std::shared_ptr<MySQLStatementData> DbInterfaceMySQL::get_cursor_statement(const std::shared_ptr<ICursor>& crsr, const std::string& query)
+{
+	std::string cname = crsr->getName();
+	auto it = _cursor_stmts.find(cname);
+	if (it != _cursor_stmts.end()) {
+		if (it->second->query == query) {
+			lib_logger->trace(FMT_FILE_FUNC "MySQL::reusing statement for cursor {}", __FILE__, __func__, cname);
+			return it->second;
+		}
+		_cursor_stmts.erase(it);
+	}
+
+	std::shared_ptr<MySQLStatementData> res = std::make_shared<MySQLStatementData>();
+	res->statement = mysql_stmt_init(connaddr);
+	if (!res->statement) {
+		mysqlSetError(DBERR_OUT_OF_MEMORY, "HY001", "Cannot allocate statement handle");
+		return nullptr;
+	}
+
+	int rc = mysql_stmt_prepare(res->statement, query.c_str(), query.size());
+	if (mysqlRetrieveError(rc) != MYSQL_OK) {
+		lib_logger->error("MySQL: Error while preparing statement for cursor {} ({}): {}", cname, last_rc, last_error);
+		return nullptr;
+	}
+
+	res->query = query;
+	_cursor_stmts[cname] = res;
+	return res;
+}
+
 bool DbInterfaceMySQL::is_cursor_from_prepared_statement(std::shared_ptr<ICursor> cursor)
 {
 	std::string squery = cursor->getQuery();
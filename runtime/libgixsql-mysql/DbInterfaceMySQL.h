@@ -59,6 +59,9 @@ struct MySQLStatementData : public IPrivateStatementData
 
 	MYSQL_STMT* statement = nullptr;
 
+	// source query (only for statements cached for cursors)
+	std::string query;
+
 private:
 	void cleanup();
 
@@ -83,6 +86,8 @@ public:
 	virtual int cursor_fetch_one(const std::shared_ptr<ICursor>& crsr, int) override;
 	virtual bool get_resultset_value(ResultSetContextType resultset_context_type, const IResultSetContextData& context, int row, int col, char* bfr, uint64_t bfrlen, uint64_t* value_len, bool *is_db_null) override;
 	virtual bool move_to_first_record(const std::string& stmt_name = "") override;
+	virtual int explain(const std::string& query, const std::vector<CobolVarType>& paramTypes, const std::vector<std_binary_data>& paramValues, const std::vector<unsigned long>& paramLengths, const std::vector<uint32_t>& paramFlags, std::string& plan) override;
+	virtual int cancel() override;
 	virtual uint64_t get_native_features() override;
 	virtual int get_num_rows(const std::shared_ptr<ICursor>& crsr) override;
 	virtual int get_num_fields(const std::shared_ptr<ICursor>& crsr) override;
@@ -91,6 +96,7 @@ public:
 	virtual std::string get_state() override;
 	virtual int prepare(const std::string& stmt_name, const std::string& query) override;
 	virtual int exec_prepared(const std::string& stmt_name, std::vector<CobolVarType> paramTypes, std::vector<std_binary_data>& paramValues, std::vector<unsigned long> paramLengths, const std::vector<uint32_t>& paramFlags) override;
+	virtual int deallocate_prepared(const std::string& stmt_name) override;
 	virtual DbPropertySetResult set_property(DbProperty p, std::variant<bool, int, std::string> v) override;
 
 	virtual bool getSchemas(std::vector<SchemaInfo*>& res) override;
@@ -101,6 +107,7 @@ public:
 private:
 
 	MYSQL* connaddr = nullptr;
+	unsigned long connection_thread_id = 0;
 
 	std::shared_ptr<IDataSourceInfo> data_source_info;
 	std::shared_ptr<IConnectionOptions> connection_opts;
@@ -117,12 +124,14 @@ private:
 
 	std::map<std::string, std::shared_ptr<ICursor>> _declared_cursors;
 	std::map<std::string, std::shared_ptr<MySQLStatementData>> _prepared_stmts;
+	std::map<std::string, std::shared_ptr<MySQLStatementData>> _cursor_stmts;
 
 	int _mysql_exec_params(std::shared_ptr<ICursor>, const std::string& query, const std::vector<CobolVarType>& paramTypes, const std::vector<std_binary_data>& paramValues, const std::vector<unsigned long>& paramLengths, const std::vector<uint32_t>& paramFlags, std::shared_ptr<MySQLStatementData> prep_stmt_data = nullptr);
 	int _mysql_exec(std::shared_ptr<ICursor>, const std::string& query, std::shared_ptr<MySQLStatementData> prep_stmt_data = nullptr);
 
 	bool is_cursor_from_prepared_statement(std::shared_ptr<ICursor> cursor);
 	std::shared_ptr<MySQLStatementData> retrieve_prepared_statement(const std::string& prep_stmt_name);
+	std::shared_ptr<MySQLStatementData> get_cursor_statement(const std::shared_ptr<ICursor>& crsr, const std::string& query);
 
 	// Updatable cursor emulation
 	bool updatable_cursors_emu = false;
@@ -34,10 +34,22 @@ using namespace std;
 
 extern "C" {
 
+#if defined(GIXSQL_STATIC_DRIVER)
+
+	// Linked into libgixsql (see --with-static-drivers), looked up by DbInterfaceFactory
+	IDbInterface *get_dblib_mysql()
+	{
+		return new DbInterfaceMySQL();
+	}
+
+#else
+
 	LIBGIXSQL_API IDbInterface *get_dblib()
 	{
 		IDbInterface *dbi = new DbInterfaceMySQL();
 		return dbi;
 	}
 
+#endif
+
 }
\ No newline at end of file
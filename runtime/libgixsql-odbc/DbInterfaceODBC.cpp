@@ -178,6 +178,7 @@ int DbInterfaceODBC::terminate_connection()
 
 	// same as above
 	_prepared_stmts.clear();
+	_cursor_stmts.clear();
 	_declared_cursors.clear();
 
 	lib_logger->trace(FMT_FILE_FUNC "ODBC: connection termination invoked", __FILE__, __func__);
@@ -315,7 +316,9 @@ int DbInterfaceODBC::exec_prepared(const std::string& _stmt_name, std::vector<Co
 		}
 	}
 
+	running_statement = wk_rs->statement;
 	rc = SQLExecute(wk_rs->statement);
+	running_statement = nullptr;
 	if (odbcRetrieveError(rc, ErrorSource::Statement, wk_rs->statement) != SQL_SUCCESS) {
 		return DBERR_SQL_ERROR;
 	}
@@ -323,6 +326,25 @@ int DbInterfaceODBC::exec_prepared(const std::string& _stmt_name, std::vector<Co
 	return DBERR_NO_ERROR;
 }
 
+int DbInterfaceODBC::deallocate_prepared(const std::string& _stmt_name)
+{
+	std::string stmt_name = to_lower(_stmt_name);
+
+	lib_logger->trace(FMT_FILE_FUNC "statement name: {}", __FILE__, __func__, stmt_name);
+
+	auto it = _prepared_stmts.find(stmt_name);
+	if (it == _prepared_stmts.end()) {
+		odbcSetError(DBERR_SQL_ERROR, "26000", "Invalid prepared statement name: " + stmt_name);
+		return DBERR_SQL_ERROR;
+	}
+
+	// the statement handle is freed when the last reference to it (e.g. from an open cursor) is released
+	_prepared_stmts.erase(it);
+
+	odbcClearError();
+	return DBERR_NO_ERROR;
+}
+
 DbPropertySetResult DbInterfaceODBC::set_property(DbProperty p, std::variant<bool, int, std::string> v)
 {
 	return DbPropertySetResult::Unsupported;
@@ -366,7 +388,9 @@ int DbInterfaceODBC::_odbc_exec(std::shared_ptr<ICursor> crsr, const std::string
 		wk_rs = prep_stmt_data;	// Already prepared
 	}
 
+	running_statement = wk_rs->statement;
 	rc = SQLExecute(wk_rs->statement);
+	running_statement = nullptr;
 	if (odbcRetrieveError(rc, ErrorSource::Statement, wk_rs->statement) != SQL_SUCCESS) {
 		return DBERR_SQL_ERROR;
 	}
@@ -492,7 +516,9 @@ int DbInterfaceODBC::_odbc_exec_params(std::shared_ptr<ICursor> crsr, const std:
 		}
 	}
 
+	running_statement = wk_rs->statement;
 	rc = SQLExecute(wk_rs->statement);
+	running_statement = nullptr;
 	if (odbcRetrieveError(rc, ErrorSource::Statement, wk_rs->statement) != SQL_SUCCESS) {
 		lib_logger->error("ODBC: Error while executing statement ({}): {}", last_rc, last_error);
 		return DBERR_SQL_ERROR;
@@ -525,6 +551,39 @@ int DbInterfaceODBC::_odbc_exec_params(std::shared_ptr<ICursor> crsr, const std:
 	}
 }
 
+std::shared_ptr<ODBCStatementData> DbInterfaceODBC::get_cursor_statement(const std::shared_ptr<ICursor>& crsr, const std::string& query)
+{
+	std::string cname = crsr->getName();
+	auto it = _cursor_stmts.find(cname);
+	if (it != _cursor_stmts.end()) {
+		if (it->second->query == query) {
+			lib_logger->trace(FMT_FILE_FUNC "ODBC: reusing statement for cursor {}", __FILE__, __func__, cname);
+			return it->second;
+		}
+		_cursor_stmts.erase(it);
+	}
+
+	std::shared_ptr<ODBCStatementData> res = std::make_shared<ODBCStatementData>(conn_handle);
+	if (!res->statement)
+		return nullptr;
+
+	int rc = SQLSetCursorName(res->statement, (SQLCHAR*)cname.c_str(), SQL_NTS);
+	if (odbcRetrieveError(rc, ErrorSource::Statement, res->statement) != SQL_SUCCESS) {
+		lib_logger->error("ODBC: Error while setting cursor name ({}) {}", last_rc, cname);
+		return nullptr;
+	}
+
+	rc = SQLPrepare(res->statement, (SQLCHAR*)query.c_str(), SQL_NTS);
+	if (odbcRetrieveError(rc, ErrorSource::Statement, res->statement) != SQL_SUCCESS) {
+		lib_logger->error("ODBC: Error while preparing statement for cursor {} ({}): {}", cname, last_rc, last_error);
+		return nullptr;
+	}
+
+	res->query = query;
+	_cursor_stmts[cname] = res;
+	return res;
+}
+
 bool DbInterfaceODBC::is_cursor_from_prepared_statement(const std::shared_ptr<ICursor>& cursor)
 {
 	std::string squery = cursor->getQuery();
@@ -559,8 +618,13 @@ int DbInterfaceODBC::cursor_close(const std::shared_ptr<ICursor>& cursor)
 
 		SQLHANDLE cursor_handle = dp->statement;
 
+		// Statements cached for the cursor are kept for the next OPEN
+		auto it = _cursor_stmts.find(cursor->getName());
+		bool is_cached = (it != _cursor_stmts.end() && it->second == dp);
+
 		int rc = SQLCloseCursor(cursor_handle);
-		dp->statement = nullptr;
+		if (!is_cached)
+			dp->statement = nullptr;
 		if (odbcRetrieveError(rc, ErrorSource::Statement, cursor_handle) != SQL_SUCCESS) {
 			lib_logger->error("ODBC: Error while closing cursor ({}) {}", last_rc, cursor->getName());
 			return DBERR_CLOSE_CURSOR_FAILED;
@@ -645,6 +709,12 @@ int DbInterfaceODBC::cursor_open(const std::shared_ptr<ICursor>& cursor)
 		return DBERR_OPEN_CURSOR_FAILED;
 	}
 
+	if (!prepared_stmt_data) {
+		prepared_stmt_data = get_cursor_statement(cursor, squery);
+		if (!prepared_stmt_data)
+			return DBERR_OPEN_CURSOR_FAILED;
+	}
+
 	if (cursor->getNumParams() > 0) {
 		std::vector<std_binary_data> param_values = cursor->getParameterValues();
 		std::vector<CobolVarType> param_types = cursor->getParameterTypes();
@@ -680,7 +750,9 @@ int DbInterfaceODBC::cursor_fetch_one(const std::shared_ptr<ICursor>& cursor, in
 	if (!dp || !dp->statement)
 		return DBERR_FETCH_ROW_FAILED;
 
+	running_statement = dp->statement;
 	int rc = SQLFetch(dp->statement);
+	running_statement = nullptr;
 	if (rc == SQL_NO_DATA)
 		return DBERR_NO_DATA;
 
@@ -773,6 +845,22 @@ bool DbInterfaceODBC::get_resultset_value(ResultSetContextType resultset_context
 	return true;
 }
 
+int DbInterfaceODBC::cancel()
+{
+	SQLHANDLE h = running_statement;
+	if (!h)
+		return DBERR_NO_ERROR;
+
+	// the running SQLExecute/SQLFetch returns SQL_ERROR with SQLSTATE HY008 (operation canceled)
+	SQLRETURN rc = SQLCancel(h);
+	if (!SQL_SUCCEEDED(rc)) {
+		lib_logger->error("ODBC: cannot cancel the statement ({})", rc);
+		return DBERR_SQL_ERROR;
+	}
+
+	return DBERR_NO_ERROR;
+}
+
 bool DbInterfaceODBC::move_to_first_record(const std::string& _stmt_name)
 {
 	std::shared_ptr<ODBCStatementData> dp;
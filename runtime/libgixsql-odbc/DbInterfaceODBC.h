@@ -26,6 +26,7 @@
 #include <vector>
 #include <map>
 #include <memory>
+#include <atomic>
 
 #if defined(_WIN32) || defined(_WIN64)
 
@@ -64,6 +65,9 @@ struct ODBCStatementData : public IPrivateStatementData {
 	void resizeColumnData(int n);
 
 	SQLHANDLE statement = nullptr;
+
+	// source query (only for statements cached for cursors)
+	std::string query;
 };
 
 class DbInterfaceODBC : public IDbInterface, public IDbManagerInterface
@@ -84,6 +88,7 @@ public:
 	virtual int cursor_fetch_one(const std::shared_ptr<ICursor>& crsr, int) override;
 	virtual bool get_resultset_value(ResultSetContextType resultset_context_type, const IResultSetContextData& context, int row, int col, char* bfr, uint64_t bfrlen, uint64_t* value_len, bool *is_db_null) override;
 	virtual bool move_to_first_record(const std::string& stmt_name = "") override;
+	virtual int cancel() override;
 	virtual uint64_t get_native_features() override;
 	virtual int get_num_rows(const std::shared_ptr<ICursor>& crsr) override;
 	virtual int get_num_fields(const std::shared_ptr<ICursor>& crsr) override;
@@ -92,6 +97,7 @@ public:
 	virtual std::string get_state() override;
 	virtual int prepare(const std::string& stmt_name, const std::string& query) override;
 	virtual int exec_prepared(const std::string& stmt_name, std::vector<CobolVarType> paramTypes, std::vector<std_binary_data>& paramValues, std::vector<unsigned long> paramLengths, const std::vector<uint32_t>& paramFlags) override;
+	virtual int deallocate_prepared(const std::string& stmt_name) override;
 	virtual DbPropertySetResult set_property(DbProperty p, std::variant<bool, int, std::string> v) override;
 
 
@@ -114,6 +120,9 @@ private:
 
 	SQLHANDLE conn_handle = nullptr;
 
+	// the statement handle cancel() applies to, only set during SQLExecute/SQLFetch
+	std::atomic<SQLHANDLE> running_statement{ nullptr };
+
 	std::shared_ptr<ODBCStatementData> current_statement_data;
 
 	int last_rc = 0;
@@ -122,6 +131,7 @@ private:
 
 	std::map<std::string, std::shared_ptr<ICursor>> _declared_cursors;
 	std::map<std::string, std::shared_ptr<ODBCStatementData>> _prepared_stmts;
+	std::map<std::string, std::shared_ptr<ODBCStatementData>> _cursor_stmts;
 
 	int odbcRetrieveError(int rc, ErrorSource err_src, SQLHANDLE h = 0);
 	void odbcClearError();
@@ -133,6 +143,7 @@ private:
 	int get_affected_rows(std::shared_ptr<ODBCStatementData> d);
 	bool is_cursor_from_prepared_statement(const std::shared_ptr<ICursor>& cursor);
 	std::shared_ptr<ODBCStatementData> retrieve_prepared_statement(const std::string& prep_stmt_name);
+	std::shared_ptr<ODBCStatementData> get_cursor_statement(const std::shared_ptr<ICursor>& crsr, const std::string& query);
 	bool column_is_binary(SQLHANDLE stmt, int col_index, bool* is_binary);
 };
 
@@ -32,10 +32,22 @@
 
 extern "C" {
 
+#if defined(GIXSQL_STATIC_DRIVER)
+
+	// Linked into libgixsql (see --with-static-drivers), looked up by DbInterfaceFactory
+	IDbInterface *get_dblib_odbc()
+	{
+		return new DbInterfaceODBC();
+	}
+
+#else
+
 	LIBGIXSQL_API IDbInterface *get_dblib()
 	{
 		IDbInterface *dbi = new DbInterfaceODBC();
 		return dbi;
 	}
 
+#endif
+
 }
\ No newline at end of file
@@ -22,12 +22,14 @@ USA.
 
 #include <cobol_var_flags.h>
 #include <cstring>
+#include <algorithm>
 #include "IConnection.h"
 #include "Logger.h"
 #include "utils.h"
 //#include "varlen_defs.h"
 
 #define DEFAULT_CURSOR_ARRAYSIZE	100
+#define DEFAULT_LOB_READ_SIZE		(64 * 1024)
 
 dpiContext* DbInterfaceOracle::odpi_global_context = nullptr;
 int DbInterfaceOracle::odpi_global_context_usage_count = 0;
@@ -156,6 +158,9 @@ int DbInterfaceOracle::reset()
 int DbInterfaceOracle::terminate_connection()
 {
 	lib_logger->trace(FMT_FILE_FUNC "ODPI::terminate_connection", __FILE__, __func__);
+
+	_cursor_stmts.clear();
+
 	if (connaddr) {
 		dpiConn_close(connaddr, DPI_MODE_CONN_CLOSE_DROP, nullptr, 0);
 		dpiConn_release(connaddr);
@@ -363,6 +368,25 @@ int DbInterfaceOracle::exec_prepared(const std::string& _stmt_name, std::vector<
 	return DBERR_NO_ERROR;
 }
 
+int DbInterfaceOracle::deallocate_prepared(const std::string& _stmt_name)
+{
+	std::string stmt_name = to_lower(_stmt_name);
+
+	lib_logger->trace(FMT_FILE_FUNC "statement name: {}", __FILE__, __func__, stmt_name);
+
+	auto it = _prepared_stmts.find(stmt_name);
+	if (it == _prepared_stmts.end()) {
+		dpiSetError(DBERR_SQL_ERROR, "26000", "Invalid prepared statement name: " + stmt_name);
+		return DBERR_SQL_ERROR;
+	}
+
+	// the statement is released when the last reference to it (e.g. from an open cursor) is released
+	_prepared_stmts.erase(it);
+
+	dpiClearError();
+	return DBERR_NO_ERROR;
+}
+
 DbPropertySetResult DbInterfaceOracle::set_property(DbProperty p, std::variant<bool, int, std::string> v)
 {
 	return DbPropertySetResult::Unsupported;
@@ -440,7 +464,7 @@ int DbInterfaceOracle::_odpi_exec(std::shared_ptr<ICursor> crsr, const std::stri
 
 		// Since Oracle automatically starts a new transaction on the first statement after a COMMIT/ROLLBACK
 		// we only need to issue a manual COMMIT after a statement has been successfully executed
-		if (connection_opts->autocommit == AutoCommitMode::On && !is_tx_termination_statement(query)) {
+		if (connection_opts->autocommit == AutoCommitMode::On && !(STMT_IS_CLASSIFIED(stmt_flags) ? STMT_IS_TX_TERMINATION(stmt_flags) : is_tx_termination_statement(query))) {
 
 			// the statement was not a COMMIT/ROLLBACK, so we issue a COMMIT
 			lib_logger->trace(FMT_FILE_FUNC "autocommit mode is enabled, trying to commit", __FILE__, __func__);
@@ -613,6 +637,30 @@ int DbInterfaceOracle::_odpi_exec_params(std::shared_ptr<ICursor> crsr, const st
 	}
 }
 
+std::shared_ptr<OdpiStatementData> DbInterfaceOracle::get_cursor_statement(const std::shared_ptr<ICursor>& crsr, const std::string& query)
+{
+	std::string cname = crsr->getName();
+	auto it = _cursor_stmts.find(cname);
+	if (it != _cursor_stmts.end()) {
+		if (it->second->query == query) {
+			lib_logger->trace(FMT_FILE_FUNC "ODPI::reusing statement for cursor {}", __FILE__, __func__, cname);
+			return it->second;
+		}
+		_cursor_stmts.erase(it);
+	}
+
+	std::shared_ptr<OdpiStatementData> res = std::make_shared<OdpiStatementData>();
+	int rc = dpiConn_prepareStmt(connaddr, 0, query.c_str(), query.size(), NULL, 0, &res->statement);
+	if (dpiRetrieveError(rc) != DPI_SUCCESS) {
+		lib_logger->error("ODPI: Error while preparing statement for cursor {} ({}): {}", cname, last_rc, last_error);
+		return nullptr;
+	}
+
+	res->query = query;
+	_cursor_stmts[cname] = res;
+	return res;
+}
+
 bool DbInterfaceOracle::is_cursor_from_prepared_statement(const std::shared_ptr<ICursor>& cursor)
 {
 	std::string squery = cursor->getQuery();
@@ -644,6 +692,13 @@ int DbInterfaceOracle::cursor_close(const std::shared_ptr<ICursor>& cursor)
 		if (!dp || !dp->statement)
 			return DBERR_CLOSE_CURSOR_FAILED;
 
+		// Statements cached for the cursor are kept for the next OPEN
+		auto it = _cursor_stmts.find(cursor->getName());
+		if (it != _cursor_stmts.end() && it->second == dp) {
+			cursor->setPrivateData(nullptr);
+			return DBERR_NO_ERROR;
+		}
+
 		int rc = dpiStmt_release(dp->statement);
 		dp->statement = nullptr;
 		if (dpiRetrieveError(rc) != DPI_SUCCESS) {
@@ -704,6 +759,12 @@ int DbInterfaceOracle::cursor_open(const std::shared_ptr<ICursor>& cursor)
 		return DBERR_OPEN_CURSOR_FAILED;
 	}
 
+	if (!prepared_stmt_data) {
+		prepared_stmt_data = get_cursor_statement(cursor, squery);
+		if (!prepared_stmt_data)
+			return DBERR_OPEN_CURSOR_FAILED;
+	}
+
 	if (cursor->getNumParams() > 0) {
 		std::vector<std_binary_data> param_values = cursor->getParameterValues();
 		std::vector<CobolVarType> param_types = cursor->getParameterTypes();
@@ -754,6 +815,16 @@ int DbInterfaceOracle::cursor_fetch_one(const std::shared_ptr<ICursor>& cursor,
 
 bool DbInterfaceOracle::get_resultset_value(ResultSetContextType resultset_context_type, const IResultSetContextData& context, int row, int col, char* bfr, uint64_t bfrlen, uint64_t* value_len, bool
 	* is_db_null)
+{
+	return _odpi_get_resultset_value(resultset_context_type, context, row, col, bfr, bfrlen, value_len, is_db_null, false);
+}
+
+bool DbInterfaceOracle::get_resultset_value_direct(ResultSetContextType resultset_context_type, const IResultSetContextData& context, int row, int col, char* bfr, uint64_t bfrlen, uint64_t* value_len, bool* is_db_null)
+{
+	return _odpi_get_resultset_value(resultset_context_type, context, row, col, bfr, bfrlen, value_len, is_db_null, true);
+}
+
+bool DbInterfaceOracle::_odpi_get_resultset_value(ResultSetContextType resultset_context_type, const IResultSetContextData& context, int row, int col, char* bfr, uint64_t bfrlen, uint64_t* value_len, bool* is_db_null, bool truncate)
 {
 	int rc = 0;
 	std::shared_ptr<OdpiStatementData> wk_rs;
@@ -827,8 +898,12 @@ bool DbInterfaceOracle::get_resultset_value(ResultSetContextType resultset_conte
 		l = col_data->value.asBytes.length;
 
 		if (l > bfrlen) {
-			lib_logger->error("ODPI: ERROR: data truncated: needed {} bytes, {} allocated", l, bfrlen);	// was just a warning
-			return false;
+			if (!truncate) {
+				lib_logger->error("ODPI: ERROR: data truncated: needed {} bytes, {} allocated", l, bfrlen);	// was just a warning
+				return false;
+			}
+			lib_logger->warn("ODPI: data truncated: needed {} bytes, {} allocated", l, bfrlen);
+			l = bfrlen;
 		}
 
 		*value_len = l;
@@ -836,36 +911,70 @@ bool DbInterfaceOracle::get_resultset_value(ResultSetContextType resultset_conte
 	}
 	else
 	{
-		uint64_t lobsize = 0;
-		dpiLob* lob = col_data->value.asLOB;
-		rc = dpiLob_getSize(lob, &lobsize);
-		if (dpiRetrieveError(rc) < 0) {
-			lib_logger->error("Invalid column length");
+		if (!_odpi_read_lob(wk_rs, col, col_data->value.asLOB, bfr, bfrlen, value_len, truncate))
 			return false;
-		}
+	}
+
+#ifdef VERBOSE
+	lib_logger->trace(FMT_FILE_FUNC "col: {}, data: {}", __FILE__, __func__, col, std::string(c, l));
+	std::string s = fmt::format("col: {}, data: {}", col, std::string(c, l));
+	fprintf(stderr, "%s\n", s.c_str());
+#endif
+
+
+
+	return true;
+}
 
-		if (lobsize > bfrlen) {
+// LOBs are read in chunks whose size is a multiple of the LOB chunk size, straight into the caller's buffer
+bool DbInterfaceOracle::_odpi_read_lob(std::shared_ptr<OdpiStatementData> wk_rs, int col, dpiLob* lob, char* bfr, uint64_t bfrlen, uint64_t* value_len, bool truncate)
+{
+	uint64_t lobsize = 0;
+	int rc = dpiLob_getSize(lob, &lobsize);
+	if (dpiRetrieveError(rc) < 0) {
+		lib_logger->error("Invalid column length");
+		return false;
+	}
+
+	if (lobsize > bfrlen) {
+		if (!truncate) {
 			lib_logger->error("ODPI: ERROR: data truncated: needed {} bytes, {} allocated", lobsize, bfrlen);	// was just a warning
 			return false;
 		}
+		lib_logger->warn("ODPI: data truncated: needed {} bytes, {} allocated", lobsize, bfrlen);
+		lobsize = bfrlen;
+	}
+
+	// The chunk size does not change for the same column, so we only ask for it once per statement
+	uint32_t chunk_size = (col < wk_rs->lob_chunk_sizes.size()) ? wk_rs->lob_chunk_sizes[col] : 0;
+	if (!chunk_size) {
+		rc = dpiLob_getChunkSize(lob, &chunk_size);
+		if (dpiRetrieveError(rc) < 0 || !chunk_size)
+			chunk_size = DEFAULT_LOB_READ_SIZE;
 
-		rc = dpiLob_readBytes(lob, 1, lobsize, bfr, &bfrlen);
+		if (col < wk_rs->lob_chunk_sizes.size())
+			wk_rs->lob_chunk_sizes[col] = chunk_size;
+	}
+
+	uint64_t read_size = (chunk_size < DEFAULT_LOB_READ_SIZE) ? (DEFAULT_LOB_READ_SIZE / chunk_size) * chunk_size : chunk_size;
+
+	uint64_t pos = 0;
+	while (pos < lobsize) {
+		uint64_t amount = std::min(read_size, lobsize - pos);
+		uint64_t nread = amount;
+		rc = dpiLob_readBytes(lob, pos + 1, amount, bfr + pos, &nread);
 		if (dpiRetrieveError(rc) < 0) {
 			lib_logger->error("Invalid column data");
 			return false;
 		}
 
-		*value_len = lobsize;
-	}
-
-#ifdef VERBOSE
-	lib_logger->trace(FMT_FILE_FUNC "col: {}, data: {}", __FILE__, __func__, col, std::string(c, l));
-	std::string s = fmt::format("col: {}, data: {}", col, std::string(c, l));
-	fprintf(stderr, "%s\n", s.c_str());
-#endif
-
+		if (!nread)
+			break;
 
+		pos += nread;
+	}
 
+	*value_len = pos;
 	return true;
 }
 
@@ -912,9 +1021,23 @@ bool DbInterfaceOracle::move_to_first_record(const std::string& _stmt_name)
 	return true;
 }
 
+int DbInterfaceOracle::cancel()
+{
+	if (!connaddr)
+		return DBERR_CONN_NOT_FOUND;
+
+	// the running call fails with ORA-01013 (user requested cancel of current operation)
+	if (dpiConn_breakExecution(connaddr) != DPI_SUCCESS) {
+		lib_logger->error("Oracle: cannot cancel the statement");
+		return DBERR_SQL_ERROR;
+	}
+
+	return DBERR_NO_ERROR;
+}
+
 uint64_t DbInterfaceOracle::get_native_features()
 {
-	return (uint64_t)DbNativeFeature::ResultSetRowCount;
+	return (uint64_t)DbNativeFeature::ResultSetRowCount | (uint64_t)DbNativeFeature::DirectLobRead;
 }
 
 int DbInterfaceOracle::get_num_rows(const std::shared_ptr<ICursor>& crsr)
@@ -1049,9 +1172,13 @@ void OdpiStatementData::resizeParams(int n)
 
 void OdpiStatementData::resizeColumnData(int n)
 {
+	// the statement may be re-executed (prepared statements, cursors)
+	cleanupColumnData();
+
 	coldata_count = n;
 	this->coldata = new dpiVar * [n]();
 	this->coldata_bfrs = new dpiData * [n]();
+	lob_chunk_sizes.assign(n, 0);
 }
 
 void OdpiStatementData::cleanup()
@@ -1067,6 +1194,21 @@ void OdpiStatementData::cleanup()
 		params = nullptr;
 	}
 
+	if (params_bfrs) {
+		for (int i = 0; i < params_count; i++) {
+			params_bfrs[i] = nullptr;
+		}
+		delete[] params_bfrs;
+		params_bfrs = nullptr;
+	}
+
+	params_count = 0;
+
+	cleanupColumnData();
+}
+
+void OdpiStatementData::cleanupColumnData()
+{
 	if (coldata) {
 		for (int i = 0; i < coldata_count; i++) {
 			if (coldata[i]) {
@@ -1078,14 +1220,6 @@ void OdpiStatementData::cleanup()
 		coldata = nullptr;
 	}
 
-	if (params_bfrs) {
-		for (int i = 0; i < params_count; i++) {
-			params_bfrs[i] = nullptr;
-		}
-		delete[] params_bfrs;
-		params_bfrs = nullptr;
-	}
-
 	if (coldata_bfrs) {
 		for (int i = 0; i < coldata_count; i++) {
 			coldata_bfrs[i] = nullptr;
@@ -1094,7 +1228,8 @@ void OdpiStatementData::cleanup()
 		coldata_bfrs = nullptr;
 	}
 
-	params_count = 0;
+	lob_chunk_sizes.clear();
+
 	coldata_count = 0;
 }
 
@@ -60,8 +60,15 @@ struct OdpiStatementData : public IPrivateStatementData {
 	int params_count = 0;
 	int coldata_count = 0;
 
+	// LOB chunk size for each column (0 = not yet retrieved)
+	std::vector<uint32_t> lob_chunk_sizes;
+
+	// source query (only for statements cached for cursors)
+	std::string query;
+
 private:
 	void cleanup();
+	void cleanupColumnData();
 };
 
 class DbInterfaceOracle : public IDbInterface, public IDbManagerInterface
@@ -81,7 +88,9 @@ public:
 	virtual int cursor_close(const std::shared_ptr<ICursor>& crsr) override;
 	virtual int cursor_fetch_one(const std::shared_ptr<ICursor>& crsr, int) override;
 	virtual bool get_resultset_value(ResultSetContextType resultset_context_type, const IResultSetContextData& context, int row, int col, char* bfr, uint64_t bfrlen, uint64_t* value_len, bool *is_db_null) override;
+	virtual bool get_resultset_value_direct(ResultSetContextType resultset_context_type, const IResultSetContextData& context, int row, int col, char* bfr, uint64_t bfrlen, uint64_t* value_len, bool* is_db_null) override;
 	virtual bool move_to_first_record(const std::string& stmt_name = "") override;
+	virtual int cancel() override;
 	virtual uint64_t get_native_features() override;
 	virtual int get_num_rows(const std::shared_ptr<ICursor>& crsr) override;
 	virtual int get_num_fields(const std::shared_ptr<ICursor>& crsr) override;
@@ -90,6 +99,7 @@ public:
 	virtual std::string get_state() override;
 	virtual int prepare(const std::string& stmt_name, const std::string& query) override;
 	virtual int exec_prepared(const std::string& stmt_name, std::vector<CobolVarType> paramTypes, std::vector<std_binary_data>& paramValues, std::vector<unsigned long> paramLengths, const std::vector<uint32_t>& paramFlags) override;
+	virtual int deallocate_prepared(const std::string& stmt_name) override;
 	virtual DbPropertySetResult set_property(DbProperty p, std::variant<bool, int, std::string> v) override;
 
 
@@ -116,6 +126,7 @@ private:
 
 	std::map<std::string, std::shared_ptr<ICursor>> _declared_cursors;
 	std::map<std::string, std::shared_ptr<OdpiStatementData>> _prepared_stmts;
+	std::map<std::string, std::shared_ptr<OdpiStatementData>> _cursor_stmts;
 
 	int decode_binary = DECODE_BINARY_DEFAULT;
 
@@ -130,7 +141,11 @@ private:
 
 	int _odpi_get_num_rows(dpiStmt *r);
 
+	bool _odpi_get_resultset_value(ResultSetContextType resultset_context_type, const IResultSetContextData& context, int row, int col, char* bfr, uint64_t bfrlen, uint64_t* value_len, bool* is_db_null, bool truncate);
+	bool _odpi_read_lob(std::shared_ptr<OdpiStatementData> wk_rs, int col, dpiLob* lob, char* bfr, uint64_t bfrlen, uint64_t* value_len, bool truncate);
+
 	std::shared_ptr<OdpiStatementData> retrieve_prepared_statement(const std::string& prep_stmt_name);
+	std::shared_ptr<OdpiStatementData> get_cursor_statement(const std::shared_ptr<ICursor>& crsr, const std::string& query);
 	bool is_cursor_from_prepared_statement(const std::shared_ptr<ICursor>& cursor);
 };
 
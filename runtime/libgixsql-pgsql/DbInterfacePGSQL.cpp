@@ -107,6 +107,9 @@ DbInterfacePGSQL::DbInterfacePGSQL()
 
 DbInterfacePGSQL::~DbInterfacePGSQL()
 {
+	if (cancel_handle)
+		PQfreeCancel(cancel_handle);
+
 	if (connaddr)
 		PQfinish(connaddr);
 }
@@ -268,6 +271,9 @@ int DbInterfacePGSQL::connect(std::shared_ptr<IDataSourceInfo> _conn_info, std::
 
 	connaddr = conn;
 
+	// created here because PQgetCancel cannot be called while the connection is in use
+	cancel_handle = PQgetCancel(conn);
+
 	this->connection_opts = _conn_opts;
 	this->data_source_info = _conn_info;
 
@@ -285,12 +291,20 @@ int DbInterfacePGSQL::reset()
 
 int DbInterfacePGSQL::terminate_connection()
 {
+	if (cancel_handle) {
+		PQfreeCancel(cancel_handle);
+		cancel_handle = nullptr;
+	}
+
 	if (connaddr) {
 		PQfinish(connaddr);
 		connaddr = NULL;
 	}
 
 	current_resultset_data.reset();
+	_static_stmts.clear();
+	_prepared_stmts.clear();
+	_prepared_stmt_sources.clear();
 
 	return DBERR_NO_ERROR;
 }
@@ -329,6 +343,7 @@ int DbInterfacePGSQL::prepare(const std::string& _stmt_name, const std::string&
 	}
 
 	_prepared_stmts[stmt_name] = nullptr;	// for now we just track it, the actual result will be stored later
+	_prepared_stmt_sources[stmt_name] = prepared_sql;
 
 	return DBERR_NO_ERROR;
 }
@@ -398,6 +413,36 @@ int DbInterfacePGSQL::exec_prepared(const std::string& _stmt_name, std::vector<C
 	}
 }
 
+int DbInterfacePGSQL::deallocate_prepared(const std::string& _stmt_name)
+{
+	std::string stmt_name = to_lower(_stmt_name);
+
+	lib_logger->trace(FMT_FILE_FUNC "statement name: {}", __FILE__, __func__, stmt_name);
+
+	if (_prepared_stmts.find(stmt_name) == _prepared_stmts.end()) {
+		pgsqlSetError(DBERR_SQL_ERROR, "26000", "Invalid prepared statement name: " + stmt_name);
+		return DBERR_SQL_ERROR;
+	}
+
+	std::string qry = "DEALLOCATE \"" + stmt_name + "\"";
+	PGresultPtr res(PQexec(connaddr, qry.c_str()));
+
+	last_rc = PQresultStatus(res.get());
+	last_error = PQresultErrorMessage(res.get());
+	last_state = pg_get_sqlstate(res.get());
+
+	if (last_rc != PGRES_COMMAND_OK) {
+		lib_logger->error("Cannot deallocate prepared statement {}: {}", stmt_name, last_error);
+		last_rc = -(10000 + last_rc);
+		return DBERR_SQL_ERROR;
+	}
+
+	_prepared_stmts.erase(stmt_name);
+	_prepared_stmt_sources.erase(stmt_name);
+
+	return DBERR_NO_ERROR;
+}
+
 DbPropertySetResult DbInterfacePGSQL::set_property(DbProperty p, std::variant<bool, int, std::string> v)
 {
 	return DbPropertySetResult::Unsupported;
@@ -420,14 +465,18 @@ int DbInterfacePGSQL::_pgsql_exec(const std::shared_ptr<ICursor>& crsr, const st
 	}
 
 	wk_rs = std::make_shared<PGResultSetData>();
-	wk_rs->resultset = PQexecParams(connaddr, query.c_str(), 0, NULL, NULL, NULL, NULL, 0);
+	auto it_static = crsr ? _static_stmts.end() : _static_stmts.find(query);
+	if (it_static != _static_stmts.end())
+		wk_rs->resultset = PQexecPrepared(connaddr, it_static->second.c_str(), 0, NULL, NULL, NULL, 0);
+	else
+		wk_rs->resultset = PQexecParams(connaddr, query.c_str(), 0, NULL, NULL, NULL, NULL, 0);
 
 	last_rc = PQresultStatus(wk_rs->resultset);
 	last_error = PQresultErrorMessage(wk_rs->resultset);
 	last_state = pg_get_sqlstate(wk_rs->resultset);
 
 	// we trap COMMIT/ROLLBACK
-	if (connection_opts->autocommit == AutoCommitMode::Off && is_tx_termination_statement(query)) {
+	if (connection_opts->autocommit == AutoCommitMode::Off && (STMT_IS_CLASSIFIED(stmt_flags) ? STMT_IS_TX_TERMINATION(stmt_flags) : is_tx_termination_statement(query))) {
 		
 		// we clean up: whether the COMMIT/ROLLBACK failed or not this is probably useless anyway
 		current_resultset_data.reset();
@@ -446,7 +495,7 @@ int DbInterfacePGSQL::_pgsql_exec(const std::shared_ptr<ICursor>& crsr, const st
 	}
 
 	if (last_rc == PGRES_COMMAND_OK) {
-		if (is_update_or_delete_statement(query)) {
+		if (STMT_IS_CLASSIFIED(stmt_flags) ? STMT_IS_UPDATE_OR_DELETE(stmt_flags) : is_update_or_delete_statement(query)) {
 			int nrows = get_num_rows(wk_rs->resultset);
 			if (nrows <= 0) {
 				last_rc = 100;
@@ -515,7 +564,11 @@ int DbInterfacePGSQL::_pgsql_exec_params(const std::shared_ptr<ICursor>& crsr, c
 	}
 
 	wk_rs = std::make_shared<PGResultSetData>();
-	wk_rs->resultset = PQexecParams(connaddr, query.c_str(), paramValues.size(), param_types.get(), param_vals->data(), param_lengths.get(), param_formats.get(), 0);
+	auto it_static = crsr ? _static_stmts.end() : _static_stmts.find(query);
+	if (it_static != _static_stmts.end())
+		wk_rs->resultset = PQexecPrepared(connaddr, it_static->second.c_str(), paramValues.size(), param_vals->data(), param_lengths.get(), param_formats.get(), 0);
+	else
+		wk_rs->resultset = PQexecParams(connaddr, query.c_str(), paramValues.size(), param_types.get(), param_vals->data(), param_lengths.get(), param_formats.get(), 0);
 	wk_rs->num_rows = get_num_rows(wk_rs->resultset);
 
 	last_rc = PQresultStatus(wk_rs->resultset);
@@ -523,7 +576,7 @@ int DbInterfacePGSQL::_pgsql_exec_params(const std::shared_ptr<ICursor>& crsr, c
 	last_state = pg_get_sqlstate(wk_rs->resultset);
 
 	// we trap COMMIT/ROLLBACK
-	if (connection_opts->autocommit == AutoCommitMode::Off && is_tx_termination_statement(query)) {
+	if (connection_opts->autocommit == AutoCommitMode::Off && (STMT_IS_CLASSIFIED(stmt_flags) ? STMT_IS_TX_TERMINATION(stmt_flags) : is_tx_termination_statement(query))) {
 
 		// we clean up: if the COMMIT/ROLLBACK failed this is probably useless anyway
 		current_resultset_data.reset();
@@ -542,7 +595,7 @@ int DbInterfacePGSQL::_pgsql_exec_params(const std::shared_ptr<ICursor>& crsr, c
 	}
 
 	if (last_rc == PGRES_COMMAND_OK) {
-		if (is_update_or_delete_statement(query)) {
+		if (STMT_IS_CLASSIFIED(stmt_flags) ? STMT_IS_UPDATE_OR_DELETE(stmt_flags) : is_update_or_delete_statement(query)) {
 			if (wk_rs->num_rows <= 0) {
 				last_rc = 100;
 				return DBERR_SQL_ERROR;
@@ -826,9 +879,177 @@ bool DbInterfacePGSQL::move_to_first_record(const std::string& _stmt_name)
 	return true;
 }
 
+int DbInterfacePGSQL::prepare_static(const std::vector<StaticStatementInfo>& stmts, std::vector<int>& results)
+{
+	std::vector<std::string> names(stmts.size());
+	std::vector<std::unique_ptr<Oid[]>> types(stmts.size());
+	std::vector<int> pending;
+
+	results.assign(stmts.size(), DBERR_NO_ERROR);
+
+	for (int i = 0; i < stmts.size(); i++) {
+		if (_static_stmts.find(stmts[i].query) != _static_stmts.end())
+			continue;
+
+		names[i] = "gixsql_st_" + std::to_string(++static_stmt_count);
+		types[i] = std::make_unique<Oid[]>(stmts[i].param_types.size());
+		for (int j = 0; j < stmts[i].param_types.size(); j++)
+			types[i][j] = get_pgsql_type(stmts[i].param_types.at(j), stmts[i].param_flags.at(j));
+
+		pending.push_back(i);
+	}
+
+	if (pending.empty())
+		return DBERR_NO_ERROR;
+
+	// A failed PREPARE would abort the current transaction (autocommit off)
+	bool in_tx = PQtransactionStatus(connaddr) == PQTRANS_INTRANS;
+	if (in_tx)
+		PQclear(PQexec(connaddr, "SAVEPOINT gixsql_static"));
+
+	bool has_errors = false;
+	std::vector<int> retry;
+
+#if defined(LIBPQ_HAS_PIPELINING)
+	// Statements are sent in a single round trip, those following an error are aborted and retried below
+	if (pending.size() > 1 && PQenterPipelineMode(connaddr)) {
+		std::vector<int> sent;
+		for (int i : pending) {
+			if (PQsendPrepare(connaddr, names[i].c_str(), stmts[i].query.c_str(), stmts[i].param_types.size(), types[i].get()))
+				sent.push_back(i);
+			else
+				retry.push_back(i);
+		}
+		PQpipelineSync(connaddr);
+
+		for (int i : sent) {
+			PGresult* r = PQgetResult(connaddr);
+			int st = PQresultStatus(r);
+			if (st == PGRES_COMMAND_OK) {
+				_static_stmts[stmts[i].query] = names[i];
+			}
+			else if (st == PGRES_PIPELINE_ABORTED) {
+				retry.push_back(i);
+			}
+			else {
+				lib_logger->error("PGSQL: cannot prepare static statement ({}): {} - {}", pg_get_sqlstate(r), PQresultErrorMessage(r), stmts[i].query);
+				results[i] = DBERR_PREPARE_FAILED;
+				has_errors = true;
+			}
+			PQclear(r);
+
+			// each command's results are terminated by a null pointer
+			while ((r = PQgetResult(connaddr)) != nullptr)
+				PQclear(r);
+		}
+
+		PGresult* r;
+		while ((r = PQgetResult(connaddr)) != nullptr) {
+			bool is_sync = PQresultStatus(r) == PGRES_PIPELINE_SYNC;
+			PQclear(r);
+			if (is_sync)
+				break;
+		}
+		PQexitPipelineMode(connaddr);
+
+		if (has_errors && in_tx)
+			PQclear(PQexec(connaddr, "ROLLBACK TO SAVEPOINT gixsql_static"));
+	}
+	else
+		retry = pending;
+#else
+	retry = pending;
+#endif
+
+	for (int i : retry) {
+		PGresult* r = PQprepare(connaddr, names[i].c_str(), stmts[i].query.c_str(), stmts[i].param_types.size(), types[i].get());
+		if (PQresultStatus(r) == PGRES_COMMAND_OK) {
+			_static_stmts[stmts[i].query] = names[i];
+		}
+		else {
+			lib_logger->error("PGSQL: cannot prepare static statement ({}): {} - {}", pg_get_sqlstate(r), PQresultErrorMessage(r), stmts[i].query);
+			results[i] = DBERR_PREPARE_FAILED;
+			has_errors = true;
+			if (in_tx)
+				PQclear(PQexec(connaddr, "ROLLBACK TO SAVEPOINT gixsql_static"));
+		}
+		PQclear(r);
+	}
+
+	if (in_tx)
+		PQclear(PQexec(connaddr, "RELEASE SAVEPOINT gixsql_static"));
+
+	return has_errors ? DBERR_PREPARE_FAILED : DBERR_NO_ERROR;
+}
+
+int DbInterfacePGSQL::explain(const std::string& query, const std::vector<CobolVarType>& paramTypes, const std::vector<std_binary_data>& paramValues, const std::vector<unsigned long>& paramLengths, const std::vector<uint32_t>& paramFlags, std::string& plan)
+{
+	if (paramTypes.size() != paramValues.size() || paramTypes.size() != paramFlags.size())
+		return DBERR_INTERNAL_ERR;
+
+	std::unique_ptr<pgsqlParamArray> param_vals = std::make_unique<pgsqlParamArray>(paramValues.size());
+	std::unique_ptr<Oid[]> param_types = std::make_unique<Oid[]>(paramTypes.size());
+	std::unique_ptr<int[]> param_lengths = std::make_unique<int[]>(paramLengths.size());
+	std::unique_ptr<int[]> param_formats = std::make_unique<int[]>(paramFlags.size());
+
+	for (int i = 0; i < paramValues.size(); i++) {
+		if (paramLengths.at(i) != DB_NULL) {
+			param_vals->assign(i, (char*)paramValues[i].data(), paramLengths[i]);
+			param_lengths[i] = paramLengths.at(i);
+		}
+		else {
+			param_vals->assign(i, nullptr, 0);
+			param_lengths[i] = 0;
+		}
+		param_types[i] = get_pgsql_type(paramTypes.at(i), paramFlags[i]);
+		param_formats[i] = CBL_FIELD_IS_BINARY(paramFlags[i]) ? 1 : 0;
+	}
+
+	// an error inside a transaction block would abort it: in that case EXPLAIN is run in a savepoint
+	bool in_tx = PQtransactionStatus(connaddr) == PQTRANS_INTRANS;
+	if (in_tx)
+		PQclear(PQexec(connaddr, "SAVEPOINT gixsql_explain"));
+
+	// errors are only logged: last_rc/last_error still refer to the statement being explained
+	std::string explain_query = "EXPLAIN (FORMAT JSON) " + query;
+	PGresult* r = PQexecParams(connaddr, explain_query.c_str(), paramValues.size(), param_types.get(), param_vals->data(), param_lengths.get(), param_formats.get(), 0);
+
+	int rc = DBERR_NO_ERROR;
+	if (PQresultStatus(r) == PGRES_TUPLES_OK) {
+		plan.clear();
+		for (int i = 0; i < PQntuples(r); i++)
+			plan += PQgetvalue(r, i, 0);
+	}
+	else {
+		lib_logger->error("PGSQL: EXPLAIN failed ({}): {}", pg_get_sqlstate(r), PQresultErrorMessage(r));
+		rc = DBERR_SQL_ERROR;
+	}
+	PQclear(r);
+
+	if (in_tx)
+		PQclear(PQexec(connaddr, rc == DBERR_NO_ERROR ? "RELEASE SAVEPOINT gixsql_explain" : "ROLLBACK TO SAVEPOINT gixsql_explain"));
+
+	return rc;
+}
+
+int DbInterfacePGSQL::cancel()
+{
+	if (!cancel_handle)
+		return DBERR_CONN_NOT_FOUND;
+
+	// the server cancels the running statement (if any), which then fails with SQLSTATE 57014
+	char errbuf[256];
+	if (!PQcancel(cancel_handle, errbuf, sizeof(errbuf))) {
+		lib_logger->error("PGSQL: cancel request failed: {}", errbuf);
+		return DBERR_SQL_ERROR;
+	}
+
+	return DBERR_NO_ERROR;
+}
+
 uint64_t DbInterfacePGSQL::get_native_features()
 {
-	return (uint64_t)DbNativeFeature::ResultSetRowCount;
+	return (uint64_t)DbNativeFeature::ResultSetRowCount | (uint64_t)DbNativeFeature::StaticStatementCache;
 }
 
 int DbInterfacePGSQL::get_num_rows(const std::shared_ptr<ICursor>& crsr)
@@ -1014,6 +1235,14 @@ bool DbInterfacePGSQL::retrieve_prepared_statement_source(const std::string& pre
 {
 	lib_logger->trace(FMT_FILE_FUNC "Retrieving SQL source for prepared statement {}", __FILE__, __func__, prep_stmt_name);
 
+	auto it = _prepared_stmt_sources.find(to_lower(prep_stmt_name));
+	if (it != _prepared_stmt_sources.end()) {
+		src = it->second;
+		return true;
+	}
+
+	// not prepared through this driver (e.g. with a PREPARE statement passed through to the server)
+
 	auto pvals = std::make_unique<char*[]>(1);
 	pvals[0] = (char*)prep_stmt_name.c_str();
 
@@ -68,6 +68,9 @@ public:
 	virtual int cursor_fetch_one(const std::shared_ptr<ICursor>& crsr, int) override;
 	virtual bool get_resultset_value(ResultSetContextType resultset_context_type, const IResultSetContextData& context, int row, int col, char* bfr, uint64_t bfrlen, uint64_t* value_len, bool *is_db_null) override;
 	virtual bool move_to_first_record(const std::string& stmt_name = "") override;
+	virtual int prepare_static(const std::vector<StaticStatementInfo>& stmts, std::vector<int>& results) override;
+	virtual int explain(const std::string& query, const std::vector<CobolVarType>& paramTypes, const std::vector<std_binary_data>& paramValues, const std::vector<unsigned long>& paramLengths, const std::vector<uint32_t>& paramFlags, std::string& plan) override;
+	virtual int cancel() override;
 	virtual uint64_t get_native_features() override;
 	virtual int get_num_rows(const std::shared_ptr<ICursor>& crsr) override;
 	virtual int get_num_fields(const std::shared_ptr<ICursor>& crsr) override;
@@ -76,6 +79,7 @@ public:
 	virtual std::string get_state() override;
 	virtual int prepare(const std::string& stmt_name, const std::string& query) override;
 	virtual int exec_prepared(const std::string& stmt_name, std::vector<CobolVarType> paramTypes, std::vector<std_binary_data>& paramValues, std::vector<unsigned long> paramLengths, const std::vector<uint32_t>& paramFlags) override;
+	virtual int deallocate_prepared(const std::string& stmt_name) override;
 	virtual DbPropertySetResult set_property(DbProperty p, std::variant<bool, int, std::string> v) override;
 
 	virtual bool getSchemas(std::vector<SchemaInfo*>& res) override;
@@ -86,6 +90,7 @@ public:
 private:
 
 	PGconn *connaddr = nullptr;
+	PGcancel *cancel_handle = nullptr;
 
 	std::shared_ptr<IDataSourceInfo> data_source_info;
 	std::shared_ptr<IConnectionOptions> connection_opts;
@@ -99,6 +104,13 @@ private:
 	std::map<std::string, std::shared_ptr<ICursor>> _declared_cursors;
 	std::map<std::string, std::shared_ptr<PGResultSetData>> _prepared_stmts;
 
+	// statement name -> source, avoids a lookup in pg_prepared_statements when a cursor is opened from a prepared statement
+	std::map<std::string, std::string> _prepared_stmt_sources;
+
+	// query text -> server-side statement name
+	std::map<std::string, std::string> _static_stmts;
+	int static_stmt_count = 0;
+
 	int decode_binary = DECODE_BINARY_DEFAULT;
 
 	int _pgsql_exec(const std::shared_ptr<ICursor>& crsr, const std::string& query);
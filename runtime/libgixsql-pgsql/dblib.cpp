@@ -34,6 +34,16 @@ USA.
 
 extern "C" {
 
+#if defined(GIXSQL_STATIC_DRIVER)
+
+	// Linked into libgixsql (see --with-static-drivers), looked up by DbInterfaceFactory
+	IDbInterface *get_dblib_pgsql()
+	{
+		return new DbInterfacePGSQL();
+	}
+
+#else
+
 	LIBGIXSQL_API IDbInterface * get_dblib()
 	{
 		 IDbInterface *dbi = new DbInterfacePGSQL();
@@ -46,5 +56,6 @@ extern "C" {
 		 	delete dbi;
 	}
 
+#endif
 
 }
\ No newline at end of file
@@ -21,6 +21,7 @@ USA.
 #include "DbInterfaceSQLite.h"
 
 #include <cstring>
+#include <map>
 #include "IConnection.h"
 #include "Logger.h"
 #include "utils.h"
@@ -37,8 +38,10 @@ DbInterfaceSQLite::DbInterfaceSQLite()
 
 DbInterfaceSQLite::~DbInterfaceSQLite()
 {
-	if (connaddr)
+	if (connaddr) {
+		group_commit_flush();
 		sqlite3_close_v2(connaddr);
+	}
 }
 
 int DbInterfaceSQLite::init(const GlobalEnv* genv, const std::shared_ptr<spdlog::logger>& _logger)
@@ -113,6 +116,32 @@ int DbInterfaceSQLite::connect(std::shared_ptr<IDataSourceInfo> _conn_info, std:
 	else
 		lib_logger->trace(FMT_FILE_FUNC "SQLite::updatable cursor support is disabled", __FILE__, __func__);
 
+	group_commit_size = 0;
+	group_commit_interval = 0;
+	group_commit_in_tx = false;
+	group_commit_pending = 0;
+
+	if (opts.find("group_commit_size") != opts.end()) {
+		group_commit_size = atoi(opts["group_commit_size"].c_str());
+		if (group_commit_size < 0)
+			group_commit_size = 0;
+	}
+
+	if (opts.find("group_commit_interval") != opts.end()) {
+		group_commit_interval = atoi(opts["group_commit_interval"].c_str());
+		if (group_commit_interval < 0)
+			group_commit_interval = 0;
+	}
+
+	if ((group_commit_size || group_commit_interval) && _conn_opts->autocommit == AutoCommitMode::Off) {
+		lib_logger->warn("SQLite: group commit is only available in autocommit mode, ignoring");
+		group_commit_size = 0;
+		group_commit_interval = 0;
+	}
+
+	if (group_commit_size || group_commit_interval)
+		lib_logger->trace(FMT_FILE_FUNC "SQLite::enabled group commit (statements: {}, interval: {} ms)", __FILE__, __func__, group_commit_size, group_commit_interval);
+
 	connaddr = conn;
 	sqlite3_extended_result_codes(connaddr, 1);
 
@@ -134,7 +163,11 @@ int DbInterfaceSQLite::reset()
 int DbInterfaceSQLite::terminate_connection()
 {
 	spdlog::trace("terminating connection");
+	_cursor_stmts.clear();
+	_static_stmts.clear();
+
 	if (connaddr) {
+		group_commit_flush();
 		sqlite3_close_v2(connaddr);
 		connaddr = nullptr;
 	}
@@ -259,12 +292,38 @@ int DbInterfaceSQLite::exec_prepared(const std::string& _stmt_name, std::vector<
 			return DBERR_SQL_ERROR;
 	}
 
+	if (group_commit_begin(wk_rs->statement) != DBERR_NO_ERROR)
+		return DBERR_SQL_ERROR;
+
 	int step_rc = sqlite3_step(wk_rs->statement);
 	if (step_rc != SQLITE_DONE && step_rc != SQLITE_ROW) {
 		int rc = sqliteRetrieveError(step_rc);
+		group_commit_end(wk_rs->statement, step_rc);
+		return DBERR_SQL_ERROR;
+	}
+
+	if (group_commit_end(wk_rs->statement, step_rc) != DBERR_NO_ERROR)
+		return DBERR_SQL_ERROR;
+
+	return DBERR_NO_ERROR;
+}
+
+int DbInterfaceSQLite::deallocate_prepared(const std::string& _stmt_name)
+{
+	std::string stmt_name = to_lower(_stmt_name);
+
+	lib_logger->trace(FMT_FILE_FUNC "statement name: {}", __FILE__, __func__, stmt_name);
+
+	auto it = _prepared_stmts.find(stmt_name);
+	if (it == _prepared_stmts.end()) {
+		sqliteSetError(DBERR_SQL_ERROR, "26000", "Invalid prepared statement name: " + stmt_name);
 		return DBERR_SQL_ERROR;
 	}
 
+	// the statement is finalized when the last reference to it (e.g. from an open cursor) is released
+	_prepared_stmts.erase(it);
+
+	sqliteClearError();
 	return DBERR_NO_ERROR;
 }
 
@@ -299,13 +358,14 @@ int DbInterfaceSQLite::_sqlite_exec(const std::shared_ptr<ICursor>& crsr, const
 
 		if (wk_rs) {
 			if (wk_rs && wk_rs == current_statement_data) {
+				sqlite3_reset(wk_rs->statement);	// static statements are kept, this releases their locks
 				current_statement_data.reset();
 			}
 		}
 
 		wk_rs = std::make_shared<SQLiteStatementData>();
 
-		if (updatable_cursors_emu && is_update_or_delete_where_current_of(query, table_name, cursor_name, &is_delete)) {
+		if (updatable_cursors_emu && (!STMT_IS_CLASSIFIED(stmt_flags) || STMT_IS_CURRENT_OF(stmt_flags)) && is_update_or_delete_where_current_of(query, table_name, cursor_name, &is_delete)) {
 
 			is_updatable_crsr_stmt = true;
 
@@ -342,8 +402,16 @@ int DbInterfaceSQLite::_sqlite_exec(const std::shared_ptr<ICursor>& crsr, const
 			}
 		}
 		else {
-			wk_rs = std::make_shared<SQLiteStatementData>();
-			rc = sqlite3_prepare_v2(connaddr, query.c_str(), query.size(), &wk_rs->statement, nullptr);
+			auto it = crsr ? _static_stmts.end() : _static_stmts.find(query);
+			if (it != _static_stmts.end()) {
+				wk_rs = it->second;	// prepared in advance
+				sqlite3_reset(wk_rs->statement);
+				sqlite3_clear_bindings(wk_rs->statement);
+			}
+			else {
+				wk_rs = std::make_shared<SQLiteStatementData>();
+				rc = sqlite3_prepare_v2(connaddr, query.c_str(), query.size(), &wk_rs->statement, nullptr);
+			}
 		}
 
 		if (sqliteRetrieveError(rc) != SQLITE_OK) {
@@ -355,10 +423,16 @@ int DbInterfaceSQLite::_sqlite_exec(const std::shared_ptr<ICursor>& crsr, const
 		wk_rs = prep_stmt_data;	// Already prepared
 	}
 
+	if (group_commit_begin(wk_rs->statement) != DBERR_NO_ERROR)
+		return DBERR_SQL_ERROR;
+
 	int step_rc = sqlite3_step(wk_rs->statement);
 
+	if (group_commit_end(wk_rs->statement, step_rc) != DBERR_NO_ERROR)
+		return DBERR_SQL_ERROR;
+
 	// we trap COMMIT/ROLLBACK
-	if (connection_opts->autocommit == AutoCommitMode::Off && is_tx_termination_statement(query)) {
+	if (connection_opts->autocommit == AutoCommitMode::Off && (STMT_IS_CLASSIFIED(stmt_flags) ? STMT_IS_TX_TERMINATION(stmt_flags) : is_tx_termination_statement(query))) {
 
 		// we clean up: if the COMMIT/ROLLBACK failed this is probably useless anyway
 		if (current_statement_data) {
@@ -378,6 +452,7 @@ int DbInterfaceSQLite::_sqlite_exec(const std::shared_ptr<ICursor>& crsr, const
 
 	if (step_rc != SQLITE_DONE && step_rc != SQLITE_ROW) {
 		rc = sqliteRetrieveError(step_rc);
+		recover_from_interrupt(wk_rs->statement, step_rc);
 		return DBERR_SQL_ERROR;
 	}
 
@@ -436,13 +511,14 @@ int DbInterfaceSQLite::_sqlite_exec_params(const std::shared_ptr<ICursor>& crsr,
 
 		if (wk_rs) {
 			if (wk_rs && wk_rs == current_statement_data) {
+				sqlite3_reset(wk_rs->statement);	// static statements are kept, this releases their locks
 				current_statement_data.reset();
 			}
 		}
 
 		wk_rs = std::make_shared<SQLiteStatementData>();
 
-		if (updatable_cursors_emu && is_update_or_delete_where_current_of(query, table_name, cursor_name, &is_delete)) {
+		if (updatable_cursors_emu && (!STMT_IS_CLASSIFIED(stmt_flags) || STMT_IS_CURRENT_OF(stmt_flags)) && is_update_or_delete_where_current_of(query, table_name, cursor_name, &is_delete)) {
 
 			is_updatable_crsr_stmt = true;
 
@@ -472,8 +548,16 @@ int DbInterfaceSQLite::_sqlite_exec_params(const std::shared_ptr<ICursor>& crsr,
 			}
 		}
 		else {
-			wk_rs = std::make_shared<SQLiteStatementData>();
-			rc = sqlite3_prepare_v2(connaddr, query.c_str(), query.size(), &wk_rs->statement, nullptr);
+			auto it = crsr ? _static_stmts.end() : _static_stmts.find(query);
+			if (it != _static_stmts.end()) {
+				wk_rs = it->second;	// prepared in advance
+				sqlite3_reset(wk_rs->statement);
+				sqlite3_clear_bindings(wk_rs->statement);
+			}
+			else {
+				wk_rs = std::make_shared<SQLiteStatementData>();
+				rc = sqlite3_prepare_v2(connaddr, query.c_str(), query.size(), &wk_rs->statement, nullptr);
+			}
 		}
 
 		if (sqliteRetrieveError(rc) != SQLITE_OK) {
@@ -518,10 +602,16 @@ int DbInterfaceSQLite::_sqlite_exec_params(const std::shared_ptr<ICursor>& crsr,
 		}
 	}
 
+	if (group_commit_begin(wk_rs->statement) != DBERR_NO_ERROR)
+		return DBERR_SQL_ERROR;
+
 	int step_rc = sqlite3_step(wk_rs->statement);
 
+	if (group_commit_end(wk_rs->statement, step_rc) != DBERR_NO_ERROR)
+		return DBERR_SQL_ERROR;
+
 	// we trap COMMIT/ROLLBACK
-	if (connection_opts->autocommit == AutoCommitMode::Off && is_tx_termination_statement(query)) {
+	if (connection_opts->autocommit == AutoCommitMode::Off && (STMT_IS_CLASSIFIED(stmt_flags) ? STMT_IS_TX_TERMINATION(stmt_flags) : is_tx_termination_statement(query))) {
 
 		// we clean up: if the COMMIT/ROLLBACK failed this is probably useless anyway
 		if (current_statement_data) {
@@ -541,6 +631,7 @@ int DbInterfaceSQLite::_sqlite_exec_params(const std::shared_ptr<ICursor>& crsr,
 
 	if (step_rc != SQLITE_DONE && step_rc != SQLITE_ROW) {
 		rc = sqliteRetrieveError(step_rc);
+		recover_from_interrupt(wk_rs->statement, step_rc);
 		return DBERR_SQL_ERROR;
 	}
 
@@ -723,12 +814,159 @@ std::vector<std::string> DbInterfaceSQLite::get_resultset_column_names(sqlite3_s
 	return crsr_cols;
 }
 
+bool DbInterfaceSQLite::is_group_commit_enabled()
+{
+	return group_commit_size > 0 || group_commit_interval > 0;
+}
+
+bool DbInterfaceSQLite::is_group_commit_expired()
+{
+	if (!group_commit_interval)
+		return false;
+
+	auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - group_commit_start).count();
+	return elapsed >= group_commit_interval;
+}
+
+// Called before a statement is executed: reads and transaction control statements (both "read-only" for SQLite) 
+// flush the pending writes, writes are added to the current implicit transaction (or start a new one)
+int DbInterfaceSQLite::group_commit_begin(sqlite3_stmt* stmt)
+{
+	if (!is_group_commit_enabled() || !stmt)
+		return DBERR_NO_ERROR;
+
+	bool is_write = !sqlite3_stmt_readonly(stmt);
+
+	if (group_commit_in_tx && (!is_write || is_group_commit_expired())) {
+		if (group_commit_flush() != DBERR_NO_ERROR)
+			return DBERR_SQL_ERROR;
+	}
+
+	if (!is_write || group_commit_in_tx)
+		return DBERR_NO_ERROR;
+
+	// A transaction explicitly started by the program is left alone
+	if (!sqlite3_get_autocommit(connaddr))
+		return DBERR_NO_ERROR;
+
+	int rc = sqlite3_exec(connaddr, "BEGIN TRANSACTION", 0, 0, nullptr);
+	if (sqliteRetrieveError(rc) != SQLITE_OK) {
+		lib_logger->error("SQLite: cannot start group commit transaction: {} ({}): {}", last_rc, last_state, last_error);
+		return DBERR_SQL_ERROR;
+	}
+
+	lib_logger->trace(FMT_FILE_FUNC "SQLite::group commit transaction started", __FILE__, __func__);
+
+	group_commit_in_tx = true;
+	group_commit_pending = 0;
+	group_commit_start = std::chrono::steady_clock::now();
+
+	return DBERR_NO_ERROR;
+}
+
+int DbInterfaceSQLite::group_commit_end(sqlite3_stmt* stmt, int step_rc)
+{
+	if (!group_commit_in_tx)
+		return DBERR_NO_ERROR;
+
+	// Some errors (e.g. SQLITE_FULL, SQLITE_IOERR) roll back the whole transaction
+	if (sqlite3_get_autocommit(connaddr)) {
+		lib_logger->warn("SQLite: group commit transaction was rolled back ({} pending statements)", group_commit_pending);
+		group_commit_in_tx = false;
+		group_commit_pending = 0;
+		return DBERR_NO_ERROR;
+	}
+
+	if (step_rc != SQLITE_DONE && step_rc != SQLITE_ROW)
+		return DBERR_NO_ERROR;
+
+	group_commit_pending++;
+
+	if ((group_commit_size > 0 && group_commit_pending >= group_commit_size) || is_group_commit_expired())
+		return group_commit_flush();
+
+	return DBERR_NO_ERROR;
+}
+
+int DbInterfaceSQLite::group_commit_flush()
+{
+	if (!group_commit_in_tx || !connaddr)
+		return DBERR_NO_ERROR;
+
+	lib_logger->trace(FMT_FILE_FUNC "SQLite::committing {} pending statements", __FILE__, __func__, group_commit_pending);
+
+	int rc = sqlite3_exec(connaddr, "COMMIT", 0, 0, nullptr);
+	group_commit_in_tx = !sqlite3_get_autocommit(connaddr);
+	group_commit_pending = group_commit_in_tx ? group_commit_pending : 0;
+
+	if (sqliteRetrieveError(rc) != SQLITE_OK) {
+		lib_logger->error("SQLite: cannot commit group commit transaction: {} ({}): {}", last_rc, last_state, last_error);
+		return DBERR_SQL_ERROR;
+	}
+
+	return DBERR_NO_ERROR;
+}
+
+int DbInterfaceSQLite::cancel()
+{
+	if (!connaddr)
+		return DBERR_CONN_NOT_FOUND;
+
+	// the running statement (if any) fails with SQLITE_INTERRUPT, see recover_from_interrupt
+	sqlite3_interrupt(connaddr);
+	return DBERR_NO_ERROR;
+}
+
+// A statement interrupted by cancel() is reset to release its locks. SQLite might also have rolled back 
+// the current transaction: with autocommit off a new one is started, as after COMMIT/ROLLBACK
+void DbInterfaceSQLite::recover_from_interrupt(sqlite3_stmt* stmt, int step_rc)
+{
+	if ((step_rc & 0xff) != SQLITE_INTERRUPT)
+		return;
+
+	sqlite3_reset(stmt);
+
+	if (connection_opts->autocommit == AutoCommitMode::Off && sqlite3_get_autocommit(connaddr)) {
+		lib_logger->warn("SQLite: the transaction was rolled back by the interrupted statement, starting a new one");
+		sqlite3_exec(connaddr, "BEGIN TRANSACTION", 0, 0, nullptr);
+	}
+}
+
 int DbInterfaceSQLite::cursor_close(const std::shared_ptr<ICursor>& crsr)
 {
-	// Nothing to do
+	if (!crsr)
+		return DBERR_CLOSE_CURSOR_FAILED;
+
+	// The statement is kept for the next OPEN, we only reset it to release its locks
+	std::shared_ptr<SQLiteStatementData> dp = std::dynamic_pointer_cast<SQLiteStatementData>(crsr->getPrivateData());
+	if (dp && dp->statement)
+		sqlite3_reset(dp->statement);
+
 	return DBERR_NO_ERROR;
 }
 
+// Cursors keep their statement across CLOSE/OPEN: it is prepared again only if the query has changed
+std::shared_ptr<SQLiteStatementData> DbInterfaceSQLite::get_cursor_statement(const std::shared_ptr<ICursor>& crsr, const std::string& query)
+{
+	auto it = _cursor_stmts.find(crsr->getName());
+	if (it != _cursor_stmts.end() && it->second->query == query) {
+		lib_logger->trace(FMT_FILE_FUNC "SQLite::reusing statement for cursor {}", __FILE__, __func__, crsr->getName());
+		return it->second;
+	}
+
+	std::shared_ptr<SQLiteStatementData> res = std::make_shared<SQLiteStatementData>();
+	int rc = sqlite3_prepare_v2(connaddr, query.c_str(), query.size(), &res->statement, nullptr);
+	if (sqliteRetrieveError(rc) != SQLITE_OK) {
+		lib_logger->error("SQLite: cannot prepare statement for cursor {}: {} ({}): {}", crsr->getName(), last_rc, last_state, last_error);
+		return nullptr;
+	}
+
+	res->query = query;
+	_cursor_stmts[crsr->getName()] = res;
+
+	return res;
+}
+
 int DbInterfaceSQLite::cursor_declare(const std::shared_ptr<ICursor>& cursor)
 {
 	if (!cursor)
@@ -788,6 +1026,15 @@ int DbInterfaceSQLite::cursor_open(const std::shared_ptr<ICursor>& cursor)
 		}
 	}
 
+	if (!prepared_stmt_data) {
+		prepared_stmt_data = get_cursor_statement(cursor, squery);
+		if (!prepared_stmt_data)
+			return DBERR_OPEN_CURSOR_FAILED;
+	}
+
+	sqlite3_reset(prepared_stmt_data->statement);
+	sqlite3_clear_bindings(prepared_stmt_data->statement);
+
 	if (cursor->getNumParams() > 0) {
 		std::vector<std_binary_data> param_values = cursor->getParameterValues();
 		std::vector<CobolVarType> param_types = cursor->getParameterTypes();
@@ -836,6 +1083,7 @@ int DbInterfaceSQLite::cursor_fetch_one(const std::shared_ptr<ICursor>& cursor,
 		int step_rc = sqlite3_step(dp->statement);
 		if (step_rc != SQLITE_DONE && step_rc != SQLITE_ROW) {
 			sqliteRetrieveError(step_rc);
+			recover_from_interrupt(dp->statement, step_rc);
 			return DBERR_SQL_ERROR;
 		}
 
@@ -962,9 +1210,91 @@ bool DbInterfaceSQLite::move_to_first_record(const std::string& _stmt_name)
 	return true;
 }
 
+int DbInterfaceSQLite::prepare_static(const std::vector<StaticStatementInfo>& stmts, std::vector<int>& results)
+{
+	int rc = DBERR_NO_ERROR;
+
+	results.clear();
+	for (const auto& si : stmts) {
+		if (_static_stmts.find(si.query) != _static_stmts.end()) {
+			results.push_back(DBERR_NO_ERROR);
+			continue;
+		}
+
+		std::shared_ptr<SQLiteStatementData> res = std::make_shared<SQLiteStatementData>();
+		int prc = sqlite3_prepare_v2(connaddr, si.query.c_str(), si.query.size(), &res->statement, nullptr);
+		if (sqliteRetrieveError(prc) != SQLITE_OK) {
+			lib_logger->error("SQLite: cannot prepare static statement ({}): {} - {}", last_rc, last_error, si.query);
+			results.push_back(DBERR_PREPARE_FAILED);
+			rc = DBERR_PREPARE_FAILED;
+			continue;
+		}
+
+		_static_stmts[si.query] = res;
+		results.push_back(DBERR_NO_ERROR);
+	}
+
+	return rc;
+}
+
+int DbInterfaceSQLite::explain(const std::string& query, const std::vector<CobolVarType>& paramTypes, const std::vector<std_binary_data>& paramValues, const std::vector<unsigned long>& paramLengths, const std::vector<uint32_t>& paramFlags, std::string& plan)
+{
+	std::string explain_query = "EXPLAIN QUERY PLAN " + query;
+	sqlite3_stmt* stmt = nullptr;
+
+	// errors are only logged: last_rc/last_error still refer to the statement being explained
+	int rc = sqlite3_prepare_v2(connaddr, explain_query.c_str(), explain_query.size(), &stmt, nullptr);
+	if (rc != SQLITE_OK) {
+		lib_logger->error("SQLite: cannot prepare EXPLAIN statement ({}): {}", rc, sqlite3_errmsg(connaddr));
+		sqlite3_finalize(stmt);
+		return DBERR_SQL_ERROR;
+	}
+
+	for (int i = 0; i < paramValues.size() && rc == SQLITE_OK; i++) {
+		if (paramLengths.at(i) == DB_NULL)
+			rc = sqlite3_bind_null(stmt, i + 1);
+		else
+			if (CBL_FIELD_IS_BINARY(paramFlags[i]))
+				rc = sqlite3_bind_blob64(stmt, i + 1, reinterpret_cast<const char*>(paramValues.at(i).data()), paramLengths.at(i), SQLITE_TRANSIENT);
+			else
+				rc = sqlite3_bind_text(stmt, i + 1, reinterpret_cast<const char*>(paramValues.at(i).data()), paramLengths.at(i), SQLITE_TRANSIENT);
+	}
+
+	if (rc != SQLITE_OK) {
+		lib_logger->error("SQLite: cannot bind EXPLAIN parameters ({}): {}", rc, sqlite3_errmsg(connaddr));
+		sqlite3_finalize(stmt);
+		return DBERR_SQL_ERROR;
+	}
+
+	// each row is a node of the plan tree (id, parent, notused, detail): nodes are indented by depth
+	std::map<int, int> depths;
+	plan.clear();
+	while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+		int id = sqlite3_column_int(stmt, 0);
+		int parent = sqlite3_column_int(stmt, 1);
+		const char* detail = (const char*)sqlite3_column_text(stmt, 3);
+
+		int depth = (depths.find(parent) != depths.end()) ? depths[parent] + 1 : 0;
+		depths[id] = depth;
+
+		if (!plan.empty())
+			plan += "\n";
+		plan += std::string(depth * 2, ' ') + "- " + (detail ? detail : "");
+	}
+
+	if (rc != SQLITE_DONE) {
+		lib_logger->error("SQLite: EXPLAIN failed ({}): {}", rc, sqlite3_errmsg(connaddr));
+		sqlite3_finalize(stmt);
+		return DBERR_SQL_ERROR;
+	}
+
+	sqlite3_finalize(stmt);
+	return DBERR_NO_ERROR;
+}
+
 uint64_t DbInterfaceSQLite::get_native_features()
 {
-	return (uint64_t)0;
+	return (uint64_t)DbNativeFeature::StaticStatementCache;
 }
 
 
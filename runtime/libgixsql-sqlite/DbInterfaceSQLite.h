@@ -27,6 +27,7 @@ USA.
 #include <vector>
 #include <map>
 #include <memory>
+#include <chrono>
 
 #include "ICursor.h"
 #include "IDbInterface.h"
@@ -54,6 +55,9 @@ struct SQLiteStatementData : public IPrivateStatementData {
 
 	bool _on_first_row = false;
 
+	// source query (only for statements cached for cursors)
+	std::string query;
+
 private:
 	void cleanup();
 };
@@ -76,6 +80,9 @@ public:
 	virtual int cursor_fetch_one(const std::shared_ptr<ICursor>& crsr, int) override;
 	virtual bool get_resultset_value(ResultSetContextType resultset_context_type, const IResultSetContextData& context, int row, int col, char* bfr, uint64_t bfrlen, uint64_t* value_len, bool *is_db_null) override;
 	virtual bool move_to_first_record(const std::string& stmt_name = "") override;
+	virtual int prepare_static(const std::vector<StaticStatementInfo>& stmts, std::vector<int>& results) override;
+	virtual int explain(const std::string& query, const std::vector<CobolVarType>& paramTypes, const std::vector<std_binary_data>& paramValues, const std::vector<unsigned long>& paramLengths, const std::vector<uint32_t>& paramFlags, std::string& plan) override;
+	virtual int cancel() override;
 	virtual uint64_t get_native_features() override;
 	virtual int get_num_rows(const std::shared_ptr<ICursor>& crsr) override;
 	virtual int get_num_fields(const std::shared_ptr<ICursor>& crsr) override;
@@ -84,6 +91,7 @@ public:
 	virtual std::string get_state() override;
 	virtual int prepare(const std::string& stmt_name, const std::string& query) override;
 	virtual int exec_prepared(const std::string& stmt_name, std::vector<CobolVarType> paramTypes, std::vector<std_binary_data>& paramValues, std::vector<unsigned long> paramLengths, const std::vector<uint32_t>& paramFlags) override;
+	virtual int deallocate_prepared(const std::string& stmt_name) override;
 	virtual DbPropertySetResult set_property(DbProperty p, std::variant<bool, int, std::string> v) override;
 
 
@@ -107,6 +115,8 @@ private:
 
 	std::map<std::string, std::shared_ptr<ICursor>> _declared_cursors;
 	std::map<std::string, std::shared_ptr<SQLiteStatementData>> _prepared_stmts;
+	std::map<std::string, std::shared_ptr<SQLiteStatementData>> _cursor_stmts;
+	std::map<std::string, std::shared_ptr<SQLiteStatementData>> _static_stmts;
 
 	int decode_binary = DECODE_BINARY_DEFAULT;
 
@@ -118,14 +128,29 @@ private:
 	int _sqlite_exec_params(const std::shared_ptr<ICursor>& crsr, const std::string& query, const std::vector<CobolVarType>& paramTypes, const std::vector<std_binary_data>& paramValues, const std::vector<unsigned long>& paramLengths, const std::vector<uint32_t>& paramFlags, std::shared_ptr<SQLiteStatementData> prep_stmt = nullptr);
 
 	int _sqlite_get_num_rows(sqlite3_stmt* r);
+	void recover_from_interrupt(sqlite3_stmt* stmt, int step_rc);
 
 	std::shared_ptr<SQLiteStatementData> retrieve_prepared_statement(const std::string& prep_stmt_name);
 	bool is_cursor_from_prepared_statement(ICursor* cursor);
+	std::shared_ptr<SQLiteStatementData> get_cursor_statement(const std::shared_ptr<ICursor>& crsr, const std::string& query);
 
 	// Updatable cursor emulation
 	bool updatable_cursors_emu = false;
 	bool has_unique_key(std::string table_name, const std::shared_ptr<ICursor>& crsr, std::vector<std::string>& unique_key);
 	bool prepare_updatable_cursor_query(const std::string& qry, const std::shared_ptr<ICursor>& crsr, const std::vector<std::string>& unique_key, sqlite3_stmt** update_stmt, std::vector<std::string>& key_params);
 	std::vector<std::string> get_resultset_column_names(sqlite3_stmt* stmt);
+
+	// Group commit: in autocommit mode, writes are batched in an implicit transaction
+	int group_commit_size = 0;
+	int group_commit_interval = 0;	// milliseconds
+	bool group_commit_in_tx = false;
+	int group_commit_pending = 0;
+	std::chrono::steady_clock::time_point group_commit_start;
+
+	bool is_group_commit_enabled();
+	bool is_group_commit_expired();
+	int group_commit_begin(sqlite3_stmt* stmt);
+	int group_commit_end(sqlite3_stmt* stmt, int step_rc);
+	int group_commit_flush();
 };
 
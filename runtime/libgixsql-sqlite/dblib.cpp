@@ -34,6 +34,16 @@ using namespace std;
 
 extern "C" {
 
+#if defined(GIXSQL_STATIC_DRIVER)
+
+	// Linked into libgixsql (see --with-static-drivers), looked up by DbInterfaceFactory
+	IDbInterface *get_dblib_sqlite()
+	{
+		return new DbInterfaceSQLite();
+	}
+
+#else
+
 	LIBGIXSQL_API IDbInterface *get_dblib()
 	{
 		IDbInterface *dbi = new DbInterfaceSQLite();
@@ -46,4 +56,6 @@ extern "C" {
 		 	delete dbi;
 	}	
 
+#endif
+
 }
\ No newline at end of file
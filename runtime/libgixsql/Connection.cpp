@@ -30,8 +30,6 @@ Connection::Connection()
 
 Connection::~Connection()
 {
-	if (dbi)
-		DbInterfaceFactory::releaseInterface(dbi);
 }
 
 int Connection::getId()
@@ -64,6 +62,26 @@ void Connection::setConnectionOptions(std::shared_ptr<IConnectionOptions> p)
 	options = p;
 }
 
+std::shared_ptr<ResultCache> Connection::getResultCache()
+{
+	return result_cache;
+}
+
+void Connection::setResultCache(std::shared_ptr<ResultCache> c)
+{
+	result_cache = c;
+}
+
+std::shared_ptr<PreparedStatementCache> Connection::getPreparedStatements()
+{
+	return prepared_statements;
+}
+
+void Connection::setPreparedStatements(std::shared_ptr<PreparedStatementCache> p)
+{
+	prepared_statements = p;
+}
+
 void Connection::setConnectionInfo(std::shared_ptr<IDataSourceInfo> conn_string)
 {
 	conninfo = conn_string;
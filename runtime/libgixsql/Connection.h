@@ -37,6 +37,8 @@
 #include "IDbInterface.h"
 #include "IDataSourceInfo.h"
 #include "IConnectionOptions.h"
+#include "ResultCache.h"
+#include "PreparedStatementCache.h"
 
 class DbInterface;
 
@@ -62,11 +64,17 @@ public:
 	
 	void setOpened(bool) override;
 	
-	std::string getName();
+	std::string getName() override;
 
 	std::shared_ptr<IConnectionOptions> getConnectionOptions() const override;
 	void setConnectionOptions(std::shared_ptr<IConnectionOptions>) override;
 
+	std::shared_ptr<ResultCache> getResultCache();
+	void setResultCache(std::shared_ptr<ResultCache>);
+
+	std::shared_ptr<PreparedStatementCache> getPreparedStatements();
+	void setPreparedStatements(std::shared_ptr<PreparedStatementCache>);
+
 private:
 
 	int id;
@@ -75,5 +83,7 @@ private:
 	bool is_opened = false;
 	std::shared_ptr<IConnectionOptions> options;
 	std::shared_ptr<IDbInterface> dbi;
+	std::shared_ptr<ResultCache> result_cache;
+	std::shared_ptr<PreparedStatementCache> prepared_statements;
 };
 
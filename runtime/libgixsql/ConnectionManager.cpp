@@ -22,7 +22,9 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <set>
 #include <algorithm>
+#include <chrono>
 
 #include "ConnectionManager.h"
 #include "DbInterfaceFactory.h"
@@ -30,9 +32,15 @@
 
 #define GIXSQL_DEFAULT_CONN_PREFIX "DEFAULT"
 
+// seconds to wait before trying again to open a replica that could not be opened
+#define GIXSQL_REPLICA_RETRY_INTERVAL	30
+
 static std::vector<std::shared_ptr<Connection>> _connections;
 static std::map<int, std::shared_ptr<Connection>> _connection_map;
 static std::map<std::string, std::shared_ptr<Connection>> _connection_name_map;
+static std::map<int, std::shared_ptr<Connection>> _replica_map;
+static std::map<int, std::chrono::steady_clock::time_point> _replica_failures;
+static std::set<int> _write_tx;
 
 static int next_conn_id = 1;
 
@@ -64,6 +72,12 @@ std::shared_ptr<Connection> ConnectionManager::get(const std::string& name)
 	return nullptr;
 }
 
+std::shared_ptr<Connection> ConnectionManager::getById(int conn_id)
+{
+	auto it = _connection_map.find(conn_id);
+	return (it != _connection_map.end()) ? it->second : nullptr;
+}
+
 int ConnectionManager::add(std::shared_ptr<Connection> conn)
 {
 	conn->id = ++next_conn_id;
@@ -94,6 +108,8 @@ void ConnectionManager::remove(std::shared_ptr<Connection> conn)
 	_connections.erase(std::remove(_connections.begin(), _connections.end(), conn), _connections.end());
 	_connection_map.erase(id);
 	_connection_name_map.erase(name);
+	removeReplica(id);
+	_write_tx.erase(id);
 
 	if (conn == default_connection)
 		default_connection.reset();
@@ -115,4 +131,53 @@ void ConnectionManager::clear()
 	_connections.clear();
 	_connection_map.clear();
 	_connection_name_map.clear();	
+	_replica_map.clear();
+	_replica_failures.clear();
+	_write_tx.clear();
+}
+
+std::shared_ptr<Connection> ConnectionManager::getReplica(int conn_id)
+{
+	auto it = _replica_map.find(conn_id);
+	return (it != _replica_map.end()) ? it->second : nullptr;
+}
+
+void ConnectionManager::setReplica(int conn_id, std::shared_ptr<Connection> replica)
+{
+	replica->id = conn_id;
+	_replica_map[conn_id] = replica;
+	_replica_failures.erase(conn_id);
+}
+
+void ConnectionManager::removeReplica(int conn_id)
+{
+	_replica_map.erase(conn_id);
+	_replica_failures.erase(conn_id);
+}
+
+bool ConnectionManager::canOpenReplica(int conn_id)
+{
+	auto it = _replica_failures.find(conn_id);
+	if (it == _replica_failures.end())
+		return true;
+
+	return std::chrono::steady_clock::now() - it->second >= std::chrono::seconds(GIXSQL_REPLICA_RETRY_INTERVAL);
+}
+
+void ConnectionManager::setReplicaFailed(int conn_id)
+{
+	_replica_failures[conn_id] = std::chrono::steady_clock::now();
+}
+
+bool ConnectionManager::inWriteTransaction(int conn_id)
+{
+	return _write_tx.find(conn_id) != _write_tx.end();
+}
+
+void ConnectionManager::setWriteTransaction(int conn_id, bool b)
+{
+	if (b)
+		_write_tx.insert(conn_id);
+	else
+		_write_tx.erase(conn_id);
 }
@@ -36,12 +36,26 @@ public:
 
 	std::shared_ptr<Connection> create();
 	std::shared_ptr<Connection> get(const std::string& name = "");
+	std::shared_ptr<Connection> getById(int conn_id);
 	int add(std::shared_ptr<Connection> conn);
 	void remove(std::shared_ptr<Connection> conn);
 	bool exists(const std::string& cname);
 	std::vector<std::shared_ptr<Connection>> list();
 	void clear();
 
+	// Read-only replica of a connection (see the read_replica data source option), opened
+	// on first use: it shares the id of the primary connection
+	std::shared_ptr<Connection> getReplica(int conn_id);
+	void setReplica(int conn_id, std::shared_ptr<Connection> replica);
+	void removeReplica(int conn_id);
+	bool canOpenReplica(int conn_id);
+	void setReplicaFailed(int conn_id);
+
+	// A connection is in a write transaction from the first write (with autocommit off) or from 
+	// an explicit BEGIN, up to COMMIT/ROLLBACK: in the meantime everything runs on the primary
+	bool inWriteTransaction(int conn_id);
+	void setWriteTransaction(int conn_id, bool b);
+
 private:
 	std::shared_ptr<Connection> default_connection;
 };
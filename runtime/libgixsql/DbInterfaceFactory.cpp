@@ -22,12 +22,64 @@
 
 #include <stdlib.h>
 #include <cstring>
+#include <mutex>
+#include <algorithm>
 
 #include "gixsql.h"
 
-//static std::map<std::shared_ptr<IDbInterface>, LIBHANDLE> lib_map;
+// Driver libraries are loaded once and stay loaded until the process terminates: 
+// each new connection only needs the provider function
+struct DbLibInfo {
+	LIBHANDLE handle;
+	DBLIB_PROVIDER_FUNC provider;
+};
 
-typedef IDbInterface * (*DBLIB_PROVIDER_FUNC)();
+static std::map<std::string, DbLibInfo> dblib_cache;
+static std::mutex dblib_cache_lock;
+
+// Drivers linked into libgixsql (see --with-static-drivers)
+extern "C" {
+#if defined(GIXSQL_STATIC_DRIVER_PGSQL)
+	IDbInterface* get_dblib_pgsql();
+#endif
+#if defined(GIXSQL_STATIC_DRIVER_ODBC)
+	IDbInterface* get_dblib_odbc();
+#endif
+#if defined(GIXSQL_STATIC_DRIVER_MYSQL)
+	IDbInterface* get_dblib_mysql();
+#endif
+#if defined(GIXSQL_STATIC_DRIVER_ORACLE)
+	IDbInterface* get_dblib_oracle();
+#endif
+#if defined(GIXSQL_STATIC_DRIVER_SQLITE)
+	IDbInterface* get_dblib_sqlite();
+#endif
+}
+
+static DBLIB_PROVIDER_FUNC get_static_provider(const std::string& lib_id)
+{
+#if defined(GIXSQL_STATIC_DRIVER_PGSQL)
+	if (lib_id == "pgsql")
+		return get_dblib_pgsql;
+#endif
+#if defined(GIXSQL_STATIC_DRIVER_ODBC)
+	if (lib_id == "odbc")
+		return get_dblib_odbc;
+#endif
+#if defined(GIXSQL_STATIC_DRIVER_MYSQL)
+	if (lib_id == "mysql")
+		return get_dblib_mysql;
+#endif
+#if defined(GIXSQL_STATIC_DRIVER_ORACLE)
+	if (lib_id == "oracle")
+		return get_dblib_oracle;
+#endif
+#if defined(GIXSQL_STATIC_DRIVER_SQLITE)
+	if (lib_id == "sqlite")
+		return get_dblib_sqlite;
+#endif
+	return nullptr;
+}
 
 #if defined(_WIN32)
 //Returns the last Win32 error, in string format. Returns an empty string if there is no error.
@@ -111,102 +163,121 @@ IDbManagerInterface* DbInterfaceFactory::getManagerInterface(std::string type)
 
 std::shared_ptr<IDbInterface> DbInterfaceFactory::load_dblib(const GlobalEnv* genv, const char *lib_id)
 {
-	char bfr[256];
 	std::shared_ptr<IDbInterface> dbi;
-	LIBHANDLE libHandle = NULL;
-	DBLIB_PROVIDER_FUNC dblib_provider;
-
-	sprintf(bfr, "libgixsql-");
-	strcat(bfr, lib_id);
-
-#if defined(_WIN32)
 
-	strcat(bfr, ".dll");
-	spdlog::debug(FMT_FILE_FUNC "loading DB provider: {}", __FILE__, __func__, bfr);
-
-	libHandle = LoadLibrary(bfr);
-	spdlog::trace(FMT_FILE_FUNC "library handle is: {}", __FILE__, __func__, (void *) libHandle);
-
-	if (libHandle != NULL)
-	{
-		dblib_provider = (DBLIB_PROVIDER_FUNC)GetProcAddress(libHandle, "get_dblib");
-		spdlog::debug(FMT_FILE_FUNC "accessing DB provider: {}", __FILE__, __func__, bfr);
-		// If the function address is valid, call the function. 
-		if (dblib_provider != NULL)
-		{
-#if _DEBUG
-			char dll_path[MAX_PATH];
-			int rc = GetModuleFileName(libHandle, dll_path, MAX_PATH);
-			if (rc) {
-				spdlog::debug(FMT_FILE_FUNC "DB provider loaded from: {}", __FILE__, __func__, dll_path);
-			}
-#endif
+	DBLIB_PROVIDER_FUNC dblib_provider = get_provider(lib_id);
+	if (dblib_provider == NULL)
+		return dbi;
 
 #if defined(_DEBUG) && defined(VERBOSE)
-			dbi = std::shared_ptr<IDbInterface>(dblib_provider(), [](IDbInterface* p) {
-				fprintf(stderr, "- Deallocated IDbInterface: 0x%p\n", p);
-				delete p;
-			});
-			fprintf(stderr, "+ Allocated IDbInterface: 0x%p\n", dbi.get());
+	dbi = std::shared_ptr<IDbInterface>(dblib_provider(), [](IDbInterface *p) { 
+		fprintf(stderr, "- Deallocated IDbInterface: 0x%p\n", p);
+		delete p; 
+	});
+	fprintf(stderr, "+ Allocated IDbInterface: 0x%p\n", dbi.get());
 #else
-			dbi.reset(dblib_provider());
+	dbi.reset(dblib_provider());
 #endif
-		}
-		else {
-			spdlog::error("ERROR while accessing DB provider: {}", bfr);
-		}
 
-		// Library not freed here
+	if (dbi != nullptr) {
+		dbi->init(genv, gixsql_logger);
 	}
-	else {
+	return dbi;
+}
+
+DBLIB_PROVIDER_FUNC DbInterfaceFactory::get_provider(const std::string& lib_id)
+{
+	std::lock_guard<std::mutex> lock(dblib_cache_lock);
+
+	auto it = dblib_cache.find(lib_id);
+	if (it != dblib_cache.end())
+		return it->second.provider;
+
+	DbLibInfo dbl = { NULL, get_static_provider(lib_id) };
+	if (dbl.provider != NULL) {
+		spdlog::debug(FMT_FILE_FUNC "using built-in DB provider: {}", __FILE__, __func__, lib_id);
+		dblib_cache[lib_id] = dbl;
+		return dbl.provider;
+	}
+
+	std::string lib_name = "libgixsql-" + lib_id;
+
+#if defined(_WIN32)
+
+	lib_name += ".dll";
+	spdlog::debug(FMT_FILE_FUNC "loading DB provider: {}", __FILE__, __func__, lib_name);
+
+	dbl.handle = LoadLibrary(lib_name.c_str());
+	spdlog::trace(FMT_FILE_FUNC "library handle is: {}", __FILE__, __func__, (void *) dbl.handle);
+
+	if (dbl.handle == NULL) {
 		auto err = GetLastErrorAsString();
-		spdlog::error("ERROR while loading DB provider {}: {}", bfr, err);
+		spdlog::error("ERROR while loading DB provider {}: {}", lib_name, err);
 #if _DEBUG
 		spdlog::error("PATH is: {}", getenv("PATH"));
 #endif
+		return NULL;
 	}
 
-#else
+#if _DEBUG
+	char dll_path[MAX_PATH];
+	int rc = GetModuleFileName(dbl.handle, dll_path, MAX_PATH);
+	if (rc) {
+		spdlog::debug(FMT_FILE_FUNC "DB provider loaded from: {}", __FILE__, __func__, dll_path);
+	}
+#endif
+
+	spdlog::debug(FMT_FILE_FUNC "accessing DB provider: {}", __FILE__, __func__, lib_name);
+	dbl.provider = (DBLIB_PROVIDER_FUNC)GetProcAddress(dbl.handle, "get_dblib");
+	if (dbl.provider == NULL) {
+		spdlog::error("ERROR while accessing DB provider: {}", lib_name);
+		FreeLibrary(dbl.handle);
+		return NULL;
+	}
 
-	strcat(bfr, ".so");
-	spdlog::debug(FMT_FILE_FUNC "loading DB provider: {}", __FILE__, __func__, bfr);
-
-	libHandle = dlopen(bfr, RTLD_NOW);
-	if (libHandle != NULL)
-	{
-		dblib_provider = (DBLIB_PROVIDER_FUNC)dlsym(libHandle, "get_dblib");
-		spdlog::debug(FMT_FILE_FUNC "Accessing DB provider: {}", __FILE__, __func__, bfr);
-		// If the function address is valid, call the function. 
-		if (dblib_provider != NULL)
-		{
-#if defined(_DEBUG) && defined(VERBOSE)
-			dbi = std::shared_ptr<IDbInterface>(dblib_provider(), [](IDbInterface *p) { 
-				fprintf(stderr, "- Deallocated IDbInterface: 0x%p\n", p);
-				delete p; 
-			});
-			fprintf(stderr, "+ Allocated IDbInterface: 0x%p\n", dbi.get());
 #else
-			dbi.reset(dblib_provider());
-#endif
-		}
-		else {
-			spdlog::error("ERROR while accessing DB provider: {}", bfr);
-		}
 
-		// Library not freed here
+	lib_name += ".so";
+	spdlog::debug(FMT_FILE_FUNC "loading DB provider: {}", __FILE__, __func__, lib_name);
+
+	dbl.handle = dlopen(lib_name.c_str(), RTLD_NOW);
+	if (dbl.handle == NULL) {
+		spdlog::error("ERROR while loading DB provider: {} ({})", lib_name, dlerror());
+		return NULL;
 	}
-	else {
-        	spdlog::error("ERROR while loading DB provider: {} ({})", bfr, dlerror());
+
+	spdlog::debug(FMT_FILE_FUNC "Accessing DB provider: {}", __FILE__, __func__, lib_name);
+	dbl.provider = (DBLIB_PROVIDER_FUNC)dlsym(dbl.handle, "get_dblib");
+	if (dbl.provider == NULL) {
+		spdlog::error("ERROR while accessing DB provider: {}", lib_name);
+		dlclose(dbl.handle);
+		return NULL;
 	}
 
 #endif
 
-	dbi->native_lib_ptr = (void *) libHandle;
+	// Failures are not cached, the next connection will retry
+	dblib_cache[lib_id] = dbl;
+	return dbl.provider;
+}
 
-	if (dbi != nullptr) {
-		dbi->init(genv, gixsql_logger);
+int DbInterfaceFactory::preload(const std::vector<std::string>& drivers)
+{
+	auto available = getAvailableDrivers();
+	int n = 0;
+
+	for (auto d : drivers) {
+		if (std::find(available.begin(), available.end(), d) == available.end()) {
+			spdlog::error("ERROR: cannot preload DB provider, invalid driver id: {}", d);
+			continue;
+		}
+
+		if (get_provider(d) != NULL) {
+			spdlog::debug(FMT_FILE_FUNC "DB provider preloaded: {}", __FILE__, __func__, d);
+			n++;
+		}
 	}
-	return dbi;
+	return n;
 }
 
 // TODO: this should really be generated dynamically
@@ -214,14 +285,3 @@ std::vector<std::string> DbInterfaceFactory::getAvailableDrivers()
 {
 	return std::vector<std::string> { "odbc", "mysql", "pgsql", "oracle", "sqlite" } ;
 }
-
-void DbInterfaceFactory::releaseInterface(std::shared_ptr<IDbInterface> dbi)
-{
-	if (dbi && dbi->native_lib_ptr) {
-#if defined(_WIN32)
-		FreeLibrary((HMODULE)dbi->native_lib_ptr);
-#else
-		dlclose(dbi->native_lib_ptr);
-#endif
-	}		
-}
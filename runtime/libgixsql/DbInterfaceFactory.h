@@ -61,6 +61,8 @@ typedef unsigned char byte;
 #include "IDbInterface.h"
 #include "IDbManagerInterface.h"
 
+typedef IDbInterface * (*DBLIB_PROVIDER_FUNC)();
+
 class DbInterfaceFactory
 {
 public:
@@ -73,10 +75,12 @@ public:
 
 	static LIBGIXSQL_API std::vector<std::string> getAvailableDrivers();
 
-	static void releaseInterface(std::shared_ptr<IDbInterface> dbi);
+	// Loads the given drivers in advance, returns the number of drivers available
+	static LIBGIXSQL_API int preload(const std::vector<std::string>& drivers);
 
 private:
 
 	static std::shared_ptr<IDbInterface> load_dblib(const GlobalEnv* genv, const char *);
+	static DBLIB_PROVIDER_FUNC get_provider(const std::string& lib_id);
 };
 
@@ -38,6 +38,7 @@ public:
 	virtual int getId() = 0;
 	virtual bool isOpen() = 0;
 	virtual void setName(std::string) = 0;
+	virtual std::string getName() = 0;
 	virtual void setConnectionInfo(std::shared_ptr<IDataSourceInfo>) = 0;
 	virtual void setOpened(bool) = 0;
 	virtual void setDbInterface(std::shared_ptr<IDbInterface> ) = 0;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 enum class AutoCommitMode {
 	On = 1,
@@ -12,5 +13,20 @@ struct IConnectionOptions
 	AutoCommitMode autocommit = AutoCommitMode::Native;
 	bool fixup_parameters = false;
 	std::string client_encoding;
+
+	// slow statement log (see SlowStatementLog)
+	int slow_log_threshold = 0;
+	bool slow_log_params = false;
+	bool slow_log_explain = false;
+	std::vector<std::string> slow_log_masked_columns;
+
+	// read-only replica data source for read/write splitting (empty if not used)
+	std::string read_replica;
+
+	// timeout for each driver call (ms), 0 = no timeout
+	int statement_timeout = 0;
+
+	// maximum number of prepared statements kept on the connection (LRU), 0 = no limit
+	int max_prepared_statements = 0;
 };
 
@@ -33,6 +33,7 @@ USA.
 #include "IDbManagerInterface.h"
 #include "IResultSetContextData.h"
 #include "cobol_var_types.h"
+#include "stmt_flags.h"
 #include "GlobalEnv.h"
 
 using std_binary_data = std::vector<unsigned char>;
@@ -65,6 +66,7 @@ using std_binary_data = std::vector<unsigned char>;
 #define DBERR_NO_DATA				-122
 #define DBERR_TOO_MUCH_DATA			-123
 #define DBERR_PREPARE_FAILED		-124
+#define DBERR_STATEMENT_TIMEOUT		-125
 
 #define DBERR_CONN_INIT_ERROR		-201
 #define DBERR_CONN_INVALID_DBTYPE	-202
@@ -107,7 +109,13 @@ enum class DbNativeFeature : uint64_t {
 	UpdatableCursors	= 1 << 2,
 
 	// resultsets include row count 
-	ResultSetRowCount	= 1 << 3
+	ResultSetRowCount	= 1 << 3,
+
+	// LOB data can be read directly into binary host variables (see get_resultset_value_direct)
+	DirectLobRead		= 1 << 4,
+
+	// static statements can be prepared in advance (see prepare_static)
+	StaticStatementCache	= 1 << 5
 };
 
 enum class DbProperty {
@@ -120,6 +128,13 @@ enum class DbPropertySetResult {
 	Unsupported = 2
 };
 
+// A static statement registered by a module (see prepare_static)
+struct StaticStatementInfo {
+	std::string query;
+	std::vector<CobolVarType> param_types;
+	std::vector<uint32_t> param_flags;
+};
+
 class IDbInterface
 {
 	friend class DbInterfaceFactory;
@@ -140,6 +155,36 @@ public:
 	virtual bool get_resultset_value(ResultSetContextType resultset_context_type, const IResultSetContextData& context, int row, int col, char* bfr, uint64_t bfrlen, uint64_t* value_len, bool
 	                                 * is_db_null) = 0;
 	virtual bool move_to_first_record(const std::string& stmt_name = "") = 0;
+
+	// Reads a value straight into the storage of the host variable: data exceeding bfrlen is truncated, 
+	// only called if the driver declares DbNativeFeature::DirectLobRead
+	virtual bool get_resultset_value_direct(ResultSetContextType resultset_context_type, const IResultSetContextData& context, int row, int col, char* bfr, uint64_t bfrlen, uint64_t* value_len, bool* is_db_null)
+	{
+		return false;
+	}
+
+	// Prepares a batch of static statements: later calls to exec/exec_params with the same query text 
+	// reuse the prepared handles. results receives a DBERR_* code for each statement. Only called 
+	// if the driver declares DbNativeFeature::StaticStatementCache
+	virtual int prepare_static(const std::vector<StaticStatementInfo>& stmts, std::vector<int>& results)
+	{
+		return DBERR_NOT_IMPL;
+	}
+
+	// Retrieves the execution plan of a query with the given parameters, without executing it and without 
+	// altering the state of the connection (current result set, last error). Used by the slow statement log
+	virtual int explain(const std::string& query, const std::vector<CobolVarType>& paramTypes, const std::vector<std_binary_data>& paramValues, const std::vector<unsigned long>& paramLengths, const std::vector<uint32_t>& paramFlags, std::string& plan)
+	{
+		return DBERR_NOT_IMPL;
+	}
+
+	// Cancels the statement currently running on the connection, if any. Called from another thread 
+	// (see StatementWatchdog) while the statement is running, the connection must stay usable
+	virtual int cancel()
+	{
+		return DBERR_NOT_IMPL;
+	}
+
 	virtual uint64_t get_native_features() = 0;
 	virtual int get_num_rows(const std::shared_ptr<ICursor>& crsr) = 0;
 	virtual int get_num_fields(const std::shared_ptr<ICursor>& crsr) = 0;
@@ -148,6 +193,9 @@ public:
 	virtual std::string get_state() = 0;
 	virtual int prepare(const std::string& stmt_name, const std::string& query) = 0;
 	virtual int exec_prepared(const std::string& stmt_name, std::vector<CobolVarType> paramTypes, std::vector<std_binary_data> &paramValues, std::vector<unsigned long> paramLengths, const std::vector<uint32_t>& paramFlags) = 0;
+
+	// Releases a prepared statement, both client and server side. Cursors already opened from it are not affected
+	virtual int deallocate_prepared(const std::string& stmt_name) = 0;
 	virtual DbPropertySetResult set_property(DbProperty p, std::variant<bool, int, std::string> v) = 0;
 
 	IDbManagerInterface* manager()
@@ -160,12 +208,17 @@ public:
 		return get_native_features() & ((uint64_t)f);
 	}
 
+	// Classification (STMT_FLAG_*) of the statement passed to the next exec/exec_params call, 
+	// when it is not classified the drivers must inspect the query text
+	void set_statement_flags(uint32_t f)
+	{
+		stmt_flags = f;
+	}
+
 protected:
 
 	std::shared_ptr<spdlog::logger> lib_logger;
 	GlobalEnv *global_env = nullptr;
-
-private:
-	void *native_lib_ptr = nullptr;	
+	uint32_t stmt_flags = STMT_FLAG_NONE;
 };
 
@@ -37,3 +37,5 @@
 #define DEFAULT_GIXSQL_LOG_ROTATE_ON_OPEN		true
 
 extern std::shared_ptr<spdlog::logger> gixsql_logger;
+
+void get_log_rotation_parameters(unsigned long* max_size, int* max_files, bool* rotate_on_open);
@@ -0,0 +1,81 @@
+/*
+* This file is part of Gix-IDE, an IDE and platform for GnuCOBOL
+* Copyright (C) 2021 Marco Ridoni
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public License
+* as published by the Free Software Foundation; either version 3,
+* or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; see the file COPYING.LIB.  If
+* not, write to the Free Software Foundation, 51 Franklin Street, Fifth Floor
+* Boston, MA 02110-1301 USA
+*/
+
+
+
+#include "PreparedStatementCache.h"
+
+#include "utils.h"
+
+PreparedStatementCache::PreparedStatementCache(int _max_size)
+{
+	max_size = _max_size > 0 ? _max_size : 0;
+}
+
+std::vector<std::string> PreparedStatementCache::add(const std::string& _name)
+{
+	std::vector<std::string> evicted;
+	std::string name = to_lower(_name);
+
+	auto it = entries.find(name);
+	if (it != entries.end()) {
+		lru.splice(lru.begin(), lru, it->second);
+		return evicted;
+	}
+
+	lru.push_front(name);
+	entries[name] = lru.begin();
+
+	while (max_size > 0 && lru.size() > max_size) {
+		evicted.push_back(lru.back());
+		entries.erase(lru.back());
+		lru.pop_back();
+	}
+
+	return evicted;
+}
+
+void PreparedStatementCache::touch(const std::string& name)
+{
+	auto it = entries.find(to_lower(name));
+	if (it != entries.end())
+		lru.splice(lru.begin(), lru, it->second);
+}
+
+bool PreparedStatementCache::remove(const std::string& name)
+{
+	auto it = entries.find(to_lower(name));
+	if (it == entries.end())
+		return false;
+
+	lru.erase(it->second);
+	entries.erase(it);
+	return true;
+}
+
+bool PreparedStatementCache::contains(const std::string& name)
+{
+	return entries.find(to_lower(name)) != entries.end();
+}
+
+size_t PreparedStatementCache::size()
+{
+	return lru.size();
+}
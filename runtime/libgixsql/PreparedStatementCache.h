@@ -0,0 +1,52 @@
+/*
+* This file is part of Gix-IDE, an IDE and platform for GnuCOBOL
+* Copyright (C) 2021 Marco Ridoni
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public License
+* as published by the Free Software Foundation; either version 3,
+* or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; see the file COPYING.LIB.  If
+* not, write to the Free Software Foundation, 51 Franklin Street, Fifth Floor
+* Boston, MA 02110-1301 USA
+*/
+#pragma once
+
+#include <string>
+#include <vector>
+#include <list>
+#include <unordered_map>
+
+#define DEFAULT_GIXSQL_MAX_PREPARED_STATEMENTS	0
+
+// Names of the statements prepared on a connection (PREPARE), in LRU order. When a limit is set, 
+// adding a statement beyond it returns the least recently used ones, that the caller deallocates
+class PreparedStatementCache
+{
+public:
+	PreparedStatementCache(int max_size);
+
+	// Returns the names of the statements evicted to make room for the new one
+	std::vector<std::string> add(const std::string& name);
+
+	// Called each time a statement is executed or used to open a cursor
+	void touch(const std::string& name);
+
+	bool remove(const std::string& name);
+	bool contains(const std::string& name);
+	size_t size();
+
+private:
+	size_t max_size;	// 0 = no limit
+
+	// most recently used first, names are stored in lower case
+	std::list<std::string> lru;
+	std::unordered_map<std::string, std::list<std::string>::iterator> entries;
+};
@@ -0,0 +1,272 @@
+/*
+* This file is part of Gix-IDE, an IDE and platform for GnuCOBOL
+* Copyright (C) 2021 Marco Ridoni
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public License
+* as published by the Free Software Foundation; either version 3,
+* or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; see the file COPYING.LIB.  If
+* not, write to the Free Software Foundation, 51 Franklin Street, Fifth Floor
+* Boston, MA 02110-1301 USA
+*/
+
+
+#include "ResultCache.h"
+
+#include <cstring>
+
+#include "Logger.h"
+#include "utils.h"
+
+// Keywords that can follow a table name in a FROM clause, anything else is an alias
+static const std::set<std::string> from_clause_keywords = {
+	"WHERE", "JOIN", "INNER", "LEFT", "RIGHT", "FULL", "OUTER", "CROSS", "NATURAL", "ON", "USING",
+	"GROUP", "ORDER", "HAVING", "LIMIT", "OFFSET", "FETCH", "FOR", "UNION", "EXCEPT", "INTERSECT", "WINDOW"
+};
+
+static std::vector<std::string> tokenize(const std::string& query)
+{
+	std::vector<std::string> tokens;
+	size_t i = 0;
+	while (i < query.size()) {
+		char c = query[i];
+		if (isspace((unsigned char)c)) {
+			i++;
+			continue;
+		}
+
+		if (c == '\'') {
+			// string literals are skipped
+			i++;
+			while (i < query.size() && query[i] != '\'')
+				i++;
+			i++;
+			continue;
+		}
+
+		if (isalnum((unsigned char)c) || c == '_' || c == '$' || c == '#' || c == '"' || c == '`' || c == '.') {
+			std::string t;
+			while (i < query.size() && (isalnum((unsigned char)query[i]) || strchr("_$#\"`.", query[i]))) {
+				if (query[i] != '"' && query[i] != '`')
+					t += toupper((unsigned char)query[i]);
+				i++;
+			}
+			tokens.push_back(t);
+			continue;
+		}
+
+		tokens.push_back(std::string(1, c));
+		i++;
+	}
+	return tokens;
+}
+
+static bool is_identifier(const std::string& t)
+{
+	return !t.empty() && (isalpha((unsigned char)t[0]) || t[0] == '_');
+}
+
+ResultCache::ResultCache(const std::vector<std::string>& _tables, const std::vector<std::string>& _queries, int _ttl, int _max_entries)
+{
+	for (auto t : _tables) {
+		t = to_upper(trim_copy(string_replace(t, "\"", "")));
+		if (!t.empty())
+			tables.insert(t);
+	}
+
+	for (auto q : _queries) {
+		trim(q);
+		if (!q.empty())
+			queries.insert(q);
+	}
+
+	ttl = _ttl;
+	max_entries = _max_entries > 0 ? _max_entries : DEFAULT_GIXSQL_RESULT_CACHE_SIZE;
+}
+
+bool ResultCache::isCacheable(const std::string& query)
+{
+	auto it = cacheable.find(query);
+	if (it != cacheable.end())
+		return it->second;
+
+	bool b = queries.find(trim_copy(query)) != queries.end() || readsOnlyFrom(query);
+	cacheable[query] = b;
+	spdlog::trace(FMT_FILE_FUNC "result cache: query is {}cacheable: {}", __FILE__, __func__, b ? "" : "not ", query);
+	return b;
+}
+
+// Checks that all the tables referenced in FROM/JOIN clauses are in the configured list
+// (a table matches by its qualified or unqualified name)
+bool ResultCache::readsOnlyFrom(const std::string& query)
+{
+	if (tables.empty())
+		return false;
+
+	std::vector<std::string> tokens = tokenize(query);
+	if (tokens.empty() || tokens[0] != "SELECT")
+		return false;
+
+	int ntables = 0;
+	for (size_t i = 0; i < tokens.size(); i++) {
+		if (tokens[i] != "FROM" && tokens[i] != "JOIN")
+			continue;
+
+		size_t j = i + 1;
+		while (j < tokens.size() && is_identifier(tokens[j])) {
+			std::string t = tokens[j];
+			size_t dot = t.rfind('.');
+			if (tables.find(t) == tables.end() && (dot == std::string::npos || tables.find(t.substr(dot + 1)) == tables.end()))
+				return false;
+			ntables++;
+			j++;
+
+			// optional alias
+			if (j < tokens.size() && tokens[j] == "AS")
+				j++;
+			if (j < tokens.size() && is_identifier(tokens[j]) && from_clause_keywords.find(tokens[j]) == from_clause_keywords.end())
+				j++;
+
+			if (j < tokens.size() && tokens[j] == ",")
+				j++;
+			else
+				break;
+		}
+		// subqueries ("FROM (SELECT ...") are checked by the next iterations
+		i = j - 1;
+	}
+
+	return ntables > 0;
+}
+
+bool ResultCache::buildKey(const std::string& query, SqlVarList& params, SqlVarList& results, std::string& key)
+{
+	key = query;
+	key.push_back('\0');
+
+	for (SqlVar* v : results) {
+		if (!v->getStorageSize())
+			return false;
+
+		int32_t layout[4] = { (int32_t)v->getType(), (int32_t)v->getLength(), v->getPower(), (int32_t)(v->getIndAddr() != nullptr) };
+		key.append((const char*)layout, sizeof(layout));
+	}
+
+	for (SqlVar* v : params) {
+		unsigned long sz = v->getStorageSize();
+		if (!sz)
+			return false;
+
+		int16_t ind = v->getIndAddr() ? *((int16_t*)v->getIndAddr()) : 0;
+		key.append((const char*)&ind, sizeof(ind));
+		key.append((const char*)v->getAddr(), sz);
+	}
+
+	return true;
+}
+
+bool ResultCache::lookup(const std::string& query, SqlVarList& params, SqlVarList& results)
+{
+	std::string key;
+	if (!buildKey(query, params, results, key)) {
+		misses++;
+		return false;
+	}
+
+	auto it = entries.find(key);
+	if (it == entries.end()) {
+		misses++;
+		return false;
+	}
+
+	auto e = it->second;
+	if (std::chrono::steady_clock::now() >= e->expires) {
+		entries.erase(it);
+		lru.erase(e);
+		misses++;
+		return false;
+	}
+
+	// The data is stored as (indicator, bytes) for each result variable, as in store
+	const uint8_t* p = e->data.data();
+	for (SqlVar* v : results) {
+		unsigned long sz = v->getStorageSize();
+		int16_t ind;
+		memcpy(&ind, p, sizeof(ind));
+		p += sizeof(ind);
+
+		if (v->getIndAddr())
+			*((int16_t*)v->getIndAddr()) = ind;
+
+		// a NULL value leaves the host variable untouched
+		if (ind != -1)
+			memcpy(v->getAddr(), p, sz);
+
+		p += sz;
+	}
+
+	lru.splice(lru.begin(), lru, e);
+	hits++;
+	return true;
+}
+
+void ResultCache::store(const std::string& query, SqlVarList& params, SqlVarList& results)
+{
+	std::string key;
+	if (!buildKey(query, params, results, key))
+		return;
+
+	Entry ne;
+	ne.key = key;
+	ne.expires = std::chrono::steady_clock::now() + std::chrono::seconds(ttl);
+	for (SqlVar* v : results) {
+		unsigned long sz = v->getStorageSize();
+		int16_t ind = v->getIndAddr() ? *((int16_t*)v->getIndAddr()) : 0;
+		const uint8_t* pi = (const uint8_t*)&ind;
+		const uint8_t* pv = (const uint8_t*)v->getAddr();
+		ne.data.insert(ne.data.end(), pi, pi + sizeof(ind));
+		ne.data.insert(ne.data.end(), pv, pv + sz);
+	}
+
+	auto it = entries.find(key);
+	if (it != entries.end()) {
+		lru.erase(it->second);
+		entries.erase(it);
+	}
+
+	while (lru.size() >= max_entries) {
+		entries.erase(lru.back().key);
+		lru.pop_back();
+	}
+
+	lru.push_front(std::move(ne));
+	entries[key] = lru.begin();
+}
+
+void ResultCache::invalidate()
+{
+	if (lru.empty())
+		return;
+
+	spdlog::trace(FMT_FILE_FUNC "result cache: {} entries invalidated", __FILE__, __func__, lru.size());
+	entries.clear();
+	lru.clear();
+}
+
+uint64_t ResultCache::getHits()
+{
+	return hits;
+}
+
+uint64_t ResultCache::getMisses()
+{
+	return misses;
+}
@@ -0,0 +1,80 @@
+/*
+* This file is part of Gix-IDE, an IDE and platform for GnuCOBOL
+* Copyright (C) 2021 Marco Ridoni
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public License
+* as published by the Free Software Foundation; either version 3,
+* or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; see the file COPYING.LIB.  If
+* not, write to the Free Software Foundation, 51 Franklin Street, Fifth Floor
+* Boston, MA 02110-1301 USA
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <list>
+#include <set>
+#include <map>
+#include <unordered_map>
+#include <chrono>
+
+#include "SqlVarList.h"
+
+#define DEFAULT_GIXSQL_RESULT_CACHE_TTL		300
+#define DEFAULT_GIXSQL_RESULT_CACHE_SIZE	10000
+
+// Client-side cache for SELECT INTO statements (see GIXSQLExecSelectIntoOne), one for each connection.
+// Only the statements listed in the configuration, or that only read from the listed tables, are cached.
+// Entries are keyed by the query text, the layout of the result variables and the bytes of the input 
+// variables, and hold the COBOL-side bytes (and NULL indicators) of the result variables
+class ResultCache
+{
+public:
+	ResultCache(const std::vector<std::string>& tables, const std::vector<std::string>& queries, int ttl, int max_entries);
+
+	bool isCacheable(const std::string& query);
+
+	// On a hit, the result variables are filled with the cached data
+	bool lookup(const std::string& query, SqlVarList& params, SqlVarList& results);
+	void store(const std::string& query, SqlVarList& params, SqlVarList& results);
+
+	// Called for every statement that might modify data (DML, COMMIT, etc.)
+	void invalidate();
+
+	uint64_t getHits();
+	uint64_t getMisses();
+
+private:
+	struct Entry {
+		std::string key;
+		std::vector<uint8_t> data;
+		std::chrono::steady_clock::time_point expires;
+	};
+
+	std::set<std::string> tables;		// upper case
+	std::set<std::string> queries;
+	std::unordered_map<std::string, bool> cacheable;
+
+	int ttl;	// seconds
+	size_t max_entries;
+
+	// most recently used first
+	std::list<Entry> lru;
+	std::unordered_map<std::string, std::list<Entry>::iterator> entries;
+
+	uint64_t hits = 0;
+	uint64_t misses = 0;
+
+	bool buildKey(const std::string& query, SqlVarList& params, SqlVarList& results, std::string& key);
+	bool readsOnlyFrom(const std::string& query);
+};
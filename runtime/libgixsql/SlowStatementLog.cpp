@@ -0,0 +1,392 @@
+/*
+* This file is part of Gix-IDE, an IDE and platform for GnuCOBOL
+* Copyright (C) 2021 Marco Ridoni
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public License
+* as published by the Free Software Foundation; either version 3,
+* or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; see the file COPYING.LIB.  If
+* not, write to the Free Software Foundation, 51 Franklin Street, Fifth Floor
+* Boston, MA 02110-1301 USA
+*/
+
+#include "SlowStatementLog.h"
+
+#include <map>
+#include <regex>
+#include <mutex>
+#include <algorithm>
+
+#include "spdlog/sinks/rotating_file_sink.h"
+
+#include "Logger.h"
+#include "utils.h"
+
+bool SlowStatementLog::enabled = false;
+std::string SlowStatementLog::log_file = DEFAULT_GIXSQL_SLOW_LOG_FILE;
+int SlowStatementLog::explain_interval = DEFAULT_GIXSQL_SLOW_LOG_EXPLAIN_INTERVAL;
+std::map<std::string, std::chrono::steady_clock::time_point> SlowStatementLog::explained;
+std::shared_ptr<spdlog::logger> SlowStatementLog::logger;
+
+static std::mutex slow_log_mutex;
+
+static const char* phase_names[SLOW_LOG_PHASE_COUNT] = { "prepare", "execute", "fetch" };
+
+void SlowStatementLog::init(const std::string& filename, int _explain_interval)
+{
+	log_file = filename;
+	explain_interval = _explain_interval;
+}
+
+void SlowStatementLog::enable()
+{
+	enabled = true;
+}
+
+bool SlowStatementLog::isEnabled()
+{
+	return enabled;
+}
+
+void SlowStatementLog::write(const std::string& msg)
+{
+	std::lock_guard<std::mutex> lock(slow_log_mutex);
+
+	// the file is only created when the first entry is written
+	if (!logger) {
+		unsigned long rotate_max_size;
+		int rotate_max_files;
+		bool rotate_on_open;	// Not available on spdlog < 1.4.0
+		get_log_rotation_parameters(&rotate_max_size, &rotate_max_files, &rotate_on_open);
+
+		try {
+#if SPDLOG_VERSION >= 10400
+			auto sink = std::make_shared<spdlog::sinks::rotating_file_sink_mt>(log_file, rotate_max_size, rotate_max_files, false);
+#else
+			auto sink = std::make_shared<spdlog::sinks::rotating_file_sink_mt>(log_file, rotate_max_size, rotate_max_files);
+#endif
+			logger = std::make_shared<spdlog::logger>("libgixsql-slow", sink);
+			logger->set_pattern("[%Y-%m-%d %H:%M:%S.%e] %v");
+			logger->flush_on(spdlog::level::info);
+		}
+		catch (const spdlog::spdlog_ex& ex) {
+			spdlog::error("Cannot open the slow statement log ({}): {}", log_file, ex.what());
+			enabled = false;
+			return;
+		}
+	}
+
+	logger->info(msg);
+}
+
+// Position and (1-based) index of each parameter marker ($n, :n or ?) outside of string literals
+static std::map<size_t, int> find_parameter_markers(const std::string& query)
+{
+	std::map<size_t, int> markers;
+	int ordinal = 0;
+	bool in_literal = false;
+	for (size_t i = 0; i < query.size(); i++) {
+		char c = query[i];
+		if (c == '\'') {
+			in_literal = !in_literal;
+			continue;
+		}
+
+		if (in_literal)
+			continue;
+
+		if (c == '?') {
+			markers[i] = ++ordinal;
+			continue;
+		}
+
+		if ((c == '$' || c == ':') && i + 1 < query.size() && isdigit((unsigned char)query[i + 1])) {
+			markers[i] = atoi(query.c_str() + i + 1);
+			ordinal++;
+		}
+	}
+	return markers;
+}
+
+static std::string unqualified_column_name(std::string s)
+{
+	trim(s);
+	size_t p = s.find_last_of('.');
+	if (p != std::string::npos)
+		s = s.substr(p + 1);
+	if (s.size() >= 2 && s.front() == '"' && s.back() == '"')
+		s = s.substr(1, s.size() - 2);
+	return s;
+}
+
+std::vector<std::string> SlowStatementLog::findParameterColumns(const std::string& query, int nparams)
+{
+	std::vector<std::string> cols(nparams);
+	std::map<size_t, int> markers = find_parameter_markers(query);
+	if (markers.empty())
+		return cols;
+
+	auto set_col = [&cols, nparams](int idx, const std::string& name) {
+		if (idx > 0 && idx <= nparams && cols[idx - 1].empty())
+			cols[idx - 1] = unqualified_column_name(name);
+	};
+
+	// INSERT INTO t (c1, c2, ...) VALUES (v1, v2, ...): markers are matched to the column list by position
+	static const std::regex re_insert("^\\s*INSERT\\s+INTO\\s+[^\\s(]+\\s*\\(([^)]*)\\)\\s*VALUES\\s*\\(", std::regex::icase);
+	std::smatch m;
+	if (std::regex_search(query, m, re_insert)) {
+		std::vector<std::string> names = string_split(m[1].str(), ",");
+		size_t pos = m.position(0) + m.length(0);
+		int depth = 0;
+		size_t col = 0;
+		for (; pos < query.size() && col < names.size(); pos++) {
+			char c = query[pos];
+			if (c == '(')
+				depth++;
+			else
+				if (c == ')') {
+					if (depth == 0)
+						break;
+					depth--;
+				}
+				else
+					if (c == ',' && depth == 0)
+						col++;
+
+			auto it = markers.find(pos);
+			if (it != markers.end())
+				set_col(it->second, names[col]);
+		}
+	}
+
+	// <column> <operator> <marker>, this also covers the SET clause of UPDATE statements
+	static const std::regex re_cmp("([A-Za-z_\"][A-Za-z0-9_$#.\"]*)\\s*(=|<>|!=|<=|>=|<|>|\\s+LIKE\\s+)\\s*(\\$[0-9]+|:[0-9]+|\\?)", std::regex::icase);
+	for (std::sregex_iterator it(query.begin(), query.end(), re_cmp), end; it != end; ++it) {
+		auto mk = markers.find(it->position(3));
+		if (mk != markers.end())
+			set_col(mk->second, (*it)[1].str());
+	}
+
+	return cols;
+}
+
+bool SlowStatementLog::isExplainable(const std::string& query)
+{
+	static const std::regex re_explainable("^\\s*(SELECT|WITH|INSERT|UPDATE|DELETE)\\b", std::regex::icase);
+	static const std::regex re_current_of("\\bCURRENT\\s+OF\\b", std::regex::icase);
+
+	return std::regex_search(query, re_explainable) && !std::regex_search(query, re_current_of);
+}
+
+bool SlowStatementLog::shouldExplain(const std::string& key)
+{
+	std::lock_guard<std::mutex> lock(slow_log_mutex);
+
+	auto now = std::chrono::steady_clock::now();
+	auto it = explained.find(key);
+	if (it != explained.end() && now - it->second < std::chrono::seconds(explain_interval))
+		return false;
+
+	explained[key] = now;
+	return true;
+}
+
+SlowStatementTimer::SlowStatementTimer(const char* _api_name)
+{
+	if (!SlowStatementLog::isEnabled())
+		return;
+
+	active = true;
+	api_name = _api_name;
+	start_time = clock::now();
+	phase_start = start_time;
+}
+
+SlowStatementTimer::~SlowStatementTimer()
+{
+	if (!active || !connection || !exceeded())
+		return;
+
+	clock::time_point now = clock::now();
+	closePhase(now);
+	double elapsed = std::chrono::duration<double, std::milli>(now - start_time).count();
+
+	std::shared_ptr<IConnectionOptions> opts = connection->getConnectionOptions();
+
+	std::string phases;
+	for (int i = 0; i < SLOW_LOG_PHASE_COUNT; i++) {
+		if (phase_ms[i] > 0)
+			phases += fmt::format("{}{}={:.3f}ms", phases.empty() ? "" : " ", phase_names[i], phase_ms[i]);
+	}
+
+	std::string msg = fmt::format("conn={} api={} stmt={} elapsed={:.3f}ms ({}) rows={}", 
+		connection->getName(), api_name, stmt_id.empty() ? "-" : stmt_id, elapsed, phases, row_count >= 0 ? std::to_string(row_count) : "n/a");
+
+	if (!query.empty())
+		msg += fmt::format(" sql=\"{}\"", query);
+
+	if (opts->slow_log_params && params && params->size() > 0)
+		msg += " params=[" + formatParameters(opts->slow_log_masked_columns) + "]";
+
+	SlowStatementLog::write(msg);
+
+	if (opts->slow_log_explain)
+		writePlan();
+}
+
+void SlowStatementTimer::setConnection(const std::shared_ptr<IConnection>& conn)
+{
+	if (!active || !conn)
+		return;
+
+	std::shared_ptr<IConnectionOptions> opts = conn->getConnectionOptions();
+	if (!opts || opts->slow_log_threshold <= 0) {
+		active = false;
+		return;
+	}
+
+	connection = conn;
+}
+
+void SlowStatementTimer::setStatement(const std::string& _stmt_id, const std::string& _query)
+{
+	if (!active)
+		return;
+
+	stmt_id = _stmt_id;
+	query = _query;
+}
+
+void SlowStatementTimer::setParameters(SqlVarList* _params)
+{
+	if (active)
+		params = _params;
+}
+
+void SlowStatementTimer::setRowCount(int n)
+{
+	row_count = n;
+}
+
+void SlowStatementTimer::startPhase(SlowLogPhase p)
+{
+	if (!active)
+		return;
+
+	closePhase(clock::now());
+	cur_phase = p;
+}
+
+bool SlowStatementTimer::isActive()
+{
+	return active;
+}
+
+bool SlowStatementTimer::exceeded()
+{
+	if (!active || !connection)
+		return false;
+
+	auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(clock::now() - start_time).count();
+	return elapsed >= connection->getConnectionOptions()->slow_log_threshold;
+}
+
+void SlowStatementTimer::closePhase(clock::time_point now)
+{
+	phase_ms[(int)cur_phase] += std::chrono::duration<double, std::milli>(now - phase_start).count();
+	phase_start = now;
+}
+
+void SlowStatementTimer::writePlan()
+{
+	if (query.empty() || !SlowStatementLog::isExplainable(query))
+		return;
+
+	std::string key = connection->getName() + ":" + (stmt_id.empty() ? query : stmt_id);
+	if (!SlowStatementLog::shouldExplain(key))
+		return;
+
+	std::shared_ptr<IDbInterface> dbi = connection->getDbInterface();
+	if (!dbi)
+		return;
+
+	std::vector<CobolVarType> param_types;
+	std::vector<std_binary_data> param_values;
+	std::vector<unsigned long> param_lengths;
+	std::vector<uint32_t> param_flags;
+	if (params) {
+		for (SqlVar* v : *params) {
+			param_types.push_back(v->getType());
+			param_values.push_back(v->getDbData());
+			param_lengths.push_back(!v->isDbNull() ? v->getDisplayLength() : DB_NULL);
+			param_flags.push_back(v->getFlags());
+		}
+	}
+
+	std::string plan;
+	int rc = dbi->explain(query, param_types, param_values, param_lengths, param_flags, plan);
+	if (rc == DBERR_NOT_IMPL)
+		return;
+
+	if (rc != DBERR_NO_ERROR) {
+		SlowStatementLog::write(fmt::format("conn={} stmt={} plan not available (error {})", connection->getName(), stmt_id.empty() ? "-" : stmt_id, rc));
+		return;
+	}
+
+	SlowStatementLog::write(fmt::format("conn={} stmt={} plan:\n{}", connection->getName(), stmt_id.empty() ? "-" : stmt_id, plan));
+}
+
+std::string SlowStatementTimer::formatParameters(const std::vector<std::string>& masked_columns)
+{
+	bool mask_all = std::find(masked_columns.begin(), masked_columns.end(), "*") != masked_columns.end();
+	std::vector<std::string> cols;
+	if (!mask_all && !masked_columns.empty())
+		cols = SlowStatementLog::findParameterColumns(query, params->size());
+
+	std::string res;
+	for (int i = 0; i < params->size(); i++) {
+		SqlVar* v = params->at(i);
+		std::string val;
+
+		bool masked = mask_all;
+		if (!masked && !cols.empty() && !cols[i].empty()) {
+			for (const auto& mc : masked_columns) {
+				if (caseInsensitiveStringCompare(mc, cols[i])) {
+					masked = true;
+					break;
+				}
+			}
+		}
+
+		if (masked) {
+			val = SLOW_LOG_MASKED_VALUE;
+		}
+		else
+			if (v->isDbNull()) {
+				val = "NULL";
+			}
+			else
+				if (v->isBinary()) {
+					val = fmt::format("<binary, {} bytes>", v->getDisplayLength());
+				}
+				else {
+					const std_binary_data& d = v->getDbData();
+					size_t len = std::min<size_t>(d.size(), v->getDisplayLength());
+					bool truncated = len > SLOW_LOG_MAX_VALUE_LEN;
+					val = "'" + string_replace(std::string((const char*)d.data(), truncated ? SLOW_LOG_MAX_VALUE_LEN : len), "'", "''") + (truncated ? "...'" : "'");
+				}
+
+		if (!res.empty())
+			res += ", ";
+		res += fmt::format("{}:{}", i + 1, val);
+	}
+	return res;
+}
@@ -0,0 +1,113 @@
+/*
+* This file is part of Gix-IDE, an IDE and platform for GnuCOBOL
+* Copyright (C) 2021 Marco Ridoni
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public License
+* as published by the Free Software Foundation; either version 3,
+* or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; see the file COPYING.LIB.  If
+* not, write to the Free Software Foundation, 51 Franklin Street, Fifth Floor
+* Boston, MA 02110-1301 USA
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <map>
+
+#include "spdlog/spdlog.h"
+
+#include "IConnection.h"
+#include "IDbInterface.h"
+#include "SqlVarList.h"
+
+#define DEFAULT_GIXSQL_SLOW_LOG_FILE		"gixsql-slow.log"
+#define DEFAULT_GIXSQL_SLOW_LOG_THRESHOLD	0
+#define DEFAULT_GIXSQL_SLOW_LOG_PARAMS		false
+#define DEFAULT_GIXSQL_SLOW_LOG_EXPLAIN		false
+#define DEFAULT_GIXSQL_SLOW_LOG_EXPLAIN_INTERVAL	3600
+
+#define SLOW_LOG_MASKED_VALUE				"****"
+#define SLOW_LOG_MAX_VALUE_LEN				64
+
+enum class SlowLogPhase {
+	Prepare = 0,	// argument checks, lookups, parameter setup
+	Execute = 1,	// the actual call to the driver
+	Fetch = 2		// reading the result values into the host variables
+};
+
+#define SLOW_LOG_PHASE_COUNT	3
+
+// The slow statement log: the API calls that take longer than the threshold set for their 
+// connection are written to a separate (rotating) log file
+class SlowStatementLog
+{
+public:
+	static void init(const std::string& filename, int explain_interval);
+	static void enable();
+	static bool isEnabled();
+
+	static void write(const std::string& msg);
+
+	// Finds (when possible) the column each parameter marker is bound to, used for masking
+	static std::vector<std::string> findParameterColumns(const std::string& query, int nparams);
+
+	// Plans are only captured for queries and DML statements, at most once per statement in each interval
+	static bool isExplainable(const std::string& query);
+	static bool shouldExplain(const std::string& key);
+
+private:
+	static bool enabled;
+	static std::string log_file;
+	static int explain_interval;	// seconds
+	static std::map<std::string, std::chrono::steady_clock::time_point> explained;
+	static std::shared_ptr<spdlog::logger> logger;
+};
+
+// Measures an API call: the entry is written (if the threshold is exceeded) when the timer goes out of scope
+class SlowStatementTimer
+{
+public:
+	SlowStatementTimer(const char* api_name);
+	~SlowStatementTimer();
+
+	void setConnection(const std::shared_ptr<IConnection>& conn);
+	void setStatement(const std::string& stmt_id, const std::string& query);
+	void setParameters(SqlVarList* params);
+	void setRowCount(int n);
+	void startPhase(SlowLogPhase p);
+
+	bool isActive();
+	bool exceeded();
+
+private:
+	using clock = std::chrono::steady_clock;
+
+	bool active = false;
+	const char* api_name = nullptr;
+	std::shared_ptr<IConnection> connection;
+	std::string stmt_id;
+	std::string query;
+	SqlVarList* params = nullptr;
+	int row_count = -1;
+
+	clock::time_point start_time;
+	clock::time_point phase_start;
+	SlowLogPhase cur_phase = SlowLogPhase::Prepare;
+	double phase_ms[SLOW_LOG_PHASE_COUNT] = { 0 };
+
+	void closePhase(clock::time_point now);
+	std::string formatParameters(const std::vector<std::string>& masked_columns);
+	void writePlan();
+};
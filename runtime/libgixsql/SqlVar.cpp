@@ -21,6 +21,7 @@
 #include <stdlib.h>
 #include <math.h>
 #include <string>
+#include <string_view>
 #include <cstring>
 #include <locale.h>
 #include <inttypes.h>
@@ -30,6 +31,7 @@
 #include "Logger.h"
 #include "custom_formatters.h"
 #include "GlobalEnv.h"
+#include "TraceRing.h"
 
 #define assertm(exp, msg) assert(((void)msg, exp))
 
@@ -135,7 +137,7 @@ void SqlVar::createRealData()
 				insert_decimal_point(reinterpret_cast<char *>(db_data_buffer.data()), db_data_buffer_len, power);
 			}
 
-			spdlog::trace(FMT_FILE_FUNC "type: {}, length: {}, data: {}, db_data_buffer: [{}]", __FILE__, __func__, type, length, addr, std::string((const char *)db_data_buffer.data(), db_data_buffer_len));
+			spdlog::trace(FMT_FILE_FUNC "type: {}, length: {}, data: {}, db_data_buffer: [{}]", __FILE__, __func__, type, length, addr, std::string_view((const char *)db_data_buffer.data(), db_data_buffer_len));
 			break;
 		}
 		case CobolVarType::COBOL_TYPE_SIGNED_NUMBER_TC:
@@ -153,7 +155,7 @@ void SqlVar::createRealData()
 				insert_decimal_point(reinterpret_cast<char*>(db_data_buffer.data()), db_data_buffer_len + SIGN_LENGTH, power);
 			}
 
-			spdlog::trace(FMT_FILE_FUNC "type: {}, length: {}, data: {}, db_data_buffer: [{}]", __FILE__, __func__, type, length, addr, std::string((const char *)db_data_buffer.data(), db_data_buffer_len));
+			spdlog::trace(FMT_FILE_FUNC "type: {}, length: {}, data: {}, db_data_buffer: [{}]", __FILE__, __func__, type, length, addr, std::string_view((const char *)db_data_buffer.data(), db_data_buffer_len));
 			break;
 		}
 		case CobolVarType::COBOL_TYPE_SIGNED_NUMBER_LS:
@@ -164,7 +166,7 @@ void SqlVar::createRealData()
 				insert_decimal_point(reinterpret_cast<char*>(db_data_buffer.data()), db_data_buffer_len + SIGN_LENGTH, power);
 			}
 
-			spdlog::trace(FMT_FILE_FUNC "type: {}, length: {}, data: {}, db_data_buffer: [{}]", __FILE__, __func__, type, length, addr, std::string((const char *)db_data_buffer.data(), db_data_buffer_len));
+			spdlog::trace(FMT_FILE_FUNC "type: {}, length: {}, data: {}, db_data_buffer: [{}]", __FILE__, __func__, type, length, addr, std::string_view((const char *)db_data_buffer.data(), db_data_buffer_len));
 			break;
 		}
 		case CobolVarType::COBOL_TYPE_UNSIGNED_NUMBER_PD:
@@ -195,7 +197,7 @@ void SqlVar::createRealData()
 				insert_decimal_point(reinterpret_cast<char*>(db_data_buffer.data()), db_data_buffer_len, power);
 			}
 
-			spdlog::trace(FMT_FILE_FUNC "type: {}, length: {}, data: {}, db_data_buffer: [{}]", __FILE__, __func__, type, length, addr, std::string((const char *)db_data_buffer.data(), db_data_buffer_len));
+			spdlog::trace(FMT_FILE_FUNC "type: {}, length: {}, data: {}, db_data_buffer: [{}]", __FILE__, __func__, type, length, addr, std::string_view((const char *)db_data_buffer.data(), db_data_buffer_len));
 			break;
 		}
 		case CobolVarType::COBOL_TYPE_SIGNED_NUMBER_PD:
@@ -237,7 +239,7 @@ void SqlVar::createRealData()
 				insert_decimal_point(reinterpret_cast<char*>(db_data_buffer.data()), db_data_buffer_len + SIGN_LENGTH, power);
 			}
 
-			spdlog::trace(FMT_FILE_FUNC "type: {}, length: {}, data: {}, db_data_buffer: [{}]", __FILE__, __func__, type, length, addr, std::string((const char *)db_data_buffer.data(), db_data_buffer_len));
+			spdlog::trace(FMT_FILE_FUNC "type: {}, length: {}, data: {}, db_data_buffer: [{}]", __FILE__, __func__, type, length, addr, std::string_view((const char *)db_data_buffer.data(), db_data_buffer_len));
 			break;
 		}
 
@@ -252,7 +254,7 @@ void SqlVar::createRealData()
 				if (is_autotrim) {
 					db_data_len = get_trimmed_length(reinterpret_cast<char*>(db_data_buffer.data()), length);
 				}
-				spdlog::trace(FMT_FILE_FUNC "type: {}, length: {}, data: {}, db_data_buffer: [{}]", __FILE__, __func__, type, length, addr, std::string((const char *)db_data_buffer.data(), db_data_buffer_len));
+				spdlog::trace(FMT_FILE_FUNC "type: {}, length: {}, data: {}, db_data_buffer: [{}]", __FILE__, __func__, type, length, addr, std::string_view((const char *)db_data_buffer.data(), db_data_buffer_len));
 			}
 			else {
 				void* actual_addr = (char*)addr + __global_env->varlen_length_sz();
@@ -263,7 +265,7 @@ void SqlVar::createRealData()
 
 				memcpy(db_data_buffer.data(), (char*)actual_addr, actual_len);
 				db_data_len = actual_len;
-				spdlog::trace(FMT_FILE_FUNC "type: {}, length: {}, data: {}, db_data_buffer: [{}]", __FILE__, __func__, type, length, addr, std::string((const char *)db_data_buffer.data(), db_data_buffer_len));
+				spdlog::trace(FMT_FILE_FUNC "type: {}, length: {}, data: {}, db_data_buffer: [{}]", __FILE__, __func__, type, length, addr, std::string_view((const char *)db_data_buffer.data(), db_data_buffer_len));
 			}
 		}
 		break;
@@ -316,7 +318,7 @@ void SqlVar::createRealData()
 
 			}
 
-			spdlog::trace(FMT_FILE_FUNC "type: {}, length: {}, data: {}, db_data_buffer: [{}]", __FILE__, __func__, type, length, addr, std::string((const char *)db_data_buffer.data(), db_data_buffer_len));
+			spdlog::trace(FMT_FILE_FUNC "type: {}, length: {}, data: {}, db_data_buffer: [{}]", __FILE__, __func__, type, length, addr, std::string_view((const char *)db_data_buffer.data(), db_data_buffer_len));
 			break;
 
 		case CobolVarType::COBOL_TYPE_SIGNED_BINARY:
@@ -367,7 +369,7 @@ void SqlVar::createRealData()
 
 			}
 
-			spdlog::trace(FMT_FILE_FUNC "type: {}, length: {}, data: {}, db_data_buffer: [{}]", __FILE__, __func__, type, length, addr, std::string((const char *)db_data_buffer.data(), db_data_buffer_len));
+			spdlog::trace(FMT_FILE_FUNC "type: {}, length: {}, data: {}, db_data_buffer: [{}]", __FILE__, __func__, type, length, addr, std::string_view((const char *)db_data_buffer.data(), db_data_buffer_len));
 			break;
 
 		default:
@@ -375,9 +377,12 @@ void SqlVar::createRealData()
 			db_data_buffer = std_binary_data(db_data_buffer_len);
 
 			memcpy(db_data_buffer.data(), (char*)addr, db_data_buffer_len);
-			spdlog::trace(FMT_FILE_FUNC "type: {}, length: {}, data: {}, db_data_buffer: [{}]", __FILE__, __func__, type, length, addr, std::string((const char *)db_data_buffer.data(), db_data_buffer_len));
+			spdlog::trace(FMT_FILE_FUNC "type: {}, length: {}, data: {}, db_data_buffer: [{}]", __FILE__, __func__, type, length, addr, std::string_view((const char *)db_data_buffer.data(), db_data_buffer_len));
 			break;
 	}
+
+	GIX_TRACE(TRACE_EV_VAR_TO_DB, 0, addr, db_data_len, (const char*)db_data_buffer.data(), db_data_len > 0 ? db_data_len : 0);
+
 #if _DEBUG
 	assertm(db_data_len >= 0, "db_data_len not set");
 #endif
@@ -393,11 +398,49 @@ void* SqlVar::getIndAddr()
 	return ind_addr;
 }
 
+// Size of the COBOL-side storage of the variable, 0 if not known
+unsigned long SqlVar::getStorageSize()
+{
+	switch (type) {
+		case CobolVarType::COBOL_TYPE_UNSIGNED_NUMBER:
+		case CobolVarType::COBOL_TYPE_SIGNED_NUMBER_TC:
+		case CobolVarType::COBOL_TYPE_ALPHANUMERIC:
+			return length;
+
+		case CobolVarType::COBOL_TYPE_SIGNED_NUMBER_LS:
+			return length + 1;
+
+		case CobolVarType::COBOL_TYPE_UNSIGNED_NUMBER_PD:
+		case CobolVarType::COBOL_TYPE_SIGNED_NUMBER_PD:
+			return (length / 2) + 1;
+
+		case CobolVarType::COBOL_TYPE_JAPANESE:
+			return length * 2;
+
+		case CobolVarType::COBOL_TYPE_UNSIGNED_BINARY:
+		case CobolVarType::COBOL_TYPE_SIGNED_BINARY:
+			if (length <= 2)
+				return 1;
+			if (length <= 4)
+				return 2;
+			if (length <= 9)
+				return 4;
+			if (length <= 18)
+				return 8;
+			return 0;
+
+		default:
+			return 0;
+	}
+}
+
 
 void SqlVar::createCobolData(char *retstr, int datalen, int *sqlcode)
 {
 	*sqlcode = 0;
 
+	GIX_TRACE(TRACE_EV_VAR_TO_COBOL, 0, addr, retstr ? datalen : -1, retstr, retstr && datalen > 0 ? datalen : 0);
+
 	if (!retstr && !datalen && ind_addr)
 	{
 		// value is NULL
@@ -762,6 +805,47 @@ void SqlVar::createCobolDataLowValue()
 	memset(addr, 0, length);
 }
 
+bool SqlVar::canReadDirect()
+{
+	return is_binary && type == CobolVarType::COBOL_TYPE_ALPHANUMERIC;
+}
+
+char* SqlVar::getDirectReadBuffer(uint64_t* bfrlen)
+{
+	if (!is_variable_length) {
+		*bfrlen = length;
+		return (char*)addr;
+	}
+
+	*bfrlen = length - __global_env->varlen_length_sz();
+	return (char*)addr + __global_env->varlen_length_sz();
+}
+
+// Data has already been written to the field by the driver, we only need padding and length
+void SqlVar::createCobolDataDirect(uint64_t datalen, int* sqlcode)
+{
+	*sqlcode = 0;
+
+	if (ind_addr)
+		*((int16_t*)ind_addr) = 0;
+
+	uint64_t bfrlen = 0;
+	char* bfr = getDirectReadBuffer(&bfrlen);
+	if (datalen < bfrlen)
+		memset(bfr + datalen, 0, bfrlen - datalen);
+
+	if (is_variable_length) {
+		if (__global_env->varlen_length_sz_short()) {
+			uint16_t* fld_len_addr = (uint16_t*)addr;
+			*fld_len_addr = ((uint16_t)datalen);
+		}
+		else {
+			uint32_t* fld_len_addr = (uint32_t*)addr;
+			*fld_len_addr = ((uint32_t)datalen);
+		}
+	}
+}
+
 CobolVarType SqlVar::getType()
 {
 	return type;
@@ -772,6 +856,11 @@ unsigned long SqlVar::getLength()
 	return length;
 }
 
+int SqlVar::getPower()
+{
+	return power;
+}
+
 unsigned long SqlVar::getDisplayLength()
 {
 	return db_data_len;
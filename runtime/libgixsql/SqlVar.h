@@ -46,7 +46,9 @@ public:
 	const std_binary_data& getDbData();
 	CobolVarType getType();
 	unsigned long getLength();
+	int getPower();
 	unsigned long getDisplayLength();
+	unsigned long getStorageSize();
 	uint32_t getFlags();
 
 	bool isVarLen();
@@ -59,6 +61,10 @@ public:
 
 	void createCobolDataLowValue();
 
+	bool canReadDirect();
+	char* getDirectReadBuffer(uint64_t* bfrlen);
+	void createCobolDataDirect(uint64_t datalen, int* sqlcode);
+
 
 private:
 	CobolVarType type; 
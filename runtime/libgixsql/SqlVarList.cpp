@@ -69,13 +69,16 @@ void SqlVarList::dump()
 	}
 }
 
-int SqlVarList::getMaxLength()
+int SqlVarList::getMaxLength(bool skip_direct_read)
 {
 	if (!size())
 		return 0;
 
 	int l = 0;
 	for (int i = 0; i < size(); i++) {
+		if (skip_direct_read && this->at(i)->canReadDirect())
+			continue;
+
 		if (this->at(i)->length > l)
 			l = this->at(i)->length;
 	}
@@ -37,6 +37,6 @@ public:
 	void clear();
 	void dump();
 
-	int getMaxLength();
+	int getMaxLength(bool skip_direct_read = false);
 };
 
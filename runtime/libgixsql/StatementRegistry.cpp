@@ -0,0 +1,58 @@
+/*
+* This file is part of Gix-IDE, an IDE and platform for GnuCOBOL
+* Copyright (C) 2021 Marco Ridoni
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public License
+* as published by the Free Software Foundation; either version 3,
+* or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; see the file COPYING.LIB.  If
+* not, write to the Free Software Foundation, 51 Franklin Street, Fifth Floor
+* Boston, MA 02110-1301 USA
+*/
+
+#include "StatementRegistry.h"
+
+StatementRegistry::StatementRegistry()
+{
+}
+
+StatementRegistry::~StatementRegistry()
+{
+}
+
+void StatementRegistry::add(const std::string& module_name, const std::string& connection_id, const StaticStatementInfo& stmt)
+{
+	for (const auto& e : entries) {
+		if (e.connection_id == connection_id && e.stmt.query == stmt.query)
+			return;
+	}
+
+	entries.push_back({ module_name, connection_id, stmt });
+}
+
+bool StatementRegistry::hasPending(int conn_id)
+{
+	auto it = fetched.find(conn_id);
+	return it == fetched.end() ? !entries.empty() : it->second < entries.size();
+}
+
+std::vector<StatementRegistry::Entry> StatementRegistry::fetchPending(int conn_id)
+{
+	size_t& n = fetched[conn_id];
+	std::vector<Entry> res(entries.begin() + n, entries.end());
+	n = entries.size();
+	return res;
+}
+
+void StatementRegistry::removeConnection(int conn_id)
+{
+	fetched.erase(conn_id);
+}
@@ -0,0 +1,53 @@
+/*
+* This file is part of Gix-IDE, an IDE and platform for GnuCOBOL
+* Copyright (C) 2021 Marco Ridoni
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public License
+* as published by the Free Software Foundation; either version 3,
+* or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; see the file COPYING.LIB.  If
+* not, write to the Free Software Foundation, 51 Franklin Street, Fifth Floor
+* Boston, MA 02110-1301 USA
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+
+#include "IDbInterface.h"
+
+// Static statements registered by the preprocessed modules (when eager preparation is enabled),
+// they are prepared in a single batch the first time a connection executes a statement
+class StatementRegistry
+{
+public:
+	struct Entry {
+		std::string module_name;
+		std::string connection_id;
+		StaticStatementInfo stmt;
+	};
+
+	StatementRegistry();
+	~StatementRegistry();
+
+	void add(const std::string& module_name, const std::string& connection_id, const StaticStatementInfo& stmt);
+	bool hasPending(int conn_id);
+	std::vector<Entry> fetchPending(int conn_id);
+	void removeConnection(int conn_id);
+
+private:
+	std::vector<Entry> entries;
+
+	// number of entries already handed out to each connection
+	std::map<int, size_t> fetched;
+};
@@ -0,0 +1,125 @@
+/*
+* This file is part of Gix-IDE, an IDE and platform for GnuCOBOL
+* Copyright (C) 2021 Marco Ridoni
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public License
+* as published by the Free Software Foundation; either version 3,
+* or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; see the file COPYING.LIB.  If
+* not, write to the Free Software Foundation, 51 Franklin Street, Fifth Floor
+* Boston, MA 02110-1301 USA
+*/
+
+
+#include "StatementWatchdog.h"
+
+#include <map>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <condition_variable>
+
+#include "Logger.h"
+
+using watchdog_clock = std::chrono::steady_clock;
+
+struct WatchdogState {
+	std::mutex mtx;
+	std::condition_variable cv;
+	bool started = false;
+	uint64_t next_ticket = 1;
+
+	// deadline -> ticket, ticket -> entry
+	std::multimap<watchdog_clock::time_point, uint64_t> deadlines;
+	std::map<uint64_t, std::shared_ptr<StatementWatchdog::Entry>> entries;
+};
+
+// Never deleted: the thread is detached and might still be waiting when the library is unloaded
+static WatchdogState* state = new WatchdogState();
+
+static void watchdog_thread()
+{
+	std::unique_lock<std::mutex> lock(state->mtx);
+	while (true) {
+		if (state->deadlines.empty()) {
+			state->cv.wait(lock);
+			continue;
+		}
+
+		auto first = state->deadlines.begin();
+		if (watchdog_clock::now() < first->first) {
+			state->cv.wait_until(lock, first->first);
+			continue;
+		}
+
+		uint64_t ticket = first->second;
+		state->deadlines.erase(first);
+
+		auto it = state->entries.find(ticket);
+		if (it == state->entries.end())
+			continue;
+
+		// The cancellation happens with the lock held: the watchdog cannot go out of scope 
+		// (and the thread running the statement cannot move on to another call) in the meantime
+		std::shared_ptr<StatementWatchdog::Entry> e = it->second;
+		state->entries.erase(it);
+		e->cancelled = true;
+
+		spdlog::warn("Statement timeout ({} ms) expired, cancelling", e->timeout_ms);
+		int rc = e->dbi->cancel();
+		if (rc != DBERR_NO_ERROR)
+			spdlog::error("Cannot cancel statement, the driver returned {}", rc);
+	}
+}
+
+StatementWatchdog::StatementWatchdog(const std::shared_ptr<IDbInterface>& dbi, int timeout_ms)
+{
+	if (timeout_ms <= 0 || !dbi)
+		return;
+
+	entry = std::make_shared<Entry>();
+	entry->dbi = dbi;
+	entry->timeout_ms = timeout_ms;
+
+	std::lock_guard<std::mutex> lock(state->mtx);
+	if (!state->started) {
+		std::thread(watchdog_thread).detach();
+		state->started = true;
+	}
+
+	ticket = state->next_ticket++;
+	deadline = watchdog_clock::now() + std::chrono::milliseconds(timeout_ms);
+	state->entries[ticket] = entry;
+	state->deadlines.insert({ deadline, ticket });
+	state->cv.notify_one();
+}
+
+StatementWatchdog::~StatementWatchdog()
+{
+	if (!entry)
+		return;
+
+	std::lock_guard<std::mutex> lock(state->mtx);
+	state->entries.erase(ticket);
+
+	auto range = state->deadlines.equal_range(deadline);
+	for (auto it = range.first; it != range.second; ++it) {
+		if (it->second == ticket) {
+			state->deadlines.erase(it);
+			break;
+		}
+	}
+}
+
+bool StatementWatchdog::expired()
+{
+	return entry && entry->cancelled;
+}
@@ -0,0 +1,52 @@
+/*
+* This file is part of Gix-IDE, an IDE and platform for GnuCOBOL
+* Copyright (C) 2021 Marco Ridoni
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public License
+* as published by the Free Software Foundation; either version 3,
+* or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; see the file COPYING.LIB.  If
+* not, write to the Free Software Foundation, 51 Franklin Street, Fifth Floor
+* Boston, MA 02110-1301 USA
+*/
+#pragma once
+
+#include <memory>
+#include <atomic>
+#include <chrono>
+
+#include "IDbInterface.h"
+
+#define DEFAULT_GIXSQL_STATEMENT_TIMEOUT	0
+
+// Enforces statement timeouts: a single background thread cancels (see IDbInterface::cancel) 
+// the driver calls that are still running when their deadline expires. A watchdog covers 
+// the driver calls made while it is in scope, timeout_ms <= 0 means no timeout
+class StatementWatchdog
+{
+public:
+	StatementWatchdog(const std::shared_ptr<IDbInterface>& dbi, int timeout_ms);
+	~StatementWatchdog();
+
+	// true if the statement was cancelled because of the timeout
+	bool expired();
+
+	struct Entry {
+		std::shared_ptr<IDbInterface> dbi;
+		int timeout_ms;
+		std::atomic<bool> cancelled{ false };
+	};
+
+private:
+	std::shared_ptr<Entry> entry;
+	uint64_t ticket = 0;
+	std::chrono::steady_clock::time_point deadline;
+};
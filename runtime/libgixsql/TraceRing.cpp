@@ -0,0 +1,295 @@
+/*
+* This file is part of Gix-IDE, an IDE and platform for GnuCOBOL
+* Copyright (C) 2021 Marco Ridoni
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public License
+* as published by the Free Software Foundation; either version 3,
+* or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; see the file COPYING.LIB.  If
+* not, write to the Free Software Foundation, 51 Franklin Street, Fifth Floor
+* Boston, MA 02110-1301 USA
+*/
+
+#include "TraceRing.h"
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <cstdlib>
+#include <csignal>
+#include <fcntl.h>
+
+#if defined(_WIN32) || defined(_WIN64)
+#include <io.h>
+#include <process.h>
+#include <windows.h>
+#define trace_open(_F)		_open(_F, _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _S_IREAD | _S_IWRITE)
+#define trace_write			_write
+#define trace_close			_close
+#else
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/syscall.h>
+#define trace_open(_F)		open(_F, O_WRONLY | O_CREAT | O_TRUNC, 0600)
+#define trace_write			write
+#define trace_close			close
+#endif
+
+#include "Logger.h"
+#include "utils.h"
+
+bool __trace_ring_enabled = false;
+
+struct TraceRing {
+	uint64_t thread_id = 0;
+	uint64_t size = 0;				// always a power of 2
+	std::atomic<uint64_t> head{ 0 };	// only written by the owner thread
+	TraceEvent* events = nullptr;
+};
+
+// Rings are never released: the events of terminated threads are still dumped. The registry
+// is append-only, so that it can be walked from a signal handler without locking
+static std::atomic<TraceRing*> rings[GIXSQL_TRACE_RING_MAX_THREADS];
+static std::atomic<int> ring_count{ 0 };
+static uint64_t ring_size = DEFAULT_GIXSQL_TRACE_RING_SIZE;
+static char dump_file[1024];
+
+static const int crash_signals[] = {
+	SIGSEGV, SIGABRT, SIGFPE, SIGILL,
+#if !defined(_WIN32) && !defined(_WIN64)
+	SIGBUS,
+#endif
+};
+
+#if defined(_WIN32) || defined(_WIN64)
+static void (*prev_handlers[sizeof(crash_signals) / sizeof(int)])(int);
+#else
+static struct sigaction prev_handlers[sizeof(crash_signals) / sizeof(int)];
+#endif
+
+static uint64_t current_thread_id()
+{
+#if defined(_WIN32) || defined(_WIN64)
+	return (uint64_t)GetCurrentThreadId();
+#elif defined(__linux__)
+	return (uint64_t)syscall(SYS_gettid);
+#else
+	return (uint64_t)(uintptr_t)pthread_self();
+#endif
+}
+
+static TraceRing* create_ring()
+{
+	int n = ring_count.load(std::memory_order_relaxed);
+	if (n >= GIXSQL_TRACE_RING_MAX_THREADS)
+		return nullptr;
+
+	TraceRing* r = new TraceRing();
+	r->thread_id = current_thread_id();
+	r->size = ring_size;
+	r->events = new TraceEvent[ring_size]();
+
+	// claim a slot, publish the ring only when it is fully initialized
+	n = ring_count.fetch_add(1);
+	if (n >= GIXSQL_TRACE_RING_MAX_THREADS) {
+		delete[] r->events;
+		delete r;
+		return nullptr;
+	}
+	rings[n].store(r, std::memory_order_release);
+	return r;
+}
+
+uint64_t trace_ring_now()
+{
+	return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void trace_ring_record(uint16_t event_id, uint16_t flags, uint32_t handle, uint64_t ref, int64_t value, const char* payload, size_t payload_len)
+{
+	thread_local TraceRing* ring = nullptr;
+	thread_local bool no_ring = false;
+
+	if (!ring) {
+		if (no_ring)
+			return;
+
+		ring = create_ring();
+		if (!ring) {
+			no_ring = true;
+			return;
+		}
+	}
+
+	uint64_t h = ring->head.load(std::memory_order_relaxed);
+	TraceEvent& e = ring->events[h & (ring->size - 1)];
+	e.timestamp = trace_ring_now();
+	e.event_id = event_id;
+	e.flags = flags;
+	e.handle = handle;
+	e.ref = ref;
+	e.value = value;
+
+	size_t l = 0;
+	if (payload && payload_len) {
+		l = payload_len < TRACE_PAYLOAD_SIZE ? payload_len : TRACE_PAYLOAD_SIZE;
+		memcpy(e.payload, payload, l);
+		if (payload_len > TRACE_PAYLOAD_SIZE)
+			e.flags |= TRACE_FLAG_TRUNCATED;
+	}
+	if (l < TRACE_PAYLOAD_SIZE)
+		memset(e.payload + l, 0, TRACE_PAYLOAD_SIZE - l);
+
+	ring->head.store(h + 1, std::memory_order_release);
+}
+
+static bool write_all(int fd, const void* data, size_t len)
+{
+	const char* p = (const char*)data;
+	while (len > 0) {
+		auto n = trace_write(fd, p, (unsigned int)len);
+		if (n <= 0)
+			return false;
+		p += n;
+		len -= n;
+	}
+	return true;
+}
+
+// Only uses async-signal-safe calls (no allocations, no locks): it is also called from the crash handler.
+// Events being written by other threads while the dump runs may be inconsistent
+bool trace_ring_dump(const char* filename)
+{
+	if (!filename)
+		filename = dump_file;
+
+	int fd = trace_open(filename);
+	if (fd < 0)
+		return false;
+
+	int nrings = ring_count.load(std::memory_order_acquire);
+	if (nrings > GIXSQL_TRACE_RING_MAX_THREADS)
+		nrings = GIXSQL_TRACE_RING_MAX_THREADS;
+
+	TraceFileHeader hdr;
+	memset(&hdr, 0, sizeof(TraceFileHeader));
+	memcpy(hdr.magic, TRACE_FILE_MAGIC, 8);
+	hdr.version = TRACE_FILE_VERSION;
+	hdr.event_size = sizeof(TraceEvent);
+	hdr.byte_order = TRACE_BYTE_ORDER_MARK;
+	hdr.pid = (uint64_t)getpid();
+	hdr.wall_clock_ns = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+	hdr.steady_clock_ns = trace_ring_now();
+
+	// a ring might still be in the process of being published
+	TraceRing* ready[GIXSQL_TRACE_RING_MAX_THREADS];
+	int n_ready = 0;
+	for (int i = 0; i < nrings; i++) {
+		TraceRing* r = rings[i].load(std::memory_order_acquire);
+		if (r)
+			ready[n_ready++] = r;
+	}
+	hdr.thread_count = n_ready;
+
+	bool ok = write_all(fd, &hdr, sizeof(TraceFileHeader));
+	for (int i = 0; ok && i < n_ready; i++) {
+		TraceRing* r = ready[i];
+
+		uint64_t head = r->head.load(std::memory_order_acquire);
+		uint64_t count = head < r->size ? head : r->size;
+		uint64_t first = head - count;
+
+		TraceThreadHeader th;
+		th.thread_id = r->thread_id;
+		th.event_count = count;
+		th.dropped = first;
+		ok = write_all(fd, &th, sizeof(TraceThreadHeader));
+
+		// oldest first: the events from the start position to the end of the buffer, then the ones before it
+		uint64_t start = first & (r->size - 1);
+		uint64_t n1 = (start + count <= r->size) ? count : r->size - start;
+		if (ok && n1)
+			ok = write_all(fd, r->events + start, n1 * sizeof(TraceEvent));
+		if (ok && count > n1)
+			ok = write_all(fd, r->events, (count - n1) * sizeof(TraceEvent));
+	}
+
+	trace_close(fd);
+	return ok;
+}
+
+static void crash_handler(int sig)
+{
+	trace_ring_dump(nullptr);
+
+	// restore the previous handler (e.g. the one from the COBOL runtime) and raise the signal again
+	for (size_t i = 0; i < sizeof(crash_signals) / sizeof(int); i++) {
+		if (crash_signals[i] == sig) {
+#if defined(_WIN32) || defined(_WIN64)
+			signal(sig, prev_handlers[i]);
+#else
+			sigaction(sig, &prev_handlers[i], nullptr);
+#endif
+		}
+	}
+	raise(sig);
+}
+
+void trace_ring_init()
+{
+	char* c = getenv("GIXSQL_TRACE_RING");
+	if (!c)
+		return;
+
+	std::string s = to_lower(c);
+	if (s != "on" && s != "1")
+		return;
+
+#if defined(GIXSQL_NO_TRACE_RING)
+	spdlog::warn("GixSQL: GIXSQL_TRACE_RING is set, but tracing was disabled at compile time");
+#else
+	c = getenv("GIXSQL_TRACE_RING_SIZE");
+	if (c && atoi(c) > 0) {
+		// round up to a power of 2
+		uint64_t n = (uint64_t)atoi(c);
+		ring_size = 1;
+		while (ring_size < n)
+			ring_size <<= 1;
+	}
+
+	c = getenv("GIXSQL_TRACE_RING_FILE");
+	std::string filename = c ? c : DEFAULT_GIXSQL_TRACE_RING_FILE;
+	if (filename.find("$$") != std::string::npos) {
+		filename = string_replace(filename, "$$", std::to_string(getpid()));
+	}
+	if (filename.size() >= sizeof(dump_file)) {
+		spdlog::error("GixSQL: trace dump file name too long: {}", filename);
+		return;
+	}
+	strcpy(dump_file, filename.c_str());
+
+	for (size_t i = 0; i < sizeof(crash_signals) / sizeof(int); i++) {
+#if defined(_WIN32) || defined(_WIN64)
+		prev_handlers[i] = signal(crash_signals[i], crash_handler);
+#else
+		struct sigaction sa;
+		memset(&sa, 0, sizeof(struct sigaction));
+		sa.sa_handler = crash_handler;
+		sigemptyset(&sa.sa_mask);
+		sa.sa_flags = SA_RESETHAND;
+		sigaction(crash_signals[i], &sa, &prev_handlers[i]);
+#endif
+	}
+
+	__trace_ring_enabled = true;
+	spdlog::info("GixSQL: trace ring enabled ({} events per thread, dump file: {})", ring_size, dump_file);
+#endif
+}
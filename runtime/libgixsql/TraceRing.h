@@ -0,0 +1,94 @@
+/*
+* This file is part of Gix-IDE, an IDE and platform for GnuCOBOL
+* Copyright (C) 2021 Marco Ridoni
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public License
+* as published by the Free Software Foundation; either version 3,
+* or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; see the file COPYING.LIB.  If
+* not, write to the Free Software Foundation, 51 Franklin Street, Fifth Floor
+* Boston, MA 02110-1301 USA
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "trace_events.h"
+
+// Low-overhead tracing: fixed-size binary events are written to a per-thread ring buffer
+// (no locks, no formatting) and can be dumped to a file with GIXSQLTraceDump or, if the 
+// process crashes, by a signal handler. The dumps are decoded with gixsql-trace.
+// Tracing is enabled at runtime with GIXSQL_TRACE_RING=on and can be compiled out 
+// altogether by defining GIXSQL_NO_TRACE_RING (configure --disable-trace-ring).
+
+#define DEFAULT_GIXSQL_TRACE_RING_SIZE	16384
+#define DEFAULT_GIXSQL_TRACE_RING_FILE	"gixsql-trace-$$.bin"
+#define GIXSQL_TRACE_RING_MAX_THREADS	256
+
+extern bool __trace_ring_enabled;
+
+void trace_ring_init();
+void trace_ring_record(uint16_t event_id, uint16_t flags, uint32_t handle, uint64_t ref, int64_t value, const char* payload, size_t payload_len);
+bool trace_ring_dump(const char* filename = nullptr);
+uint64_t trace_ring_now();
+
+// Records a BEGIN event when created and an END event (with the elapsed time) when destroyed
+class TraceScope
+{
+public:
+	TraceScope(uint16_t _event_id, uint32_t _handle, const char* payload)
+	{
+		if (!__trace_ring_enabled)
+			return;
+
+		event_id = _event_id;
+		handle = _handle;
+		start = trace_ring_now();
+		trace_ring_record(event_id, TRACE_FLAG_BEGIN, handle, 0, 0, payload, payload ? strlen(payload) : 0);
+	}
+
+	~TraceScope()
+	{
+		if (event_id)
+			trace_ring_record(event_id, TRACE_FLAG_END, handle, 0, (int64_t)(trace_ring_now() - start), nullptr, 0);
+	}
+
+	void setHandle(uint32_t h)
+	{
+		handle = h;
+	}
+
+private:
+	uint16_t event_id = 0;
+	uint32_t handle = 0;
+	uint64_t start = 0;
+};
+
+#if !defined(GIXSQL_NO_TRACE_RING)
+
+#define GIX_TRACE(_ID, _HANDLE, _REF, _VALUE, _PAYLOAD, _PAYLOAD_LEN) \
+	do { if (__trace_ring_enabled) trace_ring_record((_ID), TRACE_FLAG_NONE, (uint32_t)(_HANDLE), (uint64_t)(uintptr_t)(_REF), (int64_t)(_VALUE), (_PAYLOAD), (_PAYLOAD_LEN)); } while (0)
+
+#define GIX_TRACE_SCOPE(_ID, _HANDLE, _PAYLOAD) \
+	TraceScope __trace_scope((_ID), (uint32_t)(_HANDLE), (_PAYLOAD))
+
+#define GIX_TRACE_SCOPE_HANDLE(_HANDLE)	__trace_scope.setHandle((uint32_t)(_HANDLE))
+
+#else
+
+#define GIX_TRACE(_ID, _HANDLE, _REF, _VALUE, _PAYLOAD, _PAYLOAD_LEN)	do { } while (0)
+#define GIX_TRACE_SCOPE(_ID, _HANDLE, _PAYLOAD)
+#define GIX_TRACE_SCOPE_HANDLE(_HANDLE)
+
+#endif
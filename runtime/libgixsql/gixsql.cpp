@@ -27,6 +27,8 @@
 #include <string>
 #include <cstring>
 #include <memory>
+#include <regex>
+#include <fstream>
 
 #if (defined(_WIN32) || defined(_WIN64)) && !defined(__MINGW32__)
 #include <io.h>
@@ -44,6 +46,12 @@
 #include "DataSourceInfo.h"
 #include "SqlVar.h"
 #include "SqlVarList.h"
+#include "StatementRegistry.h"
+#include "SlowStatementLog.h"
+#include "TraceRing.h"
+#include "ResultCache.h"
+#include "StatementWatchdog.h"
+#include "PreparedStatementCache.h"
 
 #include "IDbInterface.h"
 #include "IConnection.h"
@@ -58,6 +66,7 @@
 #include "spdlog/sinks/rotating_file_sink.h"
 
 #include "cobol_var_types.h"
+#include "stmt_flags.h"
 #include "GlobalEnv.h"
 
 #define FAIL_ON_ERROR(_rc, _st, _dbi, _err) if (_rc != DBERR_NO_ERROR) { \
@@ -65,6 +74,15 @@
 										return RESULT_FAILED; \
 								   }
 
+// As FAIL_ON_ERROR, but a statement cancelled by its watchdog always fails with DBERR_STATEMENT_TIMEOUT
+#define FAIL_ON_ERROR_OR_TIMEOUT(_rc, _st, _dbi, _err, _wd) if (_rc != DBERR_NO_ERROR) { \
+										if (_wd.expired()) \
+											setStatus(_st, NULL, DBERR_STATEMENT_TIMEOUT); \
+										else \
+											setStatus(_st, _dbi, _err); \
+										return RESULT_FAILED; \
+								   }
+
 #define CHECK_LIB_INIT() if (!__lib_initialized) gixsql_initialize();
 
 bool __lib_initialized = false;
@@ -77,6 +95,7 @@ struct query_info {
 
 static ConnectionManager connection_manager;
 static CursorManager cursor_manager;
+static StatementRegistry statement_registry;
 
 
 static void sqlca_initialize(struct sqlca_t*);
@@ -84,18 +103,41 @@ static int setStatus(struct sqlca_t* st, std::shared_ptr<IDbInterface> dbi, int
 static AutoCommitMode get_autocommit(const std::shared_ptr<DataSourceInfo>& ds);
 static bool get_fixup_params(const std::shared_ptr<DataSourceInfo>&);
 static std::string get_client_encoding(const std::shared_ptr<DataSourceInfo>&);
+static int get_slow_log_threshold(const std::shared_ptr<DataSourceInfo>&);
+static bool get_slow_log_params(const std::shared_ptr<DataSourceInfo>&);
+static bool get_slow_log_explain(const std::shared_ptr<DataSourceInfo>&);
+static std::vector<std::string> get_slow_log_masked_columns(const std::shared_ptr<DataSourceInfo>&);
+static std::string get_read_replica(const std::shared_ptr<DataSourceInfo>&);
+static std::shared_ptr<ResultCache> create_result_cache(const std::shared_ptr<DataSourceInfo>&);
+static int get_statement_timeout(const std::shared_ptr<DataSourceInfo>&);
+static int get_max_prepared_statements(const std::shared_ptr<DataSourceInfo>&);
 static void init_sql_var_list(void);
 static bool is_signed_numeric(CobolVarType t);
+static bool read_resultset_value(const std::shared_ptr<IDbInterface>& dbi, ResultSetContextType rs_type, const IResultSetContextData& ctx, int col, SqlVar* v, bool is_direct, char* bfr, uint64_t bfrlen, uint64_t* datalen, bool* is_null);
 
 /* sql var list */
 SqlVarList _current_sql_var_list;
 SqlVarList _res_sql_var_list;
 
-static int _gixsqlExec(const std::shared_ptr<IConnection>& conn, struct sqlca_t* st, char* _query);
-static int _gixsqlExecParams(const std::shared_ptr<IConnection>& conn, struct sqlca_t* st, char* _query, unsigned int nParams);
+/* statement flags (see GIXSQLSetStatementFlags) */
+static uint32_t _current_stmt_flags = STMT_FLAG_NONE;
+
+/* timeout for the next statement, -1 = connection default (see GIXSQLSetStatementTimeout) */
+static int _next_stmt_timeout = -1;
+
+static int _gixsqlExec(const std::shared_ptr<IConnection>& conn, struct sqlca_t* st, char* _query, SlowStatementTimer& timer);
+static int _gixsqlExecParams(const std::shared_ptr<IConnection>& conn, struct sqlca_t* st, char* _query, unsigned int nParams, SlowStatementTimer& timer);
 static int _gixsqlCursorDeclare(struct sqlca_t* st, std::shared_ptr<IConnection> conn, std::string connection_name, std::string cursor_name, int with_hold, void* d_query, int query_tl, int nParams);
-static int _gixsqlExecPrepared(sqlca_t* st, void* d_connection_id, int connection_id_tl, char* stmt_name, int nParams, std::shared_ptr<IDbInterface>& _dbi);
+static int _gixsqlExecPrepared(sqlca_t* st, void* d_connection_id, int connection_id_tl, char* stmt_name, int nParams, std::shared_ptr<IDbInterface>& _dbi, SlowStatementTimer& timer);
 static int _gixsqlConnectReset(struct sqlca_t* st, const std::string& connection_id);
+static void prepare_static_statements(const std::shared_ptr<IConnection>& conn);
+static bool is_read_only_query(const std::string& query);
+static void track_write_transaction(const std::shared_ptr<IConnection>& conn, const std::string& query);
+static std::shared_ptr<IConnection> route_read(const std::shared_ptr<IConnection>& conn, const std::string& query, const std::string& what);
+static std::shared_ptr<ResultCache> get_result_cache(const std::shared_ptr<IConnection>& conn);
+static void invalidate_result_cache(const std::shared_ptr<IConnection>& conn, const std::string& query);
+static int statement_timeout(const std::shared_ptr<IConnection>& conn);
+static void touch_prepared_statement(const std::shared_ptr<IConnection>& conn, const std::string& stmt_name);
 
 static std::string get_hostref_or_literal(void* data, int connection_id_tl);
 
@@ -125,6 +167,8 @@ GIXSQLConnect(struct sqlca_t* st, void* d_data_source, int data_source_tl, void*
 {
 	CHECK_LIB_INIT();
 
+	GIX_TRACE_SCOPE(TRACE_EV_CONNECT, 0, nullptr);
+
 	spdlog::debug(FMT_FILE_FUNC "GIXSQLConnect start", __FILE__, __func__);
 
 	std::string data_source_info;
@@ -171,12 +215,23 @@ GIXSQLConnect(struct sqlca_t* st, void* d_data_source, int data_source_tl, void*
 	opts->autocommit = get_autocommit(data_source);;
 	opts->fixup_parameters = get_fixup_params(data_source);
 	opts->client_encoding = get_client_encoding(data_source);
+	opts->slow_log_threshold = get_slow_log_threshold(data_source);
+	opts->slow_log_params = get_slow_log_params(data_source);
+	opts->slow_log_explain = get_slow_log_explain(data_source);
+	opts->slow_log_masked_columns = get_slow_log_masked_columns(data_source);
+	opts->read_replica = get_read_replica(data_source);
+	opts->statement_timeout = get_statement_timeout(data_source);
+	opts->max_prepared_statements = get_max_prepared_statements(data_source);
 
 	spdlog::trace(FMT_FILE_FUNC "Connection string : {}", __FILE__, __func__, data_source->get());
 	spdlog::trace(FMT_FILE_FUNC "Data source info  : {}", __FILE__, __func__, data_source->dump());
 	spdlog::trace(FMT_FILE_FUNC "Autocommit        : {}", __FILE__, __func__, (int)opts->autocommit);
 	spdlog::trace(FMT_FILE_FUNC "Fix up parameters : {}", __FILE__, __func__, opts->fixup_parameters);
 	spdlog::trace(FMT_FILE_FUNC "Client encoding   : {}", __FILE__, __func__, opts->client_encoding);
+	spdlog::trace(FMT_FILE_FUNC "Slow log (ms)     : {}", __FILE__, __func__, opts->slow_log_threshold);
+	spdlog::trace(FMT_FILE_FUNC "Read replica      : {}", __FILE__, __func__, !opts->read_replica.empty());
+	spdlog::trace(FMT_FILE_FUNC "Timeout (ms)      : {}", __FILE__, __func__, opts->statement_timeout);
+	spdlog::trace(FMT_FILE_FUNC "Max prepared stmts: {}", __FILE__, __func__, opts->max_prepared_statements);
 
 	rc = dbi->connect(data_source, opts);
 	if (rc != DBERR_NO_ERROR) {
@@ -190,8 +245,14 @@ GIXSQLConnect(struct sqlca_t* st, void* d_data_source, int data_source_tl, void*
 	c->setConnectionOptions(opts);	// Generic/global connection options, separate from driver-specific options that reside only in the data source info
 	c->setConnectionInfo(data_source);
 	c->setDbInterface(dbi);
+	c->setResultCache(create_result_cache(data_source));
+	c->setPreparedStatements(std::make_shared<PreparedStatementCache>(opts->max_prepared_statements));
 	c->setOpened(true);
 	connection_manager.add(c);
+	GIX_TRACE_SCOPE_HANDLE(c->getId());
+
+	if (opts->slow_log_threshold > 0)
+		SlowStatementLog::enable();
 
 	spdlog::debug(FMT_FILE_FUNC "connection success. connection id# = {}, connection id = [{}]", __FILE__, __func__, c->getId(), connection_id);
 
@@ -208,6 +269,13 @@ int _gixsqlConnectReset(struct sqlca_t* st, const std::string& connection_id)
 	}
 
 	cursor_manager.clearConnectionCursors(conn->getId(), true);
+	statement_registry.removeConnection(conn->getId());
+
+	std::shared_ptr<Connection> replica = connection_manager.getReplica(conn->getId());
+	if (replica) {
+		replica->getDbInterface()->reset();
+		replica->setOpened(false);
+	}
 
 	std::shared_ptr<IDbInterface> dbi = conn->getDbInterface();
 	int rc = dbi->reset();
@@ -254,9 +322,13 @@ GIXSQLExec(struct sqlca_t* st, void* d_connection_id, int connection_id_tl, char
 {
 	CHECK_LIB_INIT();
 
+	GIX_TRACE_SCOPE(TRACE_EV_EXEC, 0, _query);
+
 	spdlog::trace(FMT_FILE_FUNC "GIXSQLExec start", __FILE__, __func__);
 	spdlog::trace(FMT_FILE_FUNC "GIXSQLExec SQL: {}", __FILE__, __func__, _query);
 
+	SlowStatementTimer timer(__func__);
+
 	std::string connection_id = get_hostref_or_literal(d_connection_id, connection_id_tl);
 	std::shared_ptr<Connection> conn = connection_manager.get(connection_id);
 	if (conn == NULL) {
@@ -273,7 +345,11 @@ GIXSQLExec(struct sqlca_t* st, void* d_connection_id, int connection_id_tl, char
 		return RESULT_FAILED;
 	}
 
-	return _gixsqlExec(conn, st, _query);
+	GIX_TRACE_SCOPE_HANDLE(conn->getId());
+	timer.setConnection(conn);
+	timer.setStatement(std::string(), _query);
+
+	return _gixsqlExec(conn, st, _query, timer);
 }
 
 LIBGIXSQL_API int
@@ -281,8 +357,12 @@ GIXSQLExecImmediate(struct sqlca_t* st, void* d_connection_id, int connection_id
 {
 	CHECK_LIB_INIT();
 
+	GIX_TRACE_SCOPE(TRACE_EV_EXEC, 0, nullptr);
+
 	spdlog::trace(FMT_FILE_FUNC "GIXSQLExecImmediate start", __FILE__, __func__);
 
+	SlowStatementTimer timer(__func__);
+
 	std::string connection_id = get_hostref_or_literal(d_connection_id, connection_id_tl);
 	std::shared_ptr<Connection> conn = connection_manager.get(connection_id);
 	if (conn == NULL) {
@@ -303,10 +383,14 @@ GIXSQLExecImmediate(struct sqlca_t* st, void* d_connection_id, int connection_id
 		return RESULT_FAILED;
 	}
 
-	return _gixsqlExec(conn, st, (char*)query.c_str());
+	GIX_TRACE_SCOPE_HANDLE(conn->getId());
+	timer.setConnection(conn);
+	timer.setStatement(std::string(), query);
+
+	return _gixsqlExec(conn, st, (char*)query.c_str(), timer);
 }
 
-static int _gixsqlExec(const std::shared_ptr<IConnection>& conn, struct sqlca_t* st, char* _query)
+static int _gixsqlExec(const std::shared_ptr<IConnection>& conn, struct sqlca_t* st, char* _query, SlowStatementTimer& timer)
 {
 	CHECK_LIB_INIT();
 
@@ -314,12 +398,24 @@ static int _gixsqlExec(const std::shared_ptr<IConnection>& conn, struct sqlca_t*
 	int rc = 0;
 	std::shared_ptr<IDbInterface> dbi = conn->getDbInterface();
 
-	if (is_commit_or_rollback_statement(query)) {
+	bool is_tx_termination = STMT_IS_CLASSIFIED(_current_stmt_flags) ? STMT_IS_TX_TERMINATION(_current_stmt_flags) : is_commit_or_rollback_statement(query);
+	if (is_tx_termination) {
 		cursor_manager.closeConnectionCursors(conn->getId(), false);
 	}
 
+	track_write_transaction(conn, query);
+	invalidate_result_cache(conn, query);
+	prepare_static_statements(conn);
+
+	timer.startPhase(SlowLogPhase::Execute);
+	StatementWatchdog watchdog(dbi, statement_timeout(conn));
+	dbi->set_statement_flags(_current_stmt_flags);
 	rc = dbi->exec(query);
-	FAIL_ON_ERROR(rc, st, dbi, DBERR_SQL_ERROR)
+	dbi->set_statement_flags(STMT_FLAG_NONE);
+	FAIL_ON_ERROR_OR_TIMEOUT(rc, st, dbi, DBERR_SQL_ERROR, watchdog)
+
+	if (timer.exceeded() && dbi->has(DbNativeFeature::ResultSetRowCount))
+		timer.setRowCount(dbi->get_num_rows(nullptr));
 
 
 		setStatus(st, NULL, DBERR_NO_ERROR);
@@ -331,8 +427,12 @@ GIXSQLExecParams(struct sqlca_t* st, void* d_connection_id, int connection_id_tl
 {
 	CHECK_LIB_INIT();
 
+	GIX_TRACE_SCOPE(TRACE_EV_EXEC_PARAMS, 0, _query);
+
 	spdlog::trace(FMT_FILE_FUNC "GIXSQLExecParams - SQL: {}", __FILE__, __func__, _query);
 
+	SlowStatementTimer timer(__func__);
+
 	std::string connection_id = get_hostref_or_literal(d_connection_id, connection_id_tl);
 	std::shared_ptr<Connection> conn = connection_manager.get(connection_id);
 	if (conn == NULL) {
@@ -358,11 +458,14 @@ GIXSQLExecParams(struct sqlca_t* st, void* d_connection_id, int connection_id_tl
 		return RESULT_FAILED;
 	}
 
+	GIX_TRACE_SCOPE_HANDLE(conn->getId());
+	timer.setConnection(conn);
+	timer.setStatement(std::string(), _query);
 
-	return _gixsqlExecParams(conn, st, _query, nParams);
+	return _gixsqlExecParams(conn, st, _query, nParams, timer);
 }
 
-static int _gixsqlExecParams(const std::shared_ptr<IConnection>& conn, struct sqlca_t* st, char* _query, unsigned int nParams)
+static int _gixsqlExecParams(const std::shared_ptr<IConnection>& conn, struct sqlca_t* st, char* _query, unsigned int nParams, SlowStatementTimer& timer)
 {
 	std::vector<std_binary_data> param_values;
 	std::vector<CobolVarType> param_types;
@@ -386,18 +489,31 @@ static int _gixsqlExecParams(const std::shared_ptr<IConnection>& conn, struct sq
 		FAIL_ON_ERROR(1, st, dbi, DBERR_SQL_ERROR);
 	}
 
-	if (is_commit_or_rollback_statement(query)) {
+	bool is_tx_termination = STMT_IS_CLASSIFIED(_current_stmt_flags) ? STMT_IS_TX_TERMINATION(_current_stmt_flags) : is_commit_or_rollback_statement(query);
+	if (is_tx_termination) {
 		cursor_manager.closeConnectionCursors(conn->getId(), false);
 	}
 
+	track_write_transaction(conn, query);
+	invalidate_result_cache(conn, query);
+	prepare_static_statements(conn);
+
+	timer.setParameters(&_current_sql_var_list);
+	timer.startPhase(SlowLogPhase::Execute);
+	StatementWatchdog watchdog(dbi, statement_timeout(conn));
+	dbi->set_statement_flags(_current_stmt_flags);
 	rc = dbi->exec_params(query, param_types, param_values, param_lengths, param_flags);
-	FAIL_ON_ERROR(rc, st, dbi, DBERR_SQL_ERROR)
+	dbi->set_statement_flags(STMT_FLAG_NONE);
+	FAIL_ON_ERROR_OR_TIMEOUT(rc, st, dbi, DBERR_SQL_ERROR, watchdog)
+
+	if (timer.exceeded() && dbi->has(DbNativeFeature::ResultSetRowCount))
+		timer.setRowCount(dbi->get_num_rows(nullptr));
 
 		setStatus(st, NULL, DBERR_NO_ERROR);
 	return RESULT_SUCCESS;
 }
 
-int _gixsqlExecPrepared(sqlca_t* st, void* d_connection_id, int connection_id_tl, char* stmt_name, int nParams, std::shared_ptr<IDbInterface>& r_dbi)
+int _gixsqlExecPrepared(sqlca_t* st, void* d_connection_id, int connection_id_tl, char* stmt_name, int nParams, std::shared_ptr<IDbInterface>& r_dbi, SlowStatementTimer& timer)
 {
 	CHECK_LIB_INIT();
 
@@ -443,13 +559,23 @@ int _gixsqlExecPrepared(sqlca_t* st, void* d_connection_id, int connection_id_tl
 		param_flags.push_back((*it)->getFlags());
 	}
 
+	timer.setConnection(conn);
+	timer.setStatement(stmt_name, std::string());
+	timer.setParameters(&_current_sql_var_list);
+
 	int rc = 0;
 	std::shared_ptr<IDbInterface> dbi = conn->getDbInterface();
 	if (!dbi)
 		FAIL_ON_ERROR(1, st, dbi, DBERR_SQL_ERROR)
 
-		rc = dbi->exec_prepared(stmt_name, param_types, param_values, param_lengths, param_flags);
-	FAIL_ON_ERROR(rc, st, dbi, DBERR_SQL_ERROR)
+	track_write_transaction(conn, std::string());
+	invalidate_result_cache(conn, std::string());
+	touch_prepared_statement(conn, stmt_name);
+
+	timer.startPhase(SlowLogPhase::Execute);
+	StatementWatchdog watchdog(dbi, statement_timeout(conn));
+	rc = dbi->exec_prepared(stmt_name, param_types, param_values, param_lengths, param_flags);
+	FAIL_ON_ERROR_OR_TIMEOUT(rc, st, dbi, DBERR_SQL_ERROR, watchdog)
 
 		setStatus(st, NULL, DBERR_NO_ERROR);
 
@@ -461,22 +587,31 @@ LIBGIXSQL_API int GIXSQLExecPrepared(sqlca_t* st, void* d_connection_id, int con
 {
 	CHECK_LIB_INIT();
 
+	GIX_TRACE_SCOPE(TRACE_EV_EXEC_PREPARED, 0, stmt_name);
+
 	std::shared_ptr<IDbInterface> dbi;	// not used but we need it for the call to the worker function
 	spdlog::trace(FMT_FILE_FUNC "GIXSQLExecPrepared start", __FILE__, __func__);
-	return _gixsqlExecPrepared(st, d_connection_id, connection_id_tl, stmt_name, nParams, dbi);
+
+	SlowStatementTimer timer(__func__);
+	return _gixsqlExecPrepared(st, d_connection_id, connection_id_tl, stmt_name, nParams, dbi, timer);
 }
 
 LIBGIXSQL_API int GIXSQLExecPreparedInto(sqlca_t* st, void* d_connection_id, int connection_id_tl, char* stmt_name, int nParams, int nResParams)
 {
 	CHECK_LIB_INIT();
 
+	GIX_TRACE_SCOPE(TRACE_EV_EXEC_PREPARED, 0, stmt_name);
+
 	std::shared_ptr<IDbInterface> dbi;
 	spdlog::trace(FMT_FILE_FUNC "GIXSQLExecPreparedInto start", __FILE__, __func__);
 
-	int rc = _gixsqlExecPrepared(st, d_connection_id, connection_id_tl, stmt_name, nParams, dbi);
+	SlowStatementTimer timer(__func__);
+	int rc = _gixsqlExecPrepared(st, d_connection_id, connection_id_tl, stmt_name, nParams, dbi, timer);
 	if (rc != RESULT_SUCCESS)
 		return rc;
 
+	timer.startPhase(SlowLogPhase::Fetch);
+
 	if (!dbi->move_to_first_record(stmt_name)) {
 		spdlog::error("move_to_first_record failed: {} - {}:", dbi->get_error_code(), dbi->get_state(), dbi->get_error_message());
 		setStatus(st, dbi, dbi->get_error_code());
@@ -513,20 +648,25 @@ LIBGIXSQL_API int GIXSQLExecPreparedInto(sqlca_t* st, void* d_connection_id, int
 	uint64_t datalen = 0;
 	int sqlcode = 0;
 	bool has_invalid_column_data = false;
-	uint64_t bsize = _res_sql_var_list.getMaxLength() + __global_env->varlen_length_sz() + 1;
+	bool direct_read = dbi->has(DbNativeFeature::DirectLobRead);
+	uint64_t bsize = _res_sql_var_list.getMaxLength(direct_read) + __global_env->varlen_length_sz() + 1;
 
 	std::unique_ptr<char[]> buffer = std::make_unique<char[]>(bsize);
 	for (int i = 0; i < _res_sql_var_list.size(); i++) {
 		SqlVar* v = _res_sql_var_list.at(i);
 		bool is_null = false;
-		if (!dbi->get_resultset_value(ResultSetContextType::PreparedStatement, PreparedStatementContextData(stmt_name), 0, i, buffer.get(), bsize, &datalen, &is_null)) {
+		bool is_direct = direct_read && v->canReadDirect();
+		if (!read_resultset_value(dbi, ResultSetContextType::PreparedStatement, PreparedStatementContextData(stmt_name), i, v, is_direct, buffer.get(), bsize, &datalen, &is_null)) {
 			setStatus(st, dbi, DBERR_INVALID_COLUMN_DATA);
 			sqlcode = DBERR_INVALID_COLUMN_DATA;
 			continue;
 		}
 
 		int sql_code_local = DBERR_NO_ERROR;
-		v->createCobolData(buffer.get(), datalen, &sql_code_local);
+		if (is_direct)
+			v->createCobolDataDirect(datalen, &sql_code_local);
+		else
+			v->createCobolData(buffer.get(), datalen, &sql_code_local);
 		if (sql_code_local) {
 			setStatus(st, dbi, sql_code_local);
 			sqlcode = sql_code_local;
@@ -540,6 +680,7 @@ LIBGIXSQL_API int GIXSQLExecPreparedInto(sqlca_t* st, void* d_connection_id, int
 		return RESULT_FAILED;
 	}
 
+	timer.setRowCount(1);
 	setStatus(st, NULL, DBERR_NO_ERROR);
 	return RESULT_SUCCESS;
 }
@@ -549,6 +690,8 @@ GIXSQLCursorDeclareParams(struct sqlca_t* st, void* d_connection_id, int connect
 {
 	CHECK_LIB_INIT();
 
+	GIX_TRACE_SCOPE(TRACE_EV_CURSOR_DECLARE, 0, cursor_name);
+
 	spdlog::trace(FMT_FILE_FUNC "GIXSQLCursorDeclareParams start for cursor [{}]", __FILE__, __func__, cursor_name);
 
 	bool is_literal = (query_tl == 0);
@@ -605,6 +748,8 @@ GIXSQLCursorDeclare(struct sqlca_t* st, void* d_connection_id, int connection_id
 {
 	CHECK_LIB_INIT();
 
+	GIX_TRACE_SCOPE(TRACE_EV_CURSOR_DECLARE, 0, cursor_name);
+
 	spdlog::trace(FMT_FILE_FUNC "GIXSQLCursorDeclare start for cursor [{}]", __FILE__, __func__, cursor_name);
 
 	bool is_literal = (query_tl == 0);
@@ -686,10 +831,14 @@ GIXSQLCursorOpen(struct sqlca_t* st, char* cname)
 {
 	CHECK_LIB_INIT();
 
+	GIX_TRACE_SCOPE(TRACE_EV_CURSOR_OPEN, 0, cname);
+
 	int rc = 0;
 
 	spdlog::trace(FMT_FILE_FUNC "GIXSQLCursorOpen start for cursor [{}]", __FILE__, __func__, cname);
 
+	SlowStatementTimer timer(__func__);
+
 	sqlca_initialize(st);
 
 	// check argument
@@ -748,9 +897,32 @@ GIXSQLCursorOpen(struct sqlca_t* st, char* cname)
 		return RESULT_FAILED;
 	}
 
+	// read/write splitting: a cursor can move between the primary connection and its replica each time it is opened
+	if (!cursor->isOpen()) {
+		std::string crsr_query = crsr_src_addr ? trim_copy(get_hostref_or_literal(crsr_src_addr, crsr_src_len)) : cursor->getQuery();
+		std::shared_ptr<IConnection> target = route_read(cursor->getConnection(), crsr_query, std::string("cursor ") + cname);
+		if (target != cursor->getConnection()) {
+			cursor->setConnection(target);
+			if (target->getDbInterface()->cursor_declare(cursor)) {
+				spdlog::error("Invalid cursor data: {}", cname);
+				setStatus(st, NULL, DBERR_DECLARE_CURSOR_FAILED);
+				return RESULT_FAILED;
+			}
+		}
+		track_write_transaction(target, crsr_query);
+
+		if (starts_with(crsr_query, "@"))
+			touch_prepared_statement(target, crsr_query.substr(1));
+	}
+
 	std::shared_ptr<IConnection> c = cursor->getConnection();
 	std::shared_ptr<IDbInterface> dbi = c->getDbInterface();
 
+	GIX_TRACE_SCOPE_HANDLE(c->getId());
+	timer.setConnection(c);
+	timer.setStatement(cname, cursor->getQuery());
+	timer.setParameters(&cursor->getParameters());
+
 	if (cursor->isOpen()) {
 		spdlog::error("cursor {} is alredy open", cname);
 		rc = dbi->cursor_close(cursor);
@@ -758,9 +930,11 @@ GIXSQLCursorOpen(struct sqlca_t* st, char* cname)
 		FAIL_ON_ERROR(rc, st, dbi, DBERR_CLOSE_CURSOR_FAILED)
 	}
 
+	timer.startPhase(SlowLogPhase::Execute);
+	StatementWatchdog watchdog(dbi, statement_timeout(c));
 	rc = dbi->cursor_open(cursor);
 	cursor->setOpened(rc == DBERR_NO_ERROR);
-	FAIL_ON_ERROR(rc, st, dbi, DBERR_OPEN_CURSOR_FAILED)
+	FAIL_ON_ERROR_OR_TIMEOUT(rc, st, dbi, DBERR_OPEN_CURSOR_FAILED, watchdog)
 
 		setStatus(st, NULL, DBERR_NO_ERROR);
 	return RESULT_SUCCESS;
@@ -770,8 +944,12 @@ LIBGIXSQL_API int GIXSQLCursorFetchOne(struct sqlca_t* st, char* cname)
 {
 	CHECK_LIB_INIT();
 
+	GIX_TRACE_SCOPE(TRACE_EV_CURSOR_FETCH, 0, cname);
+
 	spdlog::trace(FMT_FILE_FUNC "GIXSQLCursorFetchOne start", __FILE__, __func__);
 
+	SlowStatementTimer timer(__func__);
+
 	sqlca_initialize(st);
 
 	// check argument
@@ -795,13 +973,22 @@ LIBGIXSQL_API int GIXSQLCursorFetchOne(struct sqlca_t* st, char* cname)
 		return RESULT_FAILED;
 	}
 
+	GIX_TRACE_SCOPE_HANDLE(cursor->getConnection()->getId());
+	timer.setConnection(cursor->getConnection());
+	timer.setStatement(cname, std::string());
+
 	std::shared_ptr<IDbInterface> dbi = cursor->getConnection()->getDbInterface();
+	timer.startPhase(SlowLogPhase::Execute);
+	StatementWatchdog watchdog(dbi, statement_timeout(cursor->getConnection()));
 	int rc = dbi->cursor_fetch_one(cursor, FETCH_NEXT_ROW);
 	if (rc == DBERR_NO_DATA) {
+		timer.setRowCount(0);
 		setStatus(st, dbi, DBERR_NO_DATA);
 		return DBERR_FETCH_ROW_FAILED;
 	}
-	FAIL_ON_ERROR(rc, st, dbi, DBERR_FETCH_ROW_FAILED)
+	FAIL_ON_ERROR_OR_TIMEOUT(rc, st, dbi, DBERR_FETCH_ROW_FAILED, watchdog)
+
+	timer.startPhase(SlowLogPhase::Fetch);
 
 		int nResParams = _res_sql_var_list.size();
 	int nfields = dbi->get_num_fields(cursor);
@@ -811,7 +998,8 @@ LIBGIXSQL_API int GIXSQLCursorFetchOne(struct sqlca_t* st, char* cname)
 		return RESULT_FAILED;
 	}
 
-	uint64_t bsize = _res_sql_var_list.getMaxLength() + __global_env->varlen_length_sz() + 1;
+	bool direct_read = dbi->has(DbNativeFeature::DirectLobRead);
+	uint64_t bsize = _res_sql_var_list.getMaxLength(direct_read) + __global_env->varlen_length_sz() + 1;
 	std::unique_ptr<char[]> buffer = std::make_unique<char[]>(bsize);
 	std::vector<SqlVar*>::iterator it;
 	int i = 0;
@@ -819,14 +1007,18 @@ LIBGIXSQL_API int GIXSQLCursorFetchOne(struct sqlca_t* st, char* cname)
 	int sqlcode = 0;
 	for (it = _res_sql_var_list.begin(); it != _res_sql_var_list.end(); it++) {
 		bool is_null = false;
-		if (!dbi->get_resultset_value(ResultSetContextType::Cursor, CursorContextData(cursor), 0, i++, buffer.get(), bsize, &datalen, &is_null)) {
+		bool is_direct = direct_read && (*it)->canReadDirect();
+		if (!read_resultset_value(dbi, ResultSetContextType::Cursor, CursorContextData(cursor), i++, *it, is_direct, buffer.get(), bsize, &datalen, &is_null)) {
 			setStatus(st, dbi, DBERR_INVALID_COLUMN_DATA);
 			sqlcode = DBERR_INVALID_COLUMN_DATA;
 			continue;
 		}
 
 		int sql_code_local = DBERR_NO_ERROR;
-		(*it)->createCobolData(buffer.get(), datalen, &sql_code_local);
+		if (is_direct)
+			(*it)->createCobolDataDirect(datalen, &sql_code_local);
+		else
+			(*it)->createCobolData(buffer.get(), datalen, &sql_code_local);
 		if (sql_code_local) {
 			setStatus(st, dbi, sql_code_local);
 			sqlcode = sql_code_local;
@@ -841,6 +1033,7 @@ LIBGIXSQL_API int GIXSQLCursorFetchOne(struct sqlca_t* st, char* cname)
 		return RESULT_FAILED;
 	}
 
+	timer.setRowCount(1);
 	setStatus(st, NULL, DBERR_NO_ERROR);
 	return RESULT_SUCCESS;
 
@@ -851,8 +1044,12 @@ GIXSQLCursorClose(struct sqlca_t* st, char* cname)
 {
 	CHECK_LIB_INIT();
 
+	GIX_TRACE_SCOPE(TRACE_EV_CURSOR_CLOSE, 0, cname);
+
 	spdlog::trace(FMT_FILE_FUNC "GIXSQLCursorClose start", __FILE__, __func__);
 
+	SlowStatementTimer timer(__func__);
+
 	sqlca_initialize(st);
 
 	std::shared_ptr<Cursor> cursor = cursor_manager.get(cname);
@@ -875,7 +1072,12 @@ GIXSQLCursorClose(struct sqlca_t* st, char* cname)
 		return RESULT_SUCCESS;
 	}
 
+	GIX_TRACE_SCOPE_HANDLE(conn->getId());
+	timer.setConnection(conn);
+	timer.setStatement(cname, std::string());
+
 	std::shared_ptr<IDbInterface> dbi = cursor->getConnection()->getDbInterface();
+	timer.startPhase(SlowLogPhase::Execute);
 	int rc = dbi->cursor_close(cursor);
 
 	// when closing a cursor we always mark its logical state as closed, 
@@ -892,9 +1094,13 @@ LIBGIXSQL_API int GIXSQLPrepareStatement(sqlca_t* st, void* d_connection_id, int
 {
 	CHECK_LIB_INIT();
 
+	GIX_TRACE_SCOPE(TRACE_EV_PREPARE, 0, stmt_name);
+
 	spdlog::trace(FMT_FILE_FUNC "GIXSQLPrepareStatement start", __FILE__, __func__);
 	spdlog::trace(FMT_FILE_FUNC "Statement name: {}", __FILE__, __func__, stmt_name);
 
+	SlowStatementTimer timer(__func__);
+
 	std::string connection_id = get_hostref_or_literal(d_connection_id, connection_id_tl);
 	std::shared_ptr<Connection> conn = connection_manager.get(connection_id);
 	if (conn == NULL) {
@@ -913,14 +1119,69 @@ LIBGIXSQL_API int GIXSQLPrepareStatement(sqlca_t* st, void* d_connection_id, int
 		return RESULT_FAILED;
 	}
 
+	GIX_TRACE_SCOPE_HANDLE(conn->getId());
+	timer.setConnection(conn);
+	timer.setStatement(stmt_name, statement_src);
+
 	std::shared_ptr<IDbInterface> dbi = conn->getDbInterface();
 
+	timer.startPhase(SlowLogPhase::Execute);
 	if (dbi->prepare(stmt_name, statement_src)) {
 		spdlog::error("Cannot prepare statement (2)");
 		setStatus(st, dbi, DBERR_SQL_ERROR);
 		return RESULT_FAILED;
 	}
 
+	// over the limit (max_prepared_statements) the least recently used statements are deallocated
+	std::shared_ptr<PreparedStatementCache> prepared = conn->getPreparedStatements();
+	if (prepared) {
+		for (const auto& evicted : prepared->add(stmt_name)) {
+			spdlog::debug(FMT_FILE_FUNC "prepared statement limit reached, deallocating {}", __FILE__, __func__, evicted);
+			if (dbi->deallocate_prepared(evicted) != DBERR_NO_ERROR)
+				spdlog::warn("Cannot deallocate prepared statement {}: {}", evicted, dbi->get_error_message());
+		}
+	}
+
+	setStatus(st, NULL, DBERR_NO_ERROR);
+	return RESULT_SUCCESS;
+}
+
+LIBGIXSQL_API int GIXSQLDeallocatePrepared(sqlca_t* st, void* d_connection_id, int connection_id_tl, char* stmt_name)
+{
+	CHECK_LIB_INIT();
+
+	GIX_TRACE_SCOPE(TRACE_EV_DEALLOCATE, 0, stmt_name);
+
+	spdlog::trace(FMT_FILE_FUNC "GIXSQLDeallocatePrepared start", __FILE__, __func__);
+	spdlog::trace(FMT_FILE_FUNC "Statement name: {}", __FILE__, __func__, stmt_name);
+
+	sqlca_initialize(st);
+
+	std::string connection_id = get_hostref_or_literal(d_connection_id, connection_id_tl);
+	std::shared_ptr<Connection> conn = connection_manager.get(connection_id);
+	if (conn == NULL) {
+		spdlog::error("Can't find a connection");
+		setStatus(st, NULL, DBERR_CONN_NOT_FOUND);
+		return RESULT_FAILED;
+	}
+
+	if (stmt_name == NULL || strlen(stmt_name) == 0) {
+		spdlog::error("Empty statement name");
+		setStatus(st, NULL, DBERR_EMPTY_QUERY);
+		return RESULT_FAILED;
+	}
+
+	GIX_TRACE_SCOPE_HANDLE(conn->getId());
+
+	std::shared_ptr<PreparedStatementCache> prepared = conn->getPreparedStatements();
+	if (prepared)
+		prepared->remove(stmt_name);
+
+	std::shared_ptr<IDbInterface> dbi = conn->getDbInterface();
+	int rc = dbi->deallocate_prepared(stmt_name);
+	FAIL_ON_ERROR(rc, st, dbi, DBERR_SQL_ERROR)
+
+		setStatus(st, NULL, DBERR_NO_ERROR);
 	return RESULT_SUCCESS;
 }
 
@@ -929,11 +1190,15 @@ GIXSQLExecSelectIntoOne(struct sqlca_t* st, void* d_connection_id, int connectio
 {
 	CHECK_LIB_INIT();
 
+	GIX_TRACE_SCOPE(TRACE_EV_SELECT_INTO, 0, _query);
+
 	spdlog::trace(FMT_FILE_FUNC "GIXSQLExecSelectIntoOne start", __FILE__, __func__);
 	spdlog::trace(FMT_FILE_FUNC "SQL: #{}#", __FILE__, __func__, _query);
 
+	SlowStatementTimer timer(__func__);
+
 	std::string connection_id = get_hostref_or_literal(d_connection_id, connection_id_tl);
-	std::shared_ptr<Connection> conn = connection_manager.get(connection_id);
+	std::shared_ptr<IConnection> conn = connection_manager.get(connection_id);
 	if (conn == NULL) {
 		spdlog::error("Can't find a connection");
 		setStatus(st, NULL, DBERR_CONN_NOT_FOUND);
@@ -947,17 +1212,36 @@ GIXSQLExecSelectIntoOne(struct sqlca_t* st, void* d_connection_id, int connectio
 		return RESULT_FAILED;
 	}
 
+	std::shared_ptr<ResultCache> cache = get_result_cache(conn);
+	if (cache && !cache->isCacheable(_query))
+		cache = nullptr;
+
+	if (cache && cache->lookup(_query, _current_sql_var_list, _res_sql_var_list)) {
+		spdlog::trace(FMT_FILE_FUNC "result cache hit", __FILE__, __func__);
+		sqlca_initialize(st);
+		setStatus(st, NULL, DBERR_NO_ERROR);
+		return RESULT_SUCCESS;
+	}
+
+	conn = route_read(conn, _query, "SELECT INTO");
+
+	GIX_TRACE_SCOPE_HANDLE(conn->getId());
+	timer.setConnection(conn);
+	timer.setStatement(std::string(), _query);
+
 	std::shared_ptr<IDbInterface> dbi = conn->getDbInterface();
 
 	if (nParams > 0) {
-		if (_gixsqlExecParams(conn, st, _query, nParams) != RESULT_SUCCESS)
+		if (_gixsqlExecParams(conn, st, _query, nParams, timer) != RESULT_SUCCESS)
 			return RESULT_FAILED;
 	}
 	else {
-		if (_gixsqlExec(conn, st, _query) != RESULT_SUCCESS)
+		if (_gixsqlExec(conn, st, _query, timer) != RESULT_SUCCESS)
 			return RESULT_FAILED;
 	}
 
+	timer.startPhase(SlowLogPhase::Fetch);
+
 	if (!dbi->move_to_first_record()) {
 		spdlog::error("move_to_first_record failed: {} - {}: {}", dbi->get_error_code(), dbi->get_state(), dbi->get_error_message());
 		setStatus(st, dbi, dbi->get_error_code());
@@ -994,12 +1278,14 @@ GIXSQLExecSelectIntoOne(struct sqlca_t* st, void* d_connection_id, int connectio
 	uint64_t datalen = 0;
 	int sqlcode = 0;
 	bool has_invalid_column_data = false;
-	uint64_t bsize = _res_sql_var_list.getMaxLength() + __global_env->varlen_length_sz() + 1;
+	bool direct_read = dbi->has(DbNativeFeature::DirectLobRead);
+	uint64_t bsize = _res_sql_var_list.getMaxLength(direct_read) + __global_env->varlen_length_sz() + 1;
 	std::unique_ptr<char[]> buffer = std::make_unique<char[]>(bsize);
 	for (int i = 0; i < _res_sql_var_list.size(); i++) {
 		SqlVar* v = _res_sql_var_list.at(i);
 		bool is_null = false;
-		if (!dbi->get_resultset_value(ResultSetContextType::CurrentResultSet, CurrentResultSetContextData(), 0, i, buffer.get(), bsize, &datalen, &is_null)) {
+		bool is_direct = direct_read && v->canReadDirect();
+		if (!read_resultset_value(dbi, ResultSetContextType::CurrentResultSet, CurrentResultSetContextData(), i, v, is_direct, buffer.get(), bsize, &datalen, &is_null)) {
 			setStatus(st, dbi, DBERR_INVALID_COLUMN_DATA);
 			sqlcode = DBERR_INVALID_COLUMN_DATA;
 			continue;
@@ -1008,7 +1294,10 @@ GIXSQLExecSelectIntoOne(struct sqlca_t* st, void* d_connection_id, int connectio
 		int sql_code_local = DBERR_NO_ERROR;
 		char* _data_bfr = is_null ? nullptr : buffer.get();
 		uint64_t _data_len = is_null ? 0 : datalen;
-		v->createCobolData(_data_bfr, _data_len, &sql_code_local);
+		if (is_direct && !is_null)
+			v->createCobolDataDirect(datalen, &sql_code_local);
+		else
+			v->createCobolData(_data_bfr, _data_len, &sql_code_local);
 		if (sql_code_local) {
 			setStatus(st, dbi, sql_code_local);
 			sqlcode = sql_code_local;
@@ -1022,6 +1311,10 @@ GIXSQLExecSelectIntoOne(struct sqlca_t* st, void* d_connection_id, int connectio
 		return RESULT_FAILED;
 	}
 
+	if (cache)
+		cache->store(_query, _current_sql_var_list, _res_sql_var_list);
+
+	timer.setRowCount(1);
 	setStatus(st, NULL, DBERR_NO_ERROR);
 	return RESULT_SUCCESS;
 }
@@ -1031,6 +1324,8 @@ GIXSQLDisconnect(struct sqlca_t* st, void* d_connection_id, int connection_id_tl
 {
 	CHECK_LIB_INIT();
 
+	GIX_TRACE_SCOPE(TRACE_EV_DISCONNECT, 0, nullptr);
+
 	spdlog::trace(FMT_FILE_FUNC "GIXSQLDisconnect start", __FILE__, __func__);
 
 	std::string connection_id = get_hostref_or_literal(d_connection_id, connection_id_tl);
@@ -1040,8 +1335,24 @@ GIXSQLDisconnect(struct sqlca_t* st, void* d_connection_id, int connection_id_tl
 		return RESULT_FAILED;
 	}
 
+	GIX_TRACE_SCOPE_HANDLE(conn->getId());
+
 	cursor_manager.clearConnectionCursors(conn->getId(), true);
 
+	std::shared_ptr<Connection> replica = connection_manager.getReplica(conn->getId());
+	if (replica) {
+		replica->getDbInterface()->terminate_connection();
+		replica->setOpened(false);
+		connection_manager.removeReplica(conn->getId());
+	}
+	connection_manager.setWriteTransaction(conn->getId(), false);
+
+	std::shared_ptr<ResultCache> cache = conn->getResultCache();
+	if (cache) {
+		spdlog::debug(FMT_FILE_FUNC "result cache on connection {}: {} hits, {} misses", __FILE__, __func__, conn->getName(), cache->getHits(), cache->getMisses());
+		conn->setResultCache(nullptr);
+	}
+
 	std::shared_ptr<IDbInterface> dbi = conn->getDbInterface();
 	int rc = dbi->terminate_connection();
 	conn->setOpened(false);
@@ -1117,6 +1428,57 @@ LIBGIXSQL_API int GIXSQLSetResultParams(int type, int length, int scale, uint32_
 	return RESULT_SUCCESS;
 }
 
+LIBGIXSQL_API int GIXSQLSetStatementFlags(uint32_t flags)
+{
+	CHECK_LIB_INIT();
+
+	_current_stmt_flags = flags;
+	return RESULT_SUCCESS;
+}
+
+LIBGIXSQL_API int GIXSQLSetStatementTimeout(int timeout_ms)
+{
+	CHECK_LIB_INIT();
+
+	_next_stmt_timeout = (timeout_ms >= 0) ? timeout_ms : -1;
+	return RESULT_SUCCESS;
+}
+
+LIBGIXSQL_API int GIXSQLRegisterStatement(struct sqlca_t* st, void* d_connection_id, int connection_id_tl, char* module_name, char* _query, int nParams)
+{
+	CHECK_LIB_INIT();
+
+	spdlog::trace(FMT_FILE_FUNC "GIXSQLRegisterStatement - module: {}, SQL: {}", __FILE__, __func__, module_name ? module_name : "", _query ? _query : "");
+
+	sqlca_initialize(st);
+
+	if (_query == NULL || strlen(_query) == 0) {
+		setStatus(st, NULL, DBERR_EMPTY_QUERY);
+		return RESULT_FAILED;
+	}
+
+	if (_current_sql_var_list.size() != nParams) {
+		setStatus(st, NULL, _current_sql_var_list.size() > nParams ? DBERR_TOO_MANY_ARGUMENTS : DBERR_TOO_FEW_ARGUMENTS);
+		return RESULT_FAILED;
+	}
+
+	std::string connection_id = get_hostref_or_literal(d_connection_id, connection_id_tl);
+
+	StaticStatementInfo si;
+	si.query = _query;
+	for (auto it = _current_sql_var_list.begin(); it != _current_sql_var_list.end(); it++) {
+		si.param_types.push_back((*it)->getType());
+		si.param_flags.push_back((*it)->getFlags());
+	}
+
+	// COMMIT/ROLLBACK are handled by the drivers
+	if (!is_commit_or_rollback_statement(si.query))
+		statement_registry.add(module_name ? module_name : "", trim_copy(connection_id), si);
+
+	setStatus(st, NULL, DBERR_NO_ERROR);
+	return RESULT_SUCCESS;
+}
+
 LIBGIXSQL_API int GIXSQLEndSQL(void)
 {
 	CHECK_LIB_INIT();
@@ -1129,14 +1491,215 @@ LIBGIXSQL_API int GIXSQLEndSQL(void)
 
 	_current_sql_var_list.clear();
 	_res_sql_var_list.clear();
+	_current_stmt_flags = STMT_FLAG_NONE;
 
 	return RESULT_SUCCESS;
 }
 
+LIBGIXSQL_API int GIXSQLTraceDump(void)
+{
+	CHECK_LIB_INIT();
+
+	if (!__trace_ring_enabled) {
+		spdlog::warn("GIXSQLTraceDump: tracing is not enabled (GIXSQL_TRACE_RING)");
+		return RESULT_FAILED;
+	}
+
+	GIX_TRACE(TRACE_EV_DUMP, 0, 0, 0, nullptr, 0);
+	return trace_ring_dump() ? RESULT_SUCCESS : RESULT_FAILED;
+}
+
+// Statements registered with GIXSQLRegisterStatement are prepared in a single batch the first time 
+// a connection is used after their registration. Errors are only logged here: they will be reported 
+// again when the statement is actually executed.
+static void prepare_static_statements(const std::shared_ptr<IConnection>& conn)
+{
+	// a replica has the same id of its primary connection, static statements are only prepared on the latter
+	if (!statement_registry.hasPending(conn->getId()) || connection_manager.getReplica(conn->getId()) == conn)
+		return;
+
+	std::shared_ptr<IDbInterface> dbi = conn->getDbInterface();
+	std::vector<StatementRegistry::Entry> entries = statement_registry.fetchPending(conn->getId());
+	if (!dbi || !dbi->has(DbNativeFeature::StaticStatementCache))
+		return;
+
+	std::vector<StaticStatementInfo> stmts;
+	std::vector<std::string> modules;
+	for (const auto& e : entries) {
+		if (connection_manager.get(e.connection_id) == conn) {
+			stmts.push_back(e.stmt);
+			modules.push_back(e.module_name);
+		}
+	}
+
+	if (stmts.empty())
+		return;
+
+	std::vector<int> results;
+	int rc = dbi->prepare_static(stmts, results);
+	spdlog::debug(FMT_FILE_FUNC "prepared {} static statement(s) on connection #{}, rc: {}", __FILE__, __func__, stmts.size(), conn->getId(), rc);
+
+	for (int i = 0; i < results.size() && i < stmts.size(); i++) {
+		if (results[i] != DBERR_NO_ERROR)
+			spdlog::error("Cannot prepare static statement in module {}: {}", modules[i], stmts[i].query);
+	}
+}
+
+// Read/write splitting: only plain queries (no locking clauses, no data-modifying CTEs) can go to the replica
+static bool is_read_only_query(const std::string& query)
+{
+	static const std::regex re_select("^\\s*(SELECT|WITH)\\b", std::regex::icase);
+	static const std::regex re_write("\\b(INSERT|UPDATE|DELETE|MERGE|SHARE|LOCK|INTO)\\b", std::regex::icase);
+
+	return std::regex_search(query, re_select) && !std::regex_search(query, re_write);
+}
+
+// Called before a statement is executed on the primary connection (query is empty for prepared statements)
+static void track_write_transaction(const std::shared_ptr<IConnection>& conn, const std::string& query)
+{
+	std::shared_ptr<IConnectionOptions> opts = conn->getConnectionOptions();
+	if (!opts || opts->read_replica.empty())
+		return;
+
+	bool is_tx_termination = STMT_IS_CLASSIFIED(_current_stmt_flags) ? STMT_IS_TX_TERMINATION(_current_stmt_flags) : is_commit_or_rollback_statement(query);
+	if (is_tx_termination) {
+		if (connection_manager.inWriteTransaction(conn->getId()))
+			spdlog::debug("read replica: write transaction ended on connection {}", conn->getName());
+		connection_manager.setWriteTransaction(conn->getId(), false);
+
+		// the replica follows the transactions of the primary, so that it does not keep an old snapshot 
+		// (it might have no active transaction at all, so errors are not relevant here)
+		std::shared_ptr<Connection> replica = connection_manager.getReplica(conn->getId());
+		if (replica && replica->getDbInterface()->exec(query) != DBERR_NO_ERROR)
+			spdlog::debug("read replica: cannot end transaction on connection {}: {}", replica->getName(), replica->getDbInterface()->get_error_message());
+		return;
+	}
+
+	if (connection_manager.inWriteTransaction(conn->getId()))
+		return;
+
+	bool is_write = is_begin_transaction_statement(query) || (opts->autocommit == AutoCommitMode::Off && !is_read_only_query(query));
+	if (is_write) {
+		spdlog::debug("read replica: write transaction started on connection {}", conn->getName());
+		connection_manager.setWriteTransaction(conn->getId(), true);
+	}
+}
+
+// The timeout for the next driver call on the connection: the one set with GIXSQLSetStatementTimeout 
+// (that is only used once) or the connection default
+static int statement_timeout(const std::shared_ptr<IConnection>& conn)
+{
+	int t = _next_stmt_timeout;
+	_next_stmt_timeout = -1;
+	if (t >= 0)
+		return t;
+
+	std::shared_ptr<IConnectionOptions> opts = conn->getConnectionOptions();
+	return opts ? opts->statement_timeout : 0;
+}
+
+static void touch_prepared_statement(const std::shared_ptr<IConnection>& conn, const std::string& stmt_name)
+{
+	std::shared_ptr<Connection> c = connection_manager.getById(conn->getId());
+	std::shared_ptr<PreparedStatementCache> prepared = c ? c->getPreparedStatements() : nullptr;
+	if (prepared)
+		prepared->touch(stmt_name);
+}
+
+// The result cache belongs to the primary connection, conn can also be its replica
+static std::shared_ptr<ResultCache> get_result_cache(const std::shared_ptr<IConnection>& conn)
+{
+	std::shared_ptr<Connection> c = connection_manager.getById(conn->getId());
+	return c ? c->getResultCache() : nullptr;
+}
+
+// Called before a statement is executed (query is empty for prepared statements): anything 
+// that might modify data, or end a transaction, clears the result cache of the connection
+static void invalidate_result_cache(const std::shared_ptr<IConnection>& conn, const std::string& query)
+{
+	std::shared_ptr<ResultCache> cache = get_result_cache(conn);
+	if (cache && !is_read_only_query(query))
+		cache->invalidate();
+}
+
+// Returns the connection (the primary or its replica) a SELECT INTO or a cursor should run on. 
+// conn can be either, the replica is opened here the first time it is needed
+static std::shared_ptr<IConnection> route_read(const std::shared_ptr<IConnection>& conn, const std::string& query, const std::string& what)
+{
+	std::shared_ptr<IConnection> primary = connection_manager.getById(conn->getId());
+	if (!primary)
+		primary = conn;
+
+	std::shared_ptr<IConnectionOptions> opts = primary->getConnectionOptions();
+	if (!opts || opts->read_replica.empty())
+		return primary;
+
+	if (connection_manager.inWriteTransaction(primary->getId())) {
+		spdlog::debug("read replica: {} routed to primary connection {} (write transaction)", what, primary->getName());
+		return primary;
+	}
+
+	if (!is_read_only_query(query)) {
+		spdlog::debug("read replica: {} routed to primary connection {} (not a read-only query)", what, primary->getName());
+		return primary;
+	}
+
+	std::shared_ptr<Connection> replica = connection_manager.getReplica(primary->getId());
+	if (!replica) {
+		if (!connection_manager.canOpenReplica(primary->getId()))
+			return primary;
+
+		std::shared_ptr<IDataSourceInfo> primary_ds = primary->getConnectionInfo();
+		std::map<std::string, std::string> ds_opts = primary_ds->getOptions();
+		std::string username = ds_opts.find("read_replica_user") != ds_opts.end() ? ds_opts["read_replica_user"] : primary_ds->getUsername();
+		std::string password = ds_opts.find("read_replica_password") != ds_opts.end() ? ds_opts["read_replica_password"] : primary_ds->getPassword();
+
+		std::shared_ptr<DataSourceInfo> ds = std::make_shared<DataSourceInfo>();
+		std::shared_ptr<IDbInterface> dbi;
+		if (ds->init(opts->read_replica, "", username, password) == 0)
+			dbi = DbInterfaceFactory::getInterface(ds->getDbType(), __global_env, gixsql_logger);
+
+		// same options of the primary (autocommit, encoding, etc.)
+		std::shared_ptr<IConnectionOptions> replica_opts = std::make_shared<IConnectionOptions>(*opts);
+		replica_opts->read_replica.clear();
+
+		if (!dbi || dbi->connect(ds, replica_opts) != DBERR_NO_ERROR) {
+			spdlog::warn("read replica: cannot open the replica of connection {} ({}), using the primary", primary->getName(), dbi ? dbi->get_error_message() : "invalid data source");
+			connection_manager.setReplicaFailed(primary->getId());
+			return primary;
+		}
+
+		replica = connection_manager.create();
+		replica->setName(primary->getName() + "/replica");
+		replica->setConnectionOptions(replica_opts);
+		replica->setConnectionInfo(ds);
+		replica->setDbInterface(dbi);
+		replica->setOpened(true);
+		connection_manager.setReplica(primary->getId(), replica);
+
+		spdlog::info("read replica: opened replica of connection {} (host: {}, database: {})", primary->getName(), ds->getHost(), ds->getDbName());
+	}
+
+	spdlog::debug("read replica: {} routed to replica of connection {}", what, primary->getName());
+	return replica;
+}
+
+// Binary fields are filled directly by the driver (if supported), without going through the intermediate buffer
+static bool read_resultset_value(const std::shared_ptr<IDbInterface>& dbi, ResultSetContextType rs_type, const IResultSetContextData& ctx, int col, SqlVar* v, bool is_direct, char* bfr, uint64_t bfrlen, uint64_t* datalen, bool* is_null)
+{
+	if (!is_direct)
+		return dbi->get_resultset_value(rs_type, ctx, 0, col, bfr, bfrlen, datalen, is_null);
+
+	uint64_t fld_len = 0;
+	char* fld_bfr = v->getDirectReadBuffer(&fld_len);
+	return dbi->get_resultset_value_direct(rs_type, ctx, 0, col, fld_bfr, fld_len, datalen, is_null);
+}
+
 static void init_sql_var_list(void)
 {
 	_current_sql_var_list.clear();
 	_res_sql_var_list.clear();
+	_current_stmt_flags = STMT_FLAG_NONE;
 }
 
 static void set_sqlerrm(struct sqlca_t* st, const char* m)
@@ -1152,6 +1715,8 @@ static void set_sqlerrm(struct sqlca_t* st, const char* m)
 
 static int setStatus(struct sqlca_t* st, std::shared_ptr<IDbInterface> dbi, int err)
 {
+	GIX_TRACE(TRACE_EV_STATUS, 0, st, err, nullptr, 0);
+
 	sqlca_initialize(st);
 
 	switch (err) {
@@ -1283,6 +1848,11 @@ static int setStatus(struct sqlca_t* st, std::shared_ptr<IDbInterface> dbi, int
 		set_sqlerrm(st, "Too much data");
 		break;
 
+	case DBERR_STATEMENT_TIMEOUT:
+		memcpy(st->sqlstate, "57014", 5);
+		set_sqlerrm(st, "Statement timeout, the statement was cancelled");
+		break;
+
 	case DBERR_CONN_INIT_ERROR:
 		memcpy(st->sqlstate, "IM002", 5);
 		set_sqlerrm(st, "Invalid datasource definition");
@@ -1413,6 +1983,179 @@ static std::string get_client_encoding(const std::shared_ptr<DataSourceInfo>& ds
 	return GIXSQL_CLIENT_ENCODING_DEFAULT;
 }
 
+static int get_slow_log_threshold(const std::shared_ptr<DataSourceInfo>& ds)
+{
+	std::map<std::string, std::string> options = ds->getOptions();
+	if (options.find("slow_log_threshold") != options.end()) {
+		int i = atoi(options["slow_log_threshold"].c_str());
+		return (i > 0) ? i : 0;
+	}
+
+	char* v = getenv("GIXSQL_SLOW_LOG_THRESHOLD");
+	if (v) {
+		int i = atoi(v);
+		return (i > 0) ? i : 0;
+	}
+
+	return DEFAULT_GIXSQL_SLOW_LOG_THRESHOLD;
+}
+
+static bool get_slow_log_params(const std::shared_ptr<DataSourceInfo>& ds)
+{
+	std::map<std::string, std::string> options = ds->getOptions();
+	if (options.find("slow_log_params") != options.end()) {
+		std::string o = to_lower(options["slow_log_params"]);
+		return (o == "on" || o == "1");
+	}
+
+	char* v = getenv("GIXSQL_SLOW_LOG_PARAMS");
+	if (v) {
+		if (strcmp(v, "1") == 0 || strcasecmp(v, "ON") == 0)
+			return true;
+
+		if (strcmp(v, "0") == 0 || strcasecmp(v, "OFF") == 0)
+			return false;
+	}
+
+	return DEFAULT_GIXSQL_SLOW_LOG_PARAMS;
+}
+
+static bool get_slow_log_explain(const std::shared_ptr<DataSourceInfo>& ds)
+{
+	std::map<std::string, std::string> options = ds->getOptions();
+	if (options.find("slow_log_explain") != options.end()) {
+		std::string o = to_lower(options["slow_log_explain"]);
+		return (o == "on" || o == "1");
+	}
+
+	char* v = getenv("GIXSQL_SLOW_LOG_EXPLAIN");
+	if (v) {
+		if (strcmp(v, "1") == 0 || strcasecmp(v, "ON") == 0)
+			return true;
+
+		if (strcmp(v, "0") == 0 || strcasecmp(v, "OFF") == 0)
+			return false;
+	}
+
+	return DEFAULT_GIXSQL_SLOW_LOG_EXPLAIN;
+}
+
+static std::vector<std::string> get_slow_log_masked_columns(const std::shared_ptr<DataSourceInfo>& ds)
+{
+	std::string cols;
+	std::map<std::string, std::string> options = ds->getOptions();
+	if (options.find("slow_log_mask") != options.end()) {
+		cols = options["slow_log_mask"];
+	}
+	else {
+		char* v = getenv("GIXSQL_SLOW_LOG_MASK");
+		if (v)
+			cols = v;
+	}
+
+	std::vector<std::string> res;
+	for (auto c : string_split(cols, "[,;]")) {
+		trim(c);
+		if (!c.empty())
+			res.push_back(c);
+	}
+	return res;
+}
+
+static std::string get_read_replica(const std::shared_ptr<DataSourceInfo>& ds)
+{
+	std::map<std::string, std::string> options = ds->getOptions();
+	if (options.find("read_replica") != options.end())
+		return trim_copy(options["read_replica"]);
+
+	return std::string();
+}
+
+static int get_statement_timeout(const std::shared_ptr<DataSourceInfo>& ds)
+{
+	std::map<std::string, std::string> options = ds->getOptions();
+	if (options.find("statement_timeout") != options.end()) {
+		int i = atoi(options["statement_timeout"].c_str());
+		return (i > 0) ? i : 0;
+	}
+
+	char* v = getenv("GIXSQL_STATEMENT_TIMEOUT");
+	if (v) {
+		int i = atoi(v);
+		return (i > 0) ? i : 0;
+	}
+
+	return DEFAULT_GIXSQL_STATEMENT_TIMEOUT;
+}
+
+static int get_max_prepared_statements(const std::shared_ptr<DataSourceInfo>& ds)
+{
+	std::map<std::string, std::string> options = ds->getOptions();
+	if (options.find("max_prepared_statements") != options.end()) {
+		int i = atoi(options["max_prepared_statements"].c_str());
+		return (i > 0) ? i : 0;
+	}
+
+	char* v = getenv("GIXSQL_MAX_PREPARED_STATEMENTS");
+	if (v) {
+		int i = atoi(v);
+		return (i > 0) ? i : 0;
+	}
+
+	return DEFAULT_GIXSQL_MAX_PREPARED_STATEMENTS;
+}
+
+// Returns nullptr unless either result_cache_tables or result_cache_queries is set
+static std::shared_ptr<ResultCache> create_result_cache(const std::shared_ptr<DataSourceInfo>& ds)
+{
+	std::map<std::string, std::string> options = ds->getOptions();
+	auto get_opt = [&options](const std::string& name, const char* env_name) -> std::string {
+		if (options.find(name) != options.end())
+			return trim_copy(options[name]);
+
+		char* v = getenv(env_name);
+		return v ? trim_copy(v) : std::string();
+	};
+
+	std::vector<std::string> tables;
+	for (auto t : string_split(get_opt("result_cache_tables", "GIXSQL_RESULT_CACHE_TABLES"), "[,;]")) {
+		trim(t);
+		if (!t.empty())
+			tables.push_back(t);
+	}
+
+	std::vector<std::string> queries;
+	std::string query_file = get_opt("result_cache_queries", "GIXSQL_RESULT_CACHE_QUERIES");
+	if (!query_file.empty()) {
+		std::ifstream ifs(query_file);
+		if (!ifs.good()) {
+			spdlog::error("Cannot read result cache query file {}", query_file);
+		}
+		else {
+			std::string line;
+			while (std::getline(ifs, line)) {
+				trim(line);
+				if (!line.empty() && line[0] != '#')
+					queries.push_back(line);
+			}
+		}
+	}
+
+	if (tables.empty() && queries.empty())
+		return nullptr;
+
+	std::string s = get_opt("result_cache_ttl", "GIXSQL_RESULT_CACHE_TTL");
+	int ttl = !s.empty() ? atoi(s.c_str()) : DEFAULT_GIXSQL_RESULT_CACHE_TTL;
+	if (ttl <= 0)
+		return nullptr;
+
+	s = get_opt("result_cache_size", "GIXSQL_RESULT_CACHE_SIZE");
+	int size = !s.empty() ? atoi(s.c_str()) : DEFAULT_GIXSQL_RESULT_CACHE_SIZE;
+
+	spdlog::debug(FMT_FILE_FUNC "result cache enabled: {} tables, {} queries, TTL {}s, {} entries max", __FILE__, __func__, tables.size(), queries.size(), ttl, size);
+	return std::make_shared<ResultCache>(tables, queries, ttl, size);
+}
+
 std::string get_hostref_or_literal(void* data, int l)
 {
 	if (!data)
@@ -1439,6 +2182,15 @@ std::string get_hostref_or_literal(void* data, int l)
 	return t;
 }
 
+static std::string get_slow_log_file() {
+	char* c = getenv("GIXSQL_SLOW_LOG_FILE");
+	if (c) {
+		return c;
+	}
+
+	return DEFAULT_GIXSQL_SLOW_LOG_FILE;
+}
+
 static std::string get_debug_log_file() {
 	char* c = getenv("GIXSQL_LOG_FILE");
 	if (c) {
@@ -1525,13 +2277,16 @@ void get_log_rotation_parameters(unsigned long* max_size, int* max_files, bool *
 {
 	char* c = getenv("GIXSQL_LOG_ROTATE_MAX_SIZE");
 	if (!c) {
-		*max_size = DEFAULT_GIXSQL_LOG_ROTATE_MAX_SIZE;
+		// the default size is expressed in units of DEFAULT_GIXSQL_LOG_SIZE_SUFFIX (MB)
+		*max_size = DEFAULT_GIXSQL_LOG_ROTATE_MAX_SIZE * 1024 * 1024;
 	}
 	else {
+		// work on a copy: this is called for each log (main and slow statement) and the environment must not be modified
+		std::string sz = c;
 		char suffix = DEFAULT_GIXSQL_LOG_SIZE_SUFFIX;
-		if (strlen(c) > 1 && (c[strlen(c) - 1] == 'B' || c[strlen(c) - 1] == 'K' || c[strlen(c) - 1] == 'M' || c[strlen(c) - 1] == 'G')) {
-			suffix = c[strlen(c) - 1];
-			c[strlen(c) - 1] = '\0';
+		if (sz.size() > 1 && (sz.back() == 'B' || sz.back() == 'K' || sz.back() == 'M' || sz.back() == 'G')) {
+			suffix = sz.back();
+			sz.pop_back();
 		}
 
 		int multiplier = 1024 * 1024;
@@ -1554,7 +2309,7 @@ void get_log_rotation_parameters(unsigned long* max_size, int* max_files, bool *
 				break;
 		}
 
-		*max_size = atoi(c) ? atoi(c) * multiplier : DEFAULT_GIXSQL_LOG_ROTATE_MAX_SIZE;
+		*max_size = atoi(sz.c_str()) ? atoi(sz.c_str()) * multiplier : DEFAULT_GIXSQL_LOG_ROTATE_MAX_SIZE * 1024 * 1024;
 	}
 
 	// ***
@@ -1572,6 +2327,7 @@ void get_log_rotation_parameters(unsigned long* max_size, int* max_files, bool *
 	c = getenv("GIXSQL_LOG_ROTATE_ON_OPEN");
 	if (!c) {
 		*rotate_on_open = DEFAULT_GIXSQL_LOG_ROTATE_ON_OPEN;
+		return;
 	}
 
 	std::string s = to_lower(c);
@@ -1649,6 +2405,29 @@ static bool gixsql_initialize()
 	spdlog::set_level(level);
 	spdlog::info("GixSQL logger started (PID: {})", pid);
 
+	trace_ring_init();
+
+	std::string slow_log_file = get_slow_log_file();
+	if (slow_log_file.find("$$") != std::string::npos) {
+		slow_log_file = string_replace(slow_log_file, "$$", std::to_string(pid));
+	}
+	char* c = getenv("GIXSQL_SLOW_LOG_EXPLAIN_INTERVAL");
+	int explain_interval = (c && atoi(c) >= 0) ? atoi(c) : DEFAULT_GIXSQL_SLOW_LOG_EXPLAIN_INTERVAL;
+	SlowStatementLog::init(slow_log_file, explain_interval);
+
+	// Drivers to load in advance, so that the first connection does not have to wait for them
+	c = getenv("GIXSQL_PRELOAD_DRIVERS");
+	if (c) {
+		std::vector<std::string> drivers;
+		for (auto d : string_split(c, "[,;]")) {
+			trim(d);
+			if (!d.empty())
+				drivers.push_back(to_lower(d));
+		}
+		int n = DbInterfaceFactory::preload(drivers);
+		spdlog::info("Preloaded {} of {} DB provider(s)", n, drivers.size());
+	}
+
 	__global_env = new GlobalEnv();
 
 	__lib_initialized = true;
@@ -143,14 +143,21 @@ extern "C" {
 	LIBGIXSQL_API int GIXSQLCursorClose(struct sqlca_t *, char *);
 
 	LIBGIXSQL_API int GIXSQLPrepareStatement(struct sqlca_t *st, void *d_connection_id, int connection_id_tl, char *stmt_name, void *d_statement_src, int statement_src_tl);
+	LIBGIXSQL_API int GIXSQLDeallocatePrepared(struct sqlca_t *st, void *d_connection_id, int connection_id_tl, char *stmt_name);
 	LIBGIXSQL_API int GIXSQLExecPrepared(struct sqlca_t *st, void *d_connection_id, int connection_id_tl, char *stmt_name, int nParams);
 	LIBGIXSQL_API int GIXSQLExecPreparedInto(struct sqlca_t *st, void *d_connection_id, int connection_id_tl, char *stmt_name, int nParams, int nResParams);
 
+	LIBGIXSQL_API int GIXSQLRegisterStatement(struct sqlca_t *st, void *d_connection_id, int connection_id_tl, char *module_name, char *query, int nParams);
+
 	LIBGIXSQL_API int GIXSQLStartSQL(void);
 	LIBGIXSQL_API int GIXSQLSetSQLParams(int type, int length, int scale, uint32_t flags, void* addr, void* ind_addr);
 	LIBGIXSQL_API int GIXSQLSetResultParams(int type, int length, int scale, uint32_t flags, void* var_addr, void* ind_addr);
+	LIBGIXSQL_API int GIXSQLSetStatementFlags(uint32_t flags);
+	LIBGIXSQL_API int GIXSQLSetStatementTimeout(int timeout_ms);
 	LIBGIXSQL_API int GIXSQLEndSQL(void);
 
+	LIBGIXSQL_API int GIXSQLTraceDump(void);
+
 }
 
 #endif
@@ -0,0 +1,42 @@
+#!/bin/sh
+
+# Merges the objects of a driver built as a convenience library (see --with-static-drivers)
+# into a single libtool object where, apart from the provider function (get_dblib_<id>),
+# all the strong global symbols are made local, so that the driver's helpers and bundled
+# client code do not clash with libgixsql. Weak symbols (inline functions, templates) are
+# left alone, since they are shared with the rest of the library
+#
+# usage: static-dblib.sh <ld> <nm> <objcopy> <driver id> <convenience library (.la)> <output (.lo)>
+# the output is created in the current directory
+
+set -e
+
+LD="$1"
+NM="$2"
+OBJCOPY="$3"
+DRV="$4"
+LA="$5"
+LO=`basename "$6"`
+
+ARCHIVE="`dirname $LA`/.libs/`basename $LA .la`.a"
+OBJ=".libs/`basename $LO .lo`.o"
+
+mkdir -p .libs
+$LD -r -o $OBJ --whole-archive $ARCHIVE --no-whole-archive
+$NM --defined-only -g $OBJ | awk -v keep=get_dblib_$DRV '$2 ~ /^[TDBRGS]$/ && $3 != keep { print $3 }' > $OBJ.syms
+$OBJCOPY --localize-symbols=$OBJ.syms $OBJ
+rm -f $OBJ.syms
+
+cat > $LO << EOF
+# $LO - a libtool object file
+# Generated by libtool (static-dblib.sh)
+#
+# Please DO NOT delete this file!
+# It is necessary for linking the library.
+
+# Name of the PIC object.
+pic_object='$OBJ'
+
+# Name of the non-PIC object
+non_pic_object='$OBJ'
+EOF